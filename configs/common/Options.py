@@ -290,6 +290,22 @@ def addFSOptions(parser):
                       help="Path to the disk image to use.")
     parser.add_option("--root-device", action="store", type="string", default=None,
                       help="OS device name for root partition")
+    parser.add_option("--second-disk-image", action="store", type="string",
+                      default=None,
+                      help="Path to the image of the second disk (x86 only)")
+    parser.add_option("--disk-mmap", action="store_true",
+                      help="Map the disk images into memory (x86 only)")
+    parser.add_option("--disk-read-ahead", action="store", type="string",
+                      default="1MB",
+                      help="Read ahead of sequential disk reads with "
+                      "--disk-mmap")
+    parser.add_option("--disk-drop-behind", action="store_true",
+                      help="Drop sequentially read disk data from the host "
+                      "page cache with --disk-mmap")
+    parser.add_option("--cow-sparse", action="store_true",
+                      help="Keep the written sectors of the disks in sparse "
+                      "files in the output directory instead of in memory "
+                      "(x86 only)")
 
     # Command line options
     parser.add_option("--command-line", action="store", type="string",
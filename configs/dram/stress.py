@@ -0,0 +1,120 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+from m5.util.convert import toLatency
+
+# This script saturates a single DRAM controller with random traffic
+# from a number of traffic generators to stress the scheduler with deep
+# read and write queues. This resembles the situation in dtu_fs.py,
+# where the LLC misses of all PEs converge on the single memory PE. The
+# host time spent in the scheduler is reported as schedHostTime in the
+# statistics of the controller.
+
+parser = optparse.OptionParser()
+
+parser.add_option("--mem-type", type="choice", default="DDR4_2400_x64",
+                  choices=["DDR3_1600_x64", "DDR4_2400_x64",
+                           "LPDDR3_1600_x32", "HBM_1000_4H_x128"],
+                  help="type of memory to use [default:%default]")
+parser.add_option("--mem-ranks", type="int", default=2,
+                  help="Number of ranks [default:%default]")
+parser.add_option("--sched", type="choice", default="frfcfs",
+                  choices=["fcfs", "frfcfs"],
+                  help="Scheduling policy [default:%default]")
+parser.add_option("--queue-size", type="int", default=256,
+                  help="Size of the read and write queue [default:%default]")
+parser.add_option("--gens", type="int", default=16,
+                  help="Number of traffic generators [default:%default]")
+parser.add_option("--rd-perc", type="int", default=70,
+                  help="Percentage of read requests [default:%default]")
+parser.add_option("--period", type="string", default="1ns",
+                  help="Time between two requests of a generator "
+                  "[default:%default]")
+parser.add_option("--duration", type="string", default="100us",
+                  help="Simulated time [default:%default]")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+system = System(membus = NoncoherentXBar(width = 64,
+                                         frontend_latency = 0,
+                                         forward_latency = 0,
+                                         response_latency = 0))
+system.clk_domain = SrcClockDomain(clock = '2GHz',
+                                   voltage_domain =
+                                   VoltageDomain(voltage = '1V'))
+
+mem_range = AddrRange('512MB')
+system.mem_ranges = [mem_range]
+mmap_using_noreserve = True
+
+mem_cls = eval(options.mem_type)
+system.mem_ctrl = mem_cls(range = mem_range,
+                          ranks_per_channel = options.mem_ranks,
+                          mem_sched_policy = options.sched,
+                          read_buffer_size = options.queue_size,
+                          write_buffer_size = options.queue_size,
+                          sched_host_time = True,
+                          null = True)
+system.mem_ctrl.port = system.membus.master
+
+# every generator issues random 64 byte requests to the whole range as
+# fast as the controller accepts them
+# (the parameters are in seconds and we need ticks)
+period = int(toLatency(options.period) * 1000000000000)
+duration = int(toLatency(options.duration) * 1000000000000)
+cfg_file_name = m5.options.outdir + "/dram_stress.cfg"
+cfg_file = open(cfg_file_name, 'w')
+cfg_file.write("STATE 0 %d RANDOM %d 0 %d 64 %d %d 0\n" %
+               (duration, options.rd_perc, mem_range.size() - 1, period,
+                period))
+cfg_file.write("INIT 0\n")
+cfg_file.write("TRANSITION 0 0 1\n")
+cfg_file.close()
+
+system.tgens = [TrafficGen(config_file = cfg_file_name)
+                for i in range(options.gens)]
+for tgen in system.tgens:
+    tgen.port = system.membus.slave
+
+system.system_port = system.membus.slave
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+exit_event = m5.simulate(duration)
+print "Exiting @ tick %i because %s" % (m5.curTick(),
+                                        exit_event.getCause())
@@ -0,0 +1,149 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import addToPath, convert
+
+addToPath('../common')
+
+import MemConfig
+
+# Measures the bandwidth of the CopyEngine. The CopyEngineDriver builds a
+# chain of descriptors for each channel, starts the channels and stops the
+# simulation as soon as all copies are done. The achieved bandwidth is
+# reported as system.driver.bandwidth in stats.txt. See util/ce_bench.py to
+# sweep over the descriptor size.
+
+parser = optparse.OptionParser()
+
+parser.add_option("-m", "--maxtick", type="int", default=m5.MaxTick,
+                  metavar="T",
+                  help="Stop after T ticks")
+parser.add_option("--sys-clock", action="store", type="string",
+                  default='1GHz',
+                  help = """Top-level clock for blocks running at system
+                  speed""")
+parser.add_option("--mem-type", type="choice", default="DDR3_1600_x64",
+                  choices=MemConfig.mem_names(),
+                  help="Type of memory to use [default:%default]")
+parser.add_option("--mem-channels", type="int", default=1,
+                  help="Number of memory channels [default:%default]")
+parser.add_option("--mem-size", action="store", type="string",
+                  default="512MB",
+                  help="Size of the memory [default:%default]")
+parser.add_option("--bus-width", type="int", default=16,
+                  help="Width of the memory bus in bytes [default:%default]")
+parser.add_option("--channels", type="int", default=1,
+                  help="Number of copy engine channels [default:%default]")
+parser.add_option("--descriptors", type="int", default=64,
+                  help="Number of descriptors per channel [default:%default]")
+parser.add_option("--desc-size", type="string", default="4kB",
+                  help="Bytes per descriptor [default:%default]")
+parser.add_option("--status-interval", type="int", default=1,
+                  help="""Request the completion status for every N-th
+                  descriptor [default:%default]""")
+parser.add_option("--prefetch", type="int", default=1,
+                  help="""Number of descriptors per channel in flight
+                  [default:%default]""")
+parser.add_option("--pipeline", action="store_true",
+                  help="Overlap the reads and writes of a channel")
+parser.add_option("--coalesce", type="int", default=1,
+                  help="""Number of completions per status write
+                  [default:%default]""")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+desc_size = convert.toMemorySize(options.desc_size)
+mem_size = convert.toMemorySize(options.mem_size)
+
+# the driver places the descriptors, the status and the buffers of each
+# channel behind each other, starting at 1 MiB
+mem_addr = 0x100000
+chan_size = options.descriptors * (64 + 2 * desc_size) + 0x2000
+if mem_addr + options.channels * chan_size > mem_size:
+    print "Error: --mem-size is too small for the requested copies"
+    sys.exit(1)
+
+# the registers of the copy engine are placed behind the memory
+engine_addr = max(0x100000000, mem_size)
+
+system = System(membus = IOXBar(width = options.bus_width),
+                mem_mode = 'timing')
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain =
+                                   VoltageDomain(voltage = '1V'))
+system.mem_ranges = [AddrRange(options.mem_size)]
+
+options.external_memory_system = None
+options.tlm_memory = None
+MemConfig.config_mem(options, system)
+
+system.intrctrl = IntrControl()
+system.pc = Pc()
+system.pc.attachIO(system.membus)
+
+# fix BAR0 instead of letting an operating system assign it
+system.ce = CopyEngine(pci_bus = 0, pci_dev = 4, pci_func = 0,
+                       ChanCnt = options.channels,
+                       XferCap = max(desc_size, 4096),
+                       DescPrefetch = options.prefetch,
+                       Pipeline = options.pipeline,
+                       CoalesceCompletions = options.coalesce,
+                       BAR0LegacyIO = True,
+                       LegacyIOBase = engine_addr)
+system.ce.pio = system.membus.master
+system.ce.config = system.membus.master
+for i in range(options.channels):
+    system.ce.dma = system.membus.slave
+
+system.driver = CopyEngineDriver(engine_addr = engine_addr,
+                                 mem_addr = mem_addr,
+                                 channels = options.channels,
+                                 descriptors = options.descriptors,
+                                 desc_size = desc_size,
+                                 status_interval = options.status_interval)
+system.driver.port = system.membus.slave
+
+system.system_port = system.membus.slave
+
+root = Root(full_system = False, system = system)
+
+# Instantiate configuration
+m5.instantiate()
+
+# Simulate until all copies are done
+exit_event = m5.simulate(options.maxtick)
+
+print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
@@ -27,8 +27,10 @@
 # either expressed or implied, of the FreeBSD Project.
 
 import math
+import multiprocessing
 import optparse
 import os
+import sys
 
 import m5
 from m5.objects import *
@@ -98,6 +100,14 @@ def getOptions():
                       choices=CpuConfig.cpu_names(),
                       help="type of cpu to run with")
 
+    parser.add_option("--switch-cpu-type", type="choice", default=None,
+                      choices=CpuConfig.cpu_names(),
+                      help="""CPU type to switch all PEs to at --switch-at or
+                      when a PE executes the switchcpu pseudo instruction.
+                      Every further switchcpu switches back and forth""")
+    parser.add_option("--switch-at", metavar="TIME", type="int",
+                      help="Switch the CPUs at TIME (in ticks)")
+
     parser.add_option("-c", "--cmd", default="", type="string",
                       help="comma separated list of binaries")
 
@@ -135,6 +145,60 @@ def getOptions():
                       metavar="T",
                       help="Stop after T ticks")
 
+    parser.add_option("--stream-prefetch", action="store_true",
+                      help="Attach a stream prefetcher to the LLC of PEs")
+    parser.add_option("--compact-tags", action="store_true",
+                      help="""Use the CompactLRU tag store for the caches of
+                      PEs""")
+    parser.add_option("--dtu-stack-dist", action="store_true",
+                      help="""Record the stack distances of memory endpoint
+                      accesses and message slots of all DTUs""")
+    parser.add_option("--noc-trace", metavar="FILE", type="string",
+                      help="""Record the NoC packets of all DTUs to FILE
+                      (see configs/example/noc_replay.py)""")
+    parser.add_option("--no-page-sharing", action="store_false",
+                      dest="page_sharing", default=True,
+                      help="""Don't share identical memory pages of the PEs
+                      copy-on-write on the host""")
+
+    parser.add_option("--multi", action="store_true",
+                      help="Split the PEs across multiple gem5 processes")
+    parser.add_option("--multi-rank", default=0, type="int",
+                      help="Rank of this gem5 process (multi run)")
+    parser.add_option("--multi-pes", default=0, type="int",
+                      help="Number of PEs that each gem5 process simulates")
+    parser.add_option("--multi-latency", default="10ns", type="string",
+                      help="NoC latency between the processes (lookahead)")
+    parser.add_option("--multi-server-name", default="localhost",
+                      type="string", help="Message server name")
+    parser.add_option("--multi-server-port", default=2200, type="int",
+                      help="Message server port")
+
+    parser.add_option("--config-only", action="store_true",
+                      help="""Only write the configuration to the file given
+                      by --dump-config and exit (see --reuse-config)""")
+    parser.add_option("--reuse-config", metavar="FILE", type="string",
+                      help="""Don't build the configuration in Python, but
+                      instantiate FILE, written by --config-only, in C++ by
+                      running the binary given by --cxx-gem5""")
+    parser.add_option("--cxx-gem5", default="gem5.opt.cxx", type="string",
+                      help="""gem5 binary with C++ configuration support
+                      (see util/cxx_config) for --reuse-config""")
+    parser.add_option("--config-threads", type="int",
+                      default=multiprocessing.cpu_count(),
+                      help="""Number of host threads to instantiate the
+                      configuration with (--reuse-config)""")
+
+    parser.add_option("--checkpoint-at", metavar="TIME", type="int",
+                      help="""Write a checkpoint at tick TIME and exit.
+                      Checkpoints are also written on the checkpoint
+                      pseudo instruction""")
+    parser.add_option("--checkpoint-dir", type="string", default=None,
+                      help="""Directory to write the checkpoints to (default:
+                      the output directory)""")
+    parser.add_option("--restore", metavar="DIR", type="string",
+                      help="Restore the checkpoint in DIR")
+
     Options.addFSOptions(parser)
 
     (options, args) = parser.parse_args()
@@ -143,8 +207,57 @@ def getOptions():
         print "Error: script doesn't take any positional arguments"
         sys.exit(1)
 
+    if options.multi:
+        if options.multi_pes <= 0:
+            fatal("--multi requires --multi-pes")
+        if CpuConfig.get(options.cpu_type).memory_mode() == 'atomic':
+            fatal("--multi requires a timing CPU")
+        if options.switch_cpu_type:
+            fatal("--multi does not support switching CPUs")
+
+    if options.switch_at is not None and not options.switch_cpu_type:
+        fatal("--switch-at requires --switch-cpu-type")
+    if options.checkpoint_at is not None and options.switch_cpu_type:
+        fatal("--checkpoint-at does not support switching CPUs")
+
+    if options.reuse_config:
+        reuseConfig(options)
+
     return options
 
+# replaces this process with the C++-configured gem5, which instantiates the
+# given config file without building all SimObjects in Python first
+def reuseConfig(options):
+    if options.config_only:
+        fatal("--config-only and --reuse-config are mutually exclusive")
+    if not os.path.isfile(options.reuse_config):
+        fatal("Config file '%s' does not exist" % options.reuse_config)
+
+    args = [options.cxx_gem5, options.reuse_config,
+            '-j', str(options.config_threads)]
+    print 'Instantiating %s with %s' % (options.reuse_config, options.cxx_gem5)
+    sys.stdout.flush()
+    try:
+        os.execvp(options.cxx_gem5, args)
+    except OSError as e:
+        fatal("Unable to run '%s': %s" % (options.cxx_gem5, e))
+
+# returns the rank of the gem5 process that simulates PE <no>
+def peRank(options, no):
+    if not options.multi:
+        return 0
+    return no / options.multi_pes
+
+def isLocalPE(options, no):
+    return peRank(options, no) == options.multi_rank
+
+# PEs that are simulated by a peer process. We only need to know the amount of
+# internal memory of those, which is passed to all PEs (see runSimulation).
+class RemotePE(object):
+    def __init__(self, no, memsize):
+        self.core_id = no
+        self.memsize = memsize
+
 def createPE(root, options, no, mem, l1size, l2size, spmsize, memPE):
     if not spmsize is None:
         if convert.toMemorySize(spmsize) > pe_size:
@@ -169,6 +282,8 @@ def createPE(root, options, no, mem, l1size, l2size, spmsize, memPE):
 
     pe.pseudo_mem_ops = False
     pe.mmap_using_noreserve = True
+    # PEs running the same program have mostly identical memory contents
+    pe.share_identical_pages = options.page_sharing
 
     pe.dtu = Dtu()
     pe.dtu.core_id = no
@@ -177,6 +292,8 @@ def createPE(root, options, no, mem, l1size, l2size, spmsize, memPE):
     pe.dtu.rw_barrier=0x5B0000000
     pe.dtu.max_noc_packet_size="4kB"
     pe.dtu.num_endpoints=16
+    if options.dtu_stack_dist:
+        pe.dtu_stack_dist = DtuStackDistProbe()
 
     pe.dtu.icache_master_port = pe.xbar.slave
     pe.dtu.dcache_master_port = pe.xbar.slave
@@ -197,8 +314,19 @@ def createPE(root, options, no, mem, l1size, l2size, spmsize, memPE):
                 pe.dtu.l2cache.addr_ranges = [AddrRange(0, 0x1000000000000000 - 1)]
                 pe.dtu.l2cache.cpu_side = pe.dtu.l1cache.mem_side
                 pe.dtu.l2cache.mem_side = pe.dtu.cache_mem_slave_port
+                llc = pe.dtu.l2cache
             else:
                 pe.dtu.l1cache.mem_side = pe.dtu.cache_mem_slave_port
+                llc = pe.dtu.l1cache
+
+            if options.compact_tags:
+                pe.dtu.l1cache.tags = CompactLRU()
+                if not l2size is None:
+                    pe.dtu.l2cache.tags = CompactLRU()
+
+            # the DTU fetches adjacent prefetches with a single NoC request
+            if options.stream_prefetch:
+                llc.prefetcher = StreamPrefetcher()
 
             # don't check whether the kernel is in memory because a PE does not have memory in this
             # case, but just a cache that is connected to a different PE
@@ -233,6 +361,17 @@ def createPE(root, options, no, mem, l1size, l2size, spmsize, memPE):
 def createCorePE(root, options, no, cmdline, memPE, l1size=None, l2size=None, spmsize='8MB'):
     CPUClass = CpuConfig.get(options.cpu_type)
 
+    # the page tables are created with functional accesses to the memory PE,
+    # which can't be done across processes
+    if not l1size is None and peRank(options, no) != peRank(options, memPE):
+        fatal("PE%02d and its memory PE%02d have to be in the same process"
+              % (no, memPE))
+
+    if not isLocalPE(options, no):
+        if l1size is None:
+            return RemotePE(no, convert.toMemorySize(spmsize))
+        return RemotePE(no, 0)
+
     pe = createPE(
         root=root, options=options, no=no, mem=False,
         l1size=l1size, l2size=l2size, spmsize=spmsize, memPE=memPE
@@ -255,6 +394,8 @@ def createCorePE(root, options, no, cmdline, memPE, l1size=None, l2size=None, sp
     pe.boot_osflags = cmdline
     print "PE%02d: %s" % (no, cmdline)
     print '      core   =%s x86' % (options.cpu_type)
+    if options.switch_cpu_type:
+        print '      switch =%s x86' % (options.switch_cpu_type)
     try:
         print '      L1cache=%d KiB' % (pe.dtu.l1cache.size.value / 1024)
         if not l2size is None:
@@ -292,9 +433,21 @@ def createCorePE(root, options, no, cmdline, memPE, l1size=None, l2size=None, sp
     pe.cpu.itb.walker.port = pe.xbar.slave
     pe.cpu.dtb.walker.port = pe.xbar.slave
 
+    # the second CPU stays unconnected until it takes over the ports and the
+    # interrupt controller of the running one (see simulateWithSwitches)
+    if options.switch_cpu_type:
+        SwitchCPUClass = CpuConfig.get(options.switch_cpu_type)
+        pe.switch_cpu = SwitchCPUClass(switched_out=True)
+        pe.switch_cpu.cpu_id = 0
+        pe.switch_cpu.clk_domain = root.cpu_clk_domain
+
     return pe
 
 def createMemPE(root, options, no, size, content=None):
+    if not isLocalPE(options, no):
+        # set bit 0 to mark this as a memory PE
+        return RemotePE(no, MemorySize(size).value + 1)
+
     pe = createPE(
         root=root, options=options, no=no, mem=True,
         l1size=None, l2size=None, spmsize=None, memPE=0
@@ -350,6 +503,13 @@ def createRoot(options):
                                response_latency=1,
                                width=12)
 
+    # route the packets directly by the core id of the NoC address
+    root.noc.decode_shift = NOC_CORE_SHIFT
+    root.noc.decode_bits = NOC_CORE_BITS
+
+    if options.noc_trace:
+        root.noc_trace = NocTraceProbe(trace_file=options.noc_trace)
+
     # create a dummy platform and system for the UART
     root.platform = IOPlatform()
     root.platform.system = System()
@@ -364,10 +524,94 @@ def createRoot(options):
 
     return root
 
+# connects the NoC to the NoCs of the peer processes, which simulate the
+# remaining PEs. requests to those PEs are routed via the core id.
+def createNocBridge(root, options, pes):
+    def nocAddr(core):
+        return (1 << NOC_VALID_SHIFT) + (core << NOC_CORE_SHIFT)
+
+    ranges = []
+    ranks = []
+    for no in range(0, len(pes)):
+        ranks.append(peRank(options, no))
+        if not isLocalPE(options, no):
+            ranges.append(AddrRange(nocAddr(no), nocAddr(no + 1) - 1))
+
+    root.noc_bridge = NocBridge(ranges=ranges, core_ranks=ranks)
+    root.noc_bridge.delay = options.multi_latency
+    root.noc_bridge.multi_rank = options.multi_rank
+    root.noc_bridge.server_name = options.multi_server_name
+    root.noc_bridge.server_port = options.multi_server_port
+    root.noc_bridge.slave = root.noc.master
+    root.noc_bridge.master = root.noc.slave
+
+    print 'Simulating %d of %d PEs in process %d' % \
+        (len(pes) - len(ranges), len(pes), options.multi_rank)
+
+# simulates until the program terminates, while switching the CPUs of all PEs
+# at --switch-at and on every switchcpu pseudo instruction. the DTUs drain with
+# the rest of the system and adopt the memory mode of their PE afterwards.
+def simulateWithSwitches(options, pes):
+    systems = [pe for pe in pes if not isinstance(pe, RemotePE)]
+    cpus = [(pe.cpu, pe.switch_cpu) for pe in systems
+            if hasattr(pe, 'switch_cpu')]
+    switch_at = options.switch_at
+
+    while True:
+        timed = switch_at is not None and m5.curTick() < switch_at
+        if timed:
+            exit_event = m5.simulate(switch_at - m5.curTick())
+            timed = exit_event.getCause() == 'simulate() limit reached'
+        else:
+            exit_event = m5.simulate(options.maxtick - m5.curTick())
+
+        if timed:
+            switch_at = None
+        elif exit_event.getCause() != 'switchcpu':
+            return exit_event
+
+        if not cpus:
+            continue
+
+        print 'Switching %d PEs from %s to %s @ tick %d' % \
+            (len(cpus), cpus[0][0].type, cpus[0][1].type, m5.curTick())
+        m5.switchCpus(systems, cpus, verbose=False)
+        cpus = [(new, old) for old, new in cpus]
+
+# simulates until the program terminates, while writing a checkpoint on every
+# checkpoint pseudo instruction. at --checkpoint-at, it writes a checkpoint and
+# exits. the DTUs store their state after the drain, which includes transfers
+# that wait for a pagefault to be resolved.
+def simulateWithCheckpoints(options):
+    ckpt_dir = options.checkpoint_dir or m5.options.outdir
+
+    while True:
+        timed = options.checkpoint_at is not None and \
+                m5.curTick() < options.checkpoint_at
+        if timed:
+            exit_event = m5.simulate(options.checkpoint_at - m5.curTick())
+            timed = exit_event.getCause() == 'simulate() limit reached'
+        else:
+            exit_event = m5.simulate(options.maxtick - m5.curTick())
+
+        if not timed and exit_event.getCause() != 'checkpoint':
+            return exit_event
+
+        path = os.path.join(ckpt_dir, 'cpt.%d' % m5.curTick())
+        print 'Writing checkpoint to', path
+        m5.checkpoint(path)
+
+        if timed:
+            return exit_event
+
 def runSimulation(options, pes):
     # determine types of PEs and their internal memory size
     pemems = []
     for pe in pes:
+        if isinstance(pe, RemotePE):
+            pemems.append(pe.memsize)
+            continue
+
         size = 0
         try:
             size = int(pe.mem_ctrl.device_size)
@@ -384,15 +628,27 @@ def runSimulation(options, pes):
 
     # give that to the PEs
     for pe in pes:
+        if isinstance(pe, RemotePE):
+            continue
         try:
             pe.pes = pemems
         except:
             pass
 
+    if options.multi:
+        createNocBridge(Root.getInstance(), options, pes)
+
+    if options.config_only:
+        print 'Written configuration to', m5.dumpConfig()
+        sys.exit(0)
+
     # Instantiate configuration
-    m5.instantiate()
+    m5.instantiate(options.restore)
 
     # Simulate until program terminates
-    exit_event = m5.simulate(options.maxtick)
+    if options.switch_cpu_type:
+        exit_event = simulateWithSwitches(options, pes)
+    else:
+        exit_event = simulateWithCheckpoints(options)
 
     print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
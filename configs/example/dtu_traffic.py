@@ -0,0 +1,201 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+
+# Sets up a number of PEs that consist of a DtuTrafficGen, a DTU and a
+# scratchpad memory, which are connected via a NoC. Optionally, a memory PE is
+# added, which can be used as the target for READ and WRITE commands. The
+# statistics of the generators contain the latency distribution and achieved
+# bandwidth per command type.
+
+parser = optparse.OptionParser()
+
+parser.add_option("-a", "--atomic", action="store_true",
+                  help="Use atomic (non-timing) mode")
+parser.add_option("-m", "--maxtick", type="int", default=m5.MaxTick,
+                  metavar="T",
+                  help="Stop after T ticks")
+parser.add_option("--sys-clock", action="store", type="string",
+                  default='1GHz',
+                  help = """Top-level clock for blocks running at system
+                  speed""")
+parser.add_option("--cpu-clock", action="store", type="string",
+                  default='2GHz',
+                  help="Clock for blocks running at CPU speed")
+parser.add_option("--num-pes", type="int", default=4,
+                  help = "Number of PEs with traffic generators "
+                  "[default:%default]")
+parser.add_option("--mem-pe", action="store_true",
+                  help="Add a memory PE and use it for READ/WRITE")
+parser.add_option("--pattern", type="choice", default="uniform",
+                  choices=['uniform', 'hotspot', 'many_to_one', 'permutation'],
+                  help="Destination pattern [default:%default]")
+parser.add_option("--hotspot", type="int", default=0,
+                  help="PE that is the hotspot or sink [default:%default]")
+parser.add_option("--hotspot-percent", type="int", default=50,
+                  help="Percentage of commands to the hotspot "
+                  "[default:%default]")
+parser.add_option("--poisson", action="store_true",
+                  help="Use Poisson arrivals instead of periodic ones")
+parser.add_option("--interval", type="int", default=100,
+                  help="(Mean) cycles between two commands [default:%default]")
+parser.add_option("--read-percent", type="int", default=0,
+                  help="Percentage of READ commands [default:%default]")
+parser.add_option("--write-percent", type="int", default=0,
+                  help="Percentage of WRITE commands [default:%default]")
+parser.add_option("--no-reply", action="store_true",
+                  help="Don't reply to received messages")
+parser.add_option("--wait-reply", action="store_true",
+                  help="Wait for the reply before sending the next message")
+parser.add_option("--msg-size", type="string", default="64B",
+                  help="Message payload size [default:%default]")
+parser.add_option("--xfer-size", type="string", default="1kB",
+                  help="Size of READ/WRITE commands [default:%default]")
+parser.add_option("--max-ops", type="int", default=1000,
+                  help="Commands per generator (0 = unlimited) "
+                  "[default:%default]")
+parser.add_option("--paging", action="store_true",
+                  help="Let the DTU translate local addresses")
+parser.add_option("--tlb-entries", type="int", default=128,
+                  help="Number of DTU TLB entries with --paging "
+                  "[default:%default]")
+parser.add_option("--local-pages", type="int", default=1,
+                  help="Number of local pages to cycle through with --paging "
+                  "[default:%default]")
+parser.add_option("--seed", type="int", default=0,
+                  help="Seed for the permutation [default:%default]")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+if not options.num_pes > 0:
+    print "Error: Must have at least one PE"
+    sys.exit(1)
+
+mem_mode = 'atomic' if options.atomic else 'timing'
+
+root = Root(full_system=False)
+
+root.voltage_domain = VoltageDomain(voltage='1V')
+root.clk_domain = SrcClockDomain(clock=options.sys_clock,
+                                 voltage_domain=root.voltage_domain)
+root.cpu_clk_domain = SrcClockDomain(clock=options.cpu_clock,
+                                     voltage_domain=root.voltage_domain)
+
+# All PEs are connected to a NoC (Network on Chip). In this case it's just
+# a simple XBar.
+root.noc = NoncoherentXBar(forward_latency=0,
+                           frontend_latency=1,
+                           response_latency=1,
+                           width=12)
+
+# route the packets directly by the core id of the NoC address
+root.noc.decode_shift = NOC_CORE_SHIFT
+root.noc.decode_bits = NOC_CORE_BITS
+
+def createPE(no):
+    pe = System(mem_mode=mem_mode)
+    setattr(root, 'pe%02d' % no, pe)
+
+    pe.xbar = NoncoherentXBar(forward_latency=0,
+                              frontend_latency=0,
+                              response_latency=1,
+                              width=16)
+    pe.xbar.clk_domain = root.cpu_clk_domain
+
+    pe.dtu = Dtu()
+    pe.dtu.core_id = no
+    pe.dtu.clk_domain = root.cpu_clk_domain
+    pe.dtu.max_noc_packet_size = "4kB"
+    pe.dtu.num_endpoints = 8
+    # no caches; see dtu_fs.py
+    pe.dtu.block_size = pe.dtu.max_noc_packet_size
+    pe.dtu.buf_size = pe.dtu.max_noc_packet_size
+    pe.dtu.tlb_entries = options.tlb_entries if options.paging else 0
+
+    pe.dtu.icache_master_port = pe.xbar.slave
+    pe.dtu.dcache_master_port = pe.xbar.slave
+
+    pe.dtu.noc_master_port = root.noc.slave
+    pe.dtu.noc_slave_port = root.noc.master
+
+    pe.system_port = pe.xbar.slave
+    return pe
+
+gens = range(0, options.num_pes)
+for i in gens:
+    pe = createPE(i)
+
+    pe.spm = Scratchpad(in_addr_map="true")
+    pe.spm.cpu_port = pe.xbar.master
+    pe.spm.range = '1MB'
+
+    pe.cpu = DtuTrafficGen(id=i, pes=gens)
+    pe.cpu.clk_domain = root.cpu_clk_domain
+    pe.cpu.regfile_base_addr = pe.dtu.regfile_base_addr
+    pe.cpu.cmd_epid_bits = pe.dtu.num_cmd_epid_bits
+    pe.cpu.pattern = options.pattern
+    pe.cpu.hotspot = options.hotspot
+    pe.cpu.hotspot_percent = options.hotspot_percent
+    pe.cpu.seed = options.seed
+    pe.cpu.arrival = 'poisson' if options.poisson else 'periodic'
+    pe.cpu.interval = options.interval
+    pe.cpu.read_percent = options.read_percent
+    pe.cpu.write_percent = options.write_percent
+    pe.cpu.reply = not options.no_reply
+    pe.cpu.wait_reply = options.wait_reply
+    pe.cpu.msg_size = options.msg_size
+    pe.cpu.xfer_size = options.xfer_size
+    pe.cpu.max_ops = options.max_ops
+    pe.cpu.paging = options.paging
+    pe.cpu.local_pages = options.local_pages
+    pe.cpu.port = pe.dtu.dcache_slave_port
+
+if options.mem_pe:
+    no = options.num_pes
+    pe = createPE(no)
+    pe.mem_ctrl = DDR4_2400_x64()
+    pe.mem_ctrl.range = '64MB'
+    pe.mem_ctrl.port = pe.xbar.master
+    for i in gens:
+        getattr(root, 'pe%02d' % i).cpu.mem_pe = no
+
+# Instantiate configuration
+m5.instantiate()
+
+# Simulate until all generators are finished
+exit_event = m5.simulate(options.maxtick)
+
+print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
@@ -82,6 +82,24 @@ def cmd_line_template():
         return open(options.command_line_file).read().strip()
     return None
 
+def configure_disks(test_sys):
+    disk_opts = options.second_disk_image or options.disk_mmap or \
+        options.cow_sparse
+    if not disk_opts:
+        return
+    if buildEnv['TARGET_ISA'] != "x86":
+        fatal("The disk options are only supported on x86")
+
+    disks = test_sys.pc.south_bridge.ide.disks
+    if options.second_disk_image:
+        disks[1].childImage(options.second_disk_image)
+    for i, disk in enumerate(disks):
+        disk.image.child.mmap = options.disk_mmap
+        disk.image.child.read_ahead = options.disk_read_ahead
+        disk.image.child.drop_behind = options.disk_drop_behind
+        if options.cow_sparse:
+            disk.image.sparse_file = 'disk%d.cow' % i
+
 def build_test_system(np):
     cmdline = cmd_line_template()
     if buildEnv['TARGET_ISA'] == "alpha":
@@ -137,6 +155,8 @@ def build_test_system(np):
 
     test_sys.init_param = options.init_param
 
+    configure_disks(test_sys)
+
     # For now, assign all the CPUs to the same clock domain
     test_sys.cpu = [TestCPUClass(clk_domain=test_sys.cpu_clk_domain, cpu_id=i)
                     for i in xrange(np)]
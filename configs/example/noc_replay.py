@@ -0,0 +1,122 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+
+# Replays a NoC trace that has been recorded with dtu_fs.py --noc-trace on a
+# standalone NoC. The NoC is the same crossbar as in dtu_fs.py by default;
+# its width and latencies can be changed to study their influence without
+# simulating the PEs.
+
+parser = optparse.OptionParser()
+
+parser.add_option("-m", "--maxtick", type="int", default=m5.MaxTick,
+                  metavar="T",
+                  help="Stop after T ticks")
+parser.add_option("--sys-clock", action="store", type="string",
+                  default='1GHz',
+                  help = """Top-level clock for blocks running at system
+                  speed""")
+parser.add_option("--cpu-clock", action="store", type="string",
+                  default='2GHz',
+                  help="Clock of the replayed DTUs")
+parser.add_option("--trace", type="string",
+                  help="The NoC trace to replay")
+parser.add_option("--cores", type="string", default="0-15",
+                  help="""Core ids to replay as a comma-separated list of ids
+                  and ranges [default:%default]""")
+parser.add_option("--rigid", action="store_true",
+                  help="""Issue the packets at the recorded ticks instead of
+                  relative to their dependencies""")
+parser.add_option("--response-latency", type="int", default=1,
+                  help="Cycles until a core responds [default:%default]")
+parser.add_option("--noc-width", type="int", default=12,
+                  help="Width of the NoC in bytes [default:%default]")
+parser.add_option("--noc-frontend-latency", type="int", default=1,
+                  help="Frontend latency of the NoC [default:%default]")
+parser.add_option("--noc-forward-latency", type="int", default=0,
+                  help="Forward latency of the NoC [default:%default]")
+parser.add_option("--noc-response-latency", type="int", default=1,
+                  help="Response latency of the NoC [default:%default]")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+if not options.trace:
+    print "Error: --trace is required"
+    sys.exit(1)
+
+cores = []
+for part in options.cores.split(','):
+    if '-' in part:
+        first, last = part.split('-')
+        cores += range(int(first), int(last) + 1)
+    else:
+        cores.append(int(part))
+
+root = Root(full_system=False)
+
+root.voltage_domain = VoltageDomain(voltage='1V')
+root.clk_domain = SrcClockDomain(clock=options.sys_clock,
+                                 voltage_domain=root.voltage_domain)
+root.cpu_clk_domain = SrcClockDomain(clock=options.cpu_clock,
+                                     voltage_domain=root.voltage_domain)
+
+root.noc = NoncoherentXBar(forward_latency=options.noc_forward_latency,
+                           frontend_latency=options.noc_frontend_latency,
+                           response_latency=options.noc_response_latency,
+                           width=options.noc_width)
+
+# route the packets directly by the core id of the NoC address
+root.noc.decode_shift = NOC_CORE_SHIFT
+root.noc.decode_bits = NOC_CORE_BITS
+
+root.system = System(mem_mode='timing')
+root.system.system_port = root.noc.slave
+
+root.system.replay = NocTraceReplay(trace_file=options.trace, cores=cores)
+root.system.replay.clk_domain = root.cpu_clk_domain
+root.system.replay.elastic = not options.rigid
+root.system.replay.response_latency = options.response_latency
+for i in range(len(cores)):
+    root.system.replay.port = root.noc.slave
+    root.system.replay.sink = root.noc.master
+
+# Instantiate configuration
+m5.instantiate()
+
+# Simulate until all packets have been replayed
+exit_event = m5.simulate(options.maxtick)
+
+print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
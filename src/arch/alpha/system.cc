@@ -139,6 +139,8 @@ AlphaSystem::initState()
 void
 AlphaSystem::startup()
 {
+    System::startup();
+
     // Setup all the function events now that we have a system and a symbol
     // table
     setupFuncEvents();
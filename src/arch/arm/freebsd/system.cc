@@ -164,4 +164,5 @@ FreebsdArmSystemParams::create()
 void
 FreebsdArmSystem::startup()
 {
+    ArmSystem::startup();
 }
@@ -32,6 +32,7 @@
 #ifndef __INIFILE_HH__
 #define __INIFILE_HH__
 
+#include <atomic>
 #include <fstream>
 #include <list>
 #include <string>
@@ -62,7 +63,9 @@ class IniFile
     class Entry
     {
         std::string     value;          ///< The entry value.
-        mutable bool    referenced;     ///< Has this entry been used?
+        /// Has this entry been used?  Atomic, because lookups may be done
+        /// by several threads (see CxxConfigManager).
+        mutable std::atomic<bool> referenced;
 
       public:
         /// Constructor.
@@ -97,7 +100,7 @@ class IniFile
         typedef m5::hash_map<std::string, Entry *> EntryTable;
 
         EntryTable      table;          ///< Table of entries.
-        mutable bool    referenced;     ///< Has this section been used?
+        mutable std::atomic<bool> referenced; ///< Has this section been used?
 
       public:
         /// Constructor.
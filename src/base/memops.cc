@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "base/memops.hh"
+#include "base/misc.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__SSE2__)
+#define MEMOPS_SSE2 1
+#include <emmintrin.h>
+#endif
+// the target attribute allows us to use AVX2 without compiling the
+// whole simulator for it
+#if defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define MEMOPS_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace MemOps
+{
+
+namespace
+{
+
+/**
+ * Below this size, we simply use memcpy, because the non-temporal
+ * stores only pay off for blocks that would thrash the caches.
+ */
+const size_t STREAM_THRESHOLD = 4096;
+
+struct Ops
+{
+    bool (*isZero)(const void *p, size_t size);
+    bool (*equal)(const void *a, const void *b, size_t size);
+    void (*copyBlock)(void *dst, const void *src, size_t size);
+};
+
+bool
+isZeroGeneric(const void *p, size_t size)
+{
+    const uint8_t *b = static_cast<const uint8_t*>(p);
+    for (; size > 0 && (reinterpret_cast<uintptr_t>(b) & 7); --size) {
+        if (*b++)
+            return false;
+    }
+
+    const uint64_t *w = reinterpret_cast<const uint64_t*>(b);
+    for (; size >= 32; size -= 32, w += 4) {
+        if (w[0] | w[1] | w[2] | w[3])
+            return false;
+    }
+    for (; size >= 8; size -= 8) {
+        if (*w++)
+            return false;
+    }
+
+    b = reinterpret_cast<const uint8_t*>(w);
+    for (; size > 0; --size) {
+        if (*b++)
+            return false;
+    }
+    return true;
+}
+
+bool
+equalGeneric(const void *a, const void *b, size_t size)
+{
+    return memcmp(a, b, size) == 0;
+}
+
+void
+copyGeneric(void *dst, const void *src, size_t size)
+{
+    memcpy(dst, src, size);
+}
+
+#if MEMOPS_SSE2
+
+inline __m128i
+load128(const uint8_t *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline bool
+isZero128(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) ==
+           0xffff;
+}
+
+bool
+isZeroSSE2(const void *p, size_t size)
+{
+    const uint8_t *b = static_cast<const uint8_t*>(p);
+    for (; size >= 64; size -= 64, b += 64) {
+        __m128i v = _mm_or_si128(_mm_or_si128(load128(b), load128(b + 16)),
+                                 _mm_or_si128(load128(b + 32),
+                                              load128(b + 48)));
+        if (!isZero128(v))
+            return false;
+    }
+    for (; size >= 16; size -= 16, b += 16) {
+        if (!isZero128(load128(b)))
+            return false;
+    }
+    return isZeroGeneric(b, size);
+}
+
+bool
+equalSSE2(const void *a, const void *b, size_t size)
+{
+    const uint8_t *x = static_cast<const uint8_t*>(a);
+    const uint8_t *y = static_cast<const uint8_t*>(b);
+    for (; size >= 64; size -= 64, x += 64, y += 64) {
+        __m128i v = _mm_or_si128(
+            _mm_or_si128(_mm_xor_si128(load128(x), load128(y)),
+                         _mm_xor_si128(load128(x + 16), load128(y + 16))),
+            _mm_or_si128(_mm_xor_si128(load128(x + 32), load128(y + 32)),
+                         _mm_xor_si128(load128(x + 48), load128(y + 48))));
+        if (!isZero128(v))
+            return false;
+    }
+    for (; size >= 16; size -= 16, x += 16, y += 16) {
+        if (!isZero128(_mm_xor_si128(load128(x), load128(y))))
+            return false;
+    }
+    return memcmp(x, y, size) == 0;
+}
+
+void
+copySSE2(void *dst, const void *src, size_t size)
+{
+    if (size < STREAM_THRESHOLD) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    uint8_t *d = static_cast<uint8_t*>(dst);
+    const uint8_t *s = static_cast<const uint8_t*>(src);
+
+    // the non-temporal stores need an aligned destination
+    size_t head = -reinterpret_cast<uintptr_t>(d) & 15;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        __m128i v0 = load128(s);
+        __m128i v1 = load128(s + 16);
+        __m128i v2 = load128(s + 32);
+        __m128i v3 = load128(s + 48);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d), v0);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), v1);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), v2);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), v3);
+    }
+    // make the stores visible before ordinary accesses follow
+    _mm_sfence();
+
+    memcpy(d, s, size);
+}
+
+#endif // MEMOPS_SSE2
+
+#if MEMOPS_AVX2
+
+#define AVX2_FUNC __attribute__((target("avx2")))
+
+AVX2_FUNC inline __m256i
+load256(const uint8_t *p)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2_FUNC bool
+isZeroAVX2(const void *p, size_t size)
+{
+    const uint8_t *b = static_cast<const uint8_t*>(p);
+    for (; size >= 128; size -= 128, b += 128) {
+        __m256i v = _mm256_or_si256(
+            _mm256_or_si256(load256(b), load256(b + 32)),
+            _mm256_or_si256(load256(b + 64), load256(b + 96)));
+        if (!_mm256_testz_si256(v, v))
+            return false;
+    }
+    for (; size >= 32; size -= 32, b += 32) {
+        __m256i v = load256(b);
+        if (!_mm256_testz_si256(v, v))
+            return false;
+    }
+    return isZeroGeneric(b, size);
+}
+
+AVX2_FUNC bool
+equalAVX2(const void *a, const void *b, size_t size)
+{
+    const uint8_t *x = static_cast<const uint8_t*>(a);
+    const uint8_t *y = static_cast<const uint8_t*>(b);
+    for (; size >= 128; size -= 128, x += 128, y += 128) {
+        __m256i v = _mm256_or_si256(
+            _mm256_or_si256(_mm256_xor_si256(load256(x), load256(y)),
+                            _mm256_xor_si256(load256(x + 32),
+                                             load256(y + 32))),
+            _mm256_or_si256(_mm256_xor_si256(load256(x + 64),
+                                             load256(y + 64)),
+                            _mm256_xor_si256(load256(x + 96),
+                                             load256(y + 96))));
+        if (!_mm256_testz_si256(v, v))
+            return false;
+    }
+    for (; size >= 32; size -= 32, x += 32, y += 32) {
+        __m256i v = _mm256_xor_si256(load256(x), load256(y));
+        if (!_mm256_testz_si256(v, v))
+            return false;
+    }
+    return memcmp(x, y, size) == 0;
+}
+
+AVX2_FUNC void
+copyAVX2(void *dst, const void *src, size_t size)
+{
+    if (size < STREAM_THRESHOLD) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    uint8_t *d = static_cast<uint8_t*>(dst);
+    const uint8_t *s = static_cast<const uint8_t*>(src);
+
+    // the non-temporal stores need an aligned destination
+    size_t head = -reinterpret_cast<uintptr_t>(d) & 31;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+
+    for (; size >= 128; size -= 128, d += 128, s += 128) {
+        __m256i v0 = load256(s);
+        __m256i v1 = load256(s + 32);
+        __m256i v2 = load256(s + 64);
+        __m256i v3 = load256(s + 96);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d), v0);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), v1);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), v2);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), v3);
+    }
+    // make the stores visible before ordinary accesses follow
+    _mm_sfence();
+
+    memcpy(d, s, size);
+}
+
+#endif // MEMOPS_AVX2
+
+const Ops impls[NUM_IMPLS] = {
+    { isZeroGeneric, equalGeneric, copyGeneric },
+#if MEMOPS_SSE2
+    { isZeroSSE2, equalSSE2, copySSE2 },
+#else
+    { isZeroGeneric, equalGeneric, copyGeneric },
+#endif
+#if MEMOPS_AVX2
+    { isZeroAVX2, equalAVX2, copyAVX2 },
+#else
+    { isZeroGeneric, equalGeneric, copyGeneric },
+#endif
+};
+
+Impl
+detectImpl()
+{
+#if MEMOPS_AVX2 || MEMOPS_SSE2
+    // we might be called before the constructor of libgcc
+    __builtin_cpu_init();
+#endif
+#if MEMOPS_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+#endif
+#if MEMOPS_SSE2
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+#endif
+    return GENERIC;
+}
+
+const Impl best = detectImpl();
+const Ops *ops = &impls[best];
+
+} // anonymous namespace
+
+bool
+isZero(const void *p, size_t size)
+{
+    return ops->isZero(p, size);
+}
+
+bool
+equal(const void *a, const void *b, size_t size)
+{
+    return ops->equal(a, b, size);
+}
+
+void
+copyBlock(void *dst, const void *src, size_t size)
+{
+    ops->copyBlock(dst, src, size);
+}
+
+Impl
+bestImpl()
+{
+    return best;
+}
+
+void
+setImpl(Impl impl)
+{
+    panic_if(impl > best, "Implementation %s is not supported by the host\n",
+             implName(impl));
+    ops = &impls[impl];
+}
+
+const char *
+implName(Impl impl)
+{
+    static const char *names[NUM_IMPLS] = { "generic", "SSE2", "AVX2" };
+    return impl < NUM_IMPLS ? names[impl] : "unknown";
+}
+
+} // namespace MemOps
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __BASE_MEMOPS_HH__
+#define __BASE_MEMOPS_HH__
+
+#include <cstddef>
+
+/**
+ * Vectorized operations on large blocks of host memory, like checking
+ * whether a page is zero or copying a memory image. They are used when
+ * loading, restoring and comparing the backing store, where we go over
+ * gigabytes of memory byte by byte otherwise.
+ *
+ * The functions use SSE2 or AVX2, depending on what the host supports,
+ * which is determined once at startup. On other hosts, they fall back
+ * to a portable implementation that processes 64-bit words.
+ */
+namespace MemOps
+{
+
+/**
+ * The available implementations.
+ */
+enum Impl
+{
+    GENERIC,
+    SSE2,
+    AVX2,
+    NUM_IMPLS
+};
+
+/**
+ * Checks whether the given memory block contains only zeros.
+ *
+ * @param p the start of the block
+ * @param size the size of the block in bytes
+ * @return true if all bytes are zero
+ */
+bool isZero(const void *p, size_t size);
+
+/**
+ * Checks whether the given memory blocks have the same contents. In
+ * contrast to memcmp, this does not determine an order.
+ *
+ * @param a the first block
+ * @param b the second block
+ * @param size the size of both blocks in bytes
+ * @return true if the blocks are equal
+ */
+bool equal(const void *a, const void *b, size_t size);
+
+/**
+ * Copies a large memory block that is not accessed again soon, e.g., a
+ * memory image into the backing store. The copy uses non-temporal
+ * stores to not thrash the host caches; small blocks are simply copied
+ * with memcpy. The blocks must not overlap.
+ *
+ * @param dst the destination
+ * @param src the source
+ * @param size the number of bytes to copy
+ */
+void copyBlock(void *dst, const void *src, size_t size);
+
+/**
+ * @return the best implementation that is supported by the host
+ */
+Impl bestImpl();
+
+/**
+ * Selects the implementation to use, which is bestImpl() by default.
+ * This is intended for tests and benchmarks.
+ *
+ * @param impl the implementation (has to be supported by the host)
+ */
+void setImpl(Impl impl);
+
+/**
+ * @return the name of the given implementation
+ */
+const char *implName(Impl impl);
+
+} // namespace MemOps
+
+#endif // __BASE_MEMOPS_HH__
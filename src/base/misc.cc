@@ -82,6 +82,9 @@ __exit_epilogue(int code,
                 const char *func, const char *file, int line,
                 const char *format)
 {
+    // make sure that the debug output leading to this is complete
+    Trace::getDebugLogger()->sync();
+
     newline_if_needed(std::cerr, format);
 
     ccprintf(std::cerr,
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __BASE_MPSC_QUEUE_HH__
+#define __BASE_MPSC_QUEUE_HH__
+
+#include <atomic>
+
+/**
+ * A lock-free queue with multiple producers and a single consumer. The
+ * items are linked intrusively through the pointer member Link, so that
+ * pushing an item never allocates memory. The item must not be in any
+ * other list that uses this member while it is in the queue.
+ *
+ * Producers push onto an atomic stack with a compare-and-swap. The
+ * consumer takes all items at once with a single exchange and reverses
+ * the stack, which hands out the items in the order in which they have
+ * been pushed. Since the consumer never removes single items, the queue
+ * does not suffer from the ABA problem.
+ */
+template <class T, T *T::*Link>
+class MpscQueue
+{
+  public:
+    MpscQueue() : head(nullptr)
+    {
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * Adds the given item to the queue. May be called by any thread.
+     */
+    void push(T *item)
+    {
+        T *old = head.load(std::memory_order_relaxed);
+        do {
+            item->*Link = old;
+        } while (!head.compare_exchange_weak(old, item,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+
+    /**
+     * Removes all items from the queue. May only be called by the consumer.
+     *
+     * @return the oldest item, linked to the next one via Link (the last
+     *         item links to nullptr), or nullptr if the queue was empty
+     */
+    T *popAll()
+    {
+        if (empty())
+            return nullptr;
+
+        T *items = head.exchange(nullptr, std::memory_order_acquire);
+        T *prev = nullptr;
+        while (items) {
+            T *next = items->*Link;
+            items->*Link = prev;
+            prev = items;
+            items = next;
+        }
+        return prev;
+    }
+
+    /**
+     * @return true if the queue was empty at the time of the call
+     */
+    bool empty() const
+    {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+  private:
+    std::atomic<T*> head;
+};
+
+#endif // __BASE_MPSC_QUEUE_HH__
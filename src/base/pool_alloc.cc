@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "base/pool_alloc.hh"
+
+__thread PoolAlloc::FreeChunk *
+    PoolAlloc::objFreeLists[PoolAlloc::NumObjClasses];
+__thread PoolAlloc::FreeChunk *
+    PoolAlloc::bufFreeLists[PoolAlloc::NumBufClasses];
+
+namespace
+{
+
+/// Magic values to detect double frees and foreign pointers
+enum : uint32_t
+{
+    MAGIC_USED  = 0x9001A110,
+    MAGIC_FREE  = 0x9001F4EE,
+};
+
+/// The pattern freed objects are filled with in debug mode
+const uint8_t FREE_PATTERN = 0xDB;
+
+/**
+ * Precedes every buffer and, in debug mode, every object. It is 16 bytes
+ * large to keep the alignment of the following memory.
+ */
+struct ChunkHeader
+{
+    uint32_t magic;
+    uint32_t cls;
+    uint64_t size;
+};
+
+static_assert(sizeof(ChunkHeader) == 16, "Unexpected header size");
+
+}
+
+PoolAlloc::FreeChunk *
+PoolAlloc::refill(FreeChunk *&list, size_t chunkSize, size_t offset)
+{
+    size_t count = std::max<size_t>(1, SlabSize / chunkSize);
+    uint8_t *slab = static_cast<uint8_t*>(::operator new(count * chunkSize));
+
+    // link them together in ascending order
+    for (size_t i = 0; i < count; ++i)
+    {
+        FreeChunk *chunk = reinterpret_cast<FreeChunk*>(
+            slab + i * chunkSize + offset);
+        chunk->next = i + 1 < count
+            ? reinterpret_cast<FreeChunk*>(slab + (i + 1) * chunkSize + offset)
+            : list;
+    }
+
+    list = reinterpret_cast<FreeChunk*>(slab + offset);
+    return list;
+}
+
+/*
+ * Chunks with a header are linked via their payload, i.e., the lists point
+ * behind the header. This way, the magic value survives while the chunk is
+ * free, which allows us to detect double frees.
+ */
+
+static ChunkHeader *
+headerOf(void *payload)
+{
+    return static_cast<ChunkHeader*>(payload) - 1;
+}
+
+void *
+PoolAlloc::allocateDebug(size_t sz)
+{
+    size_t total = sz + sizeof(ChunkHeader);
+
+    void *payload;
+    if (total > MaxObjSize)
+    {
+        ChunkHeader *hdr = static_cast<ChunkHeader*>(::operator new(total));
+        payload = hdr + 1;
+    }
+    else
+    {
+        size_t cls = objClass(total);
+        FreeChunk *chunk = objFreeLists[cls];
+        if (!chunk)
+        {
+            chunk = refill(objFreeLists[cls], objSize(cls),
+                           sizeof(ChunkHeader));
+        }
+        objFreeLists[cls] = chunk->next;
+        payload = chunk;
+    }
+
+    ChunkHeader *hdr = headerOf(payload);
+    hdr->magic = MAGIC_USED;
+    hdr->cls = 0;
+    hdr->size = sz;
+    return payload;
+}
+
+void
+PoolAlloc::deallocateDebug(void *p, size_t sz)
+{
+    ChunkHeader *hdr = headerOf(p);
+
+    if (hdr->magic == MAGIC_FREE)
+        panic("PoolAlloc: double free of object %p (%lu bytes)\n", p, sz);
+    if (hdr->magic != MAGIC_USED)
+        panic("PoolAlloc: freeing object %p, which is not from the pool\n", p);
+    if (hdr->size != sz)
+    {
+        panic("PoolAlloc: freeing object %p with size %lu, but it has %lu\n",
+              p, sz, hdr->size);
+    }
+
+    hdr->magic = MAGIC_FREE;
+    memset(p, FREE_PATTERN, sz);
+
+    size_t total = sz + sizeof(ChunkHeader);
+    if (total > MaxObjSize)
+    {
+        // we can't detect double frees of these, but that's the best we can
+        // do without keeping the memory forever
+        ::operator delete(hdr);
+        return;
+    }
+
+    size_t cls = objClass(total);
+    FreeChunk *chunk = static_cast<FreeChunk*>(p);
+    chunk->next = objFreeLists[cls];
+    objFreeLists[cls] = chunk;
+}
+
+uint8_t *
+PoolAlloc::allocateBuffer(size_t sz)
+{
+    unsigned bits = sz <= 1 ? 0 : ceilLog2(sz);
+    if (bits < MinBufBits)
+        bits = MinBufBits;
+
+    void *payload;
+    size_t cls;
+#if POOL_ALLOC
+    if (bits <= MaxBufBits)
+    {
+        cls = bits - MinBufBits;
+        FreeChunk *chunk = bufFreeLists[cls];
+        if (!chunk)
+        {
+            size_t chunkSize = sizeof(ChunkHeader) + (1UL << bits);
+            chunk = refill(bufFreeLists[cls], chunkSize, sizeof(ChunkHeader));
+        }
+        bufFreeLists[cls] = chunk->next;
+        payload = chunk;
+    }
+    else
+#endif
+    {
+        cls = NumBufClasses;
+        ChunkHeader *hdr = static_cast<ChunkHeader*>(
+            ::operator new(sizeof(ChunkHeader) + sz));
+        payload = hdr + 1;
+    }
+
+    ChunkHeader *hdr = headerOf(payload);
+    hdr->magic = MAGIC_USED;
+    hdr->cls = cls;
+    hdr->size = sz;
+    return static_cast<uint8_t*>(payload);
+}
+
+void
+PoolAlloc::deallocateBuffer(uint8_t *buf)
+{
+    if (!buf)
+        return;
+
+    ChunkHeader *hdr = headerOf(buf);
+
+#if POOL_ALLOC_DEBUG
+    if (hdr->magic == MAGIC_FREE)
+        panic("PoolAlloc: double free of buffer %p\n", buf);
+    if (hdr->magic != MAGIC_USED)
+    {
+        panic("PoolAlloc: freeing buffer %p, which is not from the pool\n",
+              buf);
+    }
+    memset(buf, FREE_PATTERN, hdr->size);
+#else
+    assert(hdr->magic == MAGIC_USED);
+#endif
+    hdr->magic = MAGIC_FREE;
+
+    if (hdr->cls == NumBufClasses)
+    {
+        ::operator delete(hdr);
+        return;
+    }
+
+    FreeChunk *chunk = reinterpret_cast<FreeChunk*>(buf);
+    chunk->next = bufFreeLists[hdr->cls];
+    bufFreeLists[hdr->cls] = chunk;
+}
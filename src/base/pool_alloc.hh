@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __BASE_POOL_ALLOC_HH__
+#define __BASE_POOL_ALLOC_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <utility>
+
+#include "config/pool_alloc.hh"
+#include "config/pool_alloc_debug.hh"
+
+/**
+ * Pooled allocation for objects that are allocated and freed at a high
+ * rate, like packets, requests and sender states. Classes that derive from
+ * PoolAlloc get an operator new and delete that serve the memory from
+ * thread-local free lists with fixed size classes. The memory is never
+ * given back to the system, but reused for the next object of the same
+ * size class. An object may be freed by another thread than the one that
+ * allocated it; its memory simply ends up in the free list of the freeing
+ * thread.
+ *
+ * Additionally, PoolAlloc provides byte buffers (used for packet payloads)
+ * with power-of-two size classes.
+ *
+ * If gem5 is built with POOL_ALLOC_DEBUG, each object carries a header
+ * that records whether it is in use, so that double frees (and frees of
+ * memory that has not been allocated by the pool) are detected. Freed
+ * memory is overwritten to make use-after-free bugs more visible. With
+ * POOL_ALLOC disabled, the global operator new and delete are used.
+ */
+class PoolAlloc
+{
+  public:
+    /// Objects are pooled in size classes with this granularity
+    static const size_t ObjGranularity = 16;
+    /// Objects up to this size are pooled; larger ones use operator new
+    static const size_t MaxObjSize = 512;
+    static const size_t NumObjClasses = MaxObjSize / ObjGranularity;
+
+    /// Buffers are pooled in power-of-two size classes in this range
+    static const unsigned MinBufBits = 4;
+    static const unsigned MaxBufBits = 16;
+    static const size_t NumBufClasses = MaxBufBits - MinBufBits + 1;
+
+    /// The amount of memory that is requested at once if a list is empty
+    static const size_t SlabSize = 64 * 1024;
+
+#if POOL_ALLOC
+    static void *
+    operator new(size_t sz)
+    {
+        return allocate(sz);
+    }
+
+    static void
+    operator delete(void *p, size_t sz)
+    {
+        deallocate(p, sz);
+    }
+#endif
+
+    /**
+     * Allocates <sz> bytes from the pool of the corresponding size class.
+     */
+    static void *
+    allocate(size_t sz)
+    {
+#if POOL_ALLOC_DEBUG
+        return allocateDebug(sz);
+#else
+        if (sz > MaxObjSize)
+            return ::operator new(sz);
+
+        size_t cls = objClass(sz);
+        FreeChunk *chunk = objFreeLists[cls];
+        if (!chunk)
+            chunk = refill(objFreeLists[cls], objSize(cls));
+        objFreeLists[cls] = chunk->next;
+        return chunk;
+#endif
+    }
+
+    /**
+     * Gives the object at <p> with given size back to the pool.
+     */
+    static void
+    deallocate(void *p, size_t sz)
+    {
+        if (!p)
+            return;
+
+#if POOL_ALLOC_DEBUG
+        deallocateDebug(p, sz);
+#else
+        if (sz > MaxObjSize)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        size_t cls = objClass(sz);
+        FreeChunk *chunk = static_cast<FreeChunk*>(p);
+        chunk->next = objFreeLists[cls];
+        objFreeLists[cls] = chunk;
+#endif
+    }
+
+    /**
+     * Allocates a buffer of at least <sz> bytes. It has to be freed via
+     * deallocateBuffer.
+     */
+    static uint8_t *allocateBuffer(size_t sz);
+
+    /**
+     * Gives the buffer back to the pool.
+     */
+    static void deallocateBuffer(uint8_t *buf);
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    static size_t
+    objClass(size_t sz)
+    {
+        return sz == 0 ? 0 : (sz - 1) / ObjGranularity;
+    }
+
+    static size_t
+    objSize(size_t cls)
+    {
+        return (cls + 1) * ObjGranularity;
+    }
+
+    /**
+     * Allocates a new slab and puts its chunks into <list>. The list links
+     * are placed at <offset> within the chunks, so that a preceding header
+     * stays intact.
+     */
+    static FreeChunk *refill(FreeChunk *&list, size_t chunkSize,
+                             size_t offset = 0);
+
+    static void *allocateDebug(size_t sz);
+    static void deallocateDebug(void *p, size_t sz);
+
+    static __thread FreeChunk *objFreeLists[NumObjClasses];
+    static __thread FreeChunk *bufFreeLists[NumBufClasses];
+};
+
+/**
+ * An STL allocator that takes the memory from PoolAlloc. It is meant for
+ * node-based containers like std::list, whose nodes are allocated one at a
+ * time and would otherwise cost a call to malloc for every insertion.
+ */
+template <class T>
+class PoolAllocator
+{
+  public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef PoolAllocator<U> other;
+    };
+
+    PoolAllocator() {}
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+
+    size_type
+    max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    pointer
+    allocate(size_type n, const void * = 0)
+    {
+#if POOL_ALLOC
+        return static_cast<pointer>(PoolAlloc::allocate(n * sizeof(T)));
+#else
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+#endif
+    }
+
+    void
+    deallocate(pointer p, size_type n)
+    {
+#if POOL_ALLOC
+        PoolAlloc::deallocate(p, n * sizeof(T));
+#else
+        ::operator delete(p);
+#endif
+    }
+
+    template <class U, class... Args>
+    void
+    construct(U *p, Args&&... args)
+    {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <class U>
+    void destroy(U *p) { p->~U(); }
+};
+
+template <class T, class U>
+bool
+operator==(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return true;
+}
+
+template <class T, class U>
+bool
+operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return false;
+}
+
+/**
+ * A pool for the objects of a single class that are too large for the size
+ * classes of PoolAlloc, like the dynamic instructions of the O3 CPU. The
+ * class uses it in its operator new and delete. The pool is thread-local
+ * and grows in batches, whose size can be raised by the users, e.g., to the
+ * number of instructions a CPU can have in flight. Thus, a CPU usually
+ * allocates the memory for all its instructions at once. In debug mode, the
+ * objects are allocated with operator new instead to not hide bugs from
+ * tools like valgrind.
+ */
+template <class T>
+class ObjectPool
+{
+  public:
+    /**
+     * Makes sure that the pool grows by at least <n> objects at once.
+     */
+    static void
+    reserve(size_t n)
+    {
+        batchSize = std::max(batchSize, n);
+    }
+
+    static void *
+    allocate()
+    {
+#if POOL_ALLOC && !POOL_ALLOC_DEBUG
+        if (!freeList)
+            refill();
+        FreeChunk *chunk = freeList;
+        freeList = chunk->next;
+        return chunk;
+#else
+        return ::operator new(sizeof(T));
+#endif
+    }
+
+    static void
+    deallocate(void *p)
+    {
+        if (!p)
+            return;
+
+#if POOL_ALLOC && !POOL_ALLOC_DEBUG
+        FreeChunk *chunk = static_cast<FreeChunk*>(p);
+        chunk->next = freeList;
+        freeList = chunk;
+#else
+        ::operator delete(p);
+#endif
+    }
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    static size_t
+    chunkSize()
+    {
+        size_t size = std::max(sizeof(T), sizeof(FreeChunk));
+        return (size + PoolAlloc::ObjGranularity - 1) &
+               ~(PoolAlloc::ObjGranularity - 1);
+    }
+
+    static void
+    refill()
+    {
+        size_t size = chunkSize();
+        uint8_t *slab =
+            static_cast<uint8_t*>(::operator new(batchSize * size));
+        for (size_t i = batchSize; i-- > 0; )
+        {
+            FreeChunk *chunk = reinterpret_cast<FreeChunk*>(slab + i * size);
+            chunk->next = freeList;
+            freeList = chunk;
+        }
+    }
+
+    static size_t batchSize;
+    static __thread FreeChunk *freeList;
+};
+
+template <class T>
+size_t ObjectPool<T>::batchSize = 64;
+
+template <class T>
+__thread typename ObjectPool<T>::FreeChunk *ObjectPool<T>::freeList;
+
+#endif // __BASE_POOL_ALLOC_HH__
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __BASE_SPSC_RING_HH__
+#define __BASE_SPSC_RING_HH__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A lock-free ring buffer for records of different sizes with a single
+ * producer and a single consumer. The producer allocates a contiguous
+ * record in the ring, constructs its contents in place and publishes it
+ * with push(). The consumer looks at the oldest record with front() and
+ * releases it with pop(). The records are aligned to ALIGN bytes.
+ *
+ * If a record does not fit into the space at the end of the ring, the
+ * remaining space is skipped and the record is placed at the beginning.
+ */
+class SpscRing
+{
+  public:
+    static const size_t ALIGN = 16;
+
+    /**
+     * @param size the size of the ring in bytes (a power of two)
+     */
+    explicit SpscRing(size_t size)
+        : buffer(size / sizeof(Slot)), mask(size - 1), head(0), tail(0),
+          pending(0), cachedTail(0)
+    {
+        assert((size & (size - 1)) == 0 && size >= 2 * sizeof(Slot));
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * @return the largest record that can be allocated
+     */
+    size_t maxSize() const
+    {
+        return capacity() / 2 - sizeof(Slot);
+    }
+
+    /**
+     * Allocates a record with the given size. May only be called by the
+     * producer and the record has to be published with push() before
+     * allocating the next one.
+     *
+     * @param size the size of the record in bytes (at most maxSize())
+     * @return the record or nullptr if the ring is currently too full
+     */
+    void *alloc(size_t size)
+    {
+        assert(size <= maxSize());
+
+        size_t total = sizeof(Slot) + roundUp(size);
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t pos = h & mask;
+        // skip the end of the ring if the record does not fit there
+        size_t skip = capacity() - pos < total ? capacity() - pos : 0;
+
+        if (!hasSpace(h, skip + total))
+            return nullptr;
+
+        if (skip) {
+            slot(pos)->size = SKIP;
+            pos = 0;
+        }
+        slot(pos)->size = size;
+        pending = skip + total;
+        return slot(pos) + 1;
+    }
+
+    /**
+     * Publishes the record that has been allocated last.
+     */
+    void push()
+    {
+        assert(pending);
+        head.store(head.load(std::memory_order_relaxed) + pending,
+                   std::memory_order_release);
+        pending = 0;
+    }
+
+    /**
+     * @return the oldest record or nullptr if there is none. May only be
+     *         called by the consumer.
+     */
+    void *front()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+
+        Slot *s = slot(t & mask);
+        if (s->size == SKIP) {
+            t += capacity() - (t & mask);
+            tail.store(t, std::memory_order_release);
+            if (t == head.load(std::memory_order_acquire))
+                return nullptr;
+            s = slot(t & mask);
+        }
+        return s + 1;
+    }
+
+    /**
+     * Releases the oldest record, which has been returned by front().
+     */
+    void pop()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        Slot *s = slot(t & mask);
+        assert(s->size != SKIP);
+        tail.store(t + sizeof(Slot) + roundUp(s->size),
+                   std::memory_order_release);
+    }
+
+    /**
+     * @return true if the ring contains no records. May be called by any
+     *         thread.
+     */
+    bool empty() const
+    {
+        return tail.load(std::memory_order_acquire) ==
+               head.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct alignas(ALIGN) Slot
+    {
+        size_t size;
+    };
+
+    static const size_t SKIP = SIZE_MAX;
+
+    static size_t roundUp(size_t size)
+    {
+        return (size + sizeof(Slot) - 1) & ~(sizeof(Slot) - 1);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    Slot *slot(size_t pos)
+    {
+        return &buffer[pos / sizeof(Slot)];
+    }
+
+    bool hasSpace(size_t h, size_t size)
+    {
+        // only look at the tail of the consumer if necessary
+        if (h + size - cachedTail <= capacity())
+            return true;
+        cachedTail = tail.load(std::memory_order_acquire);
+        return h + size - cachedTail <= capacity();
+    }
+
+    std::vector<Slot> buffer;
+    const size_t mask;
+
+    // written by the producer only
+    std::atomic<size_t> head;
+    // written by the consumer only
+    std::atomic<size_t> tail;
+
+    // producer-local state
+    size_t pending;
+    size_t cachedTail;
+};
+
+#endif // __BASE_SPSC_RING_HH__
@@ -34,11 +34,15 @@
  */
 
 #include <cctype>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
+#include "base/callback.hh"
 #include "base/misc.hh"
 #include "base/output.hh"
 #include "base/str.hh"
@@ -142,7 +146,226 @@ OstreamLogger::logMessage(Tick when, const std::string &name,
         stream << name << ": ";
 
     stream << message;
-    stream.flush();
+    if (autoFlush)
+        stream.flush();
+}
+
+/** Introduces a name to the background thread */
+struct AsyncLogger::NameRecord : public Record
+{
+    NameRecord(const std::string &_name)
+        : Record(&NameRecord::handler, 0, 0), name(_name)
+    { }
+
+    static void
+    handler(Record *rec, Buffer &buf, Logger *out)
+    {
+        NameRecord *r = static_cast<NameRecord*>(rec);
+        buf.names.push_back(std::move(r->name));
+        r->~NameRecord();
+    }
+
+    std::string name;
+};
+
+/** A message that has already been formatted */
+struct AsyncLogger::MessageRecord : public Record
+{
+    MessageRecord(Tick when, uint32_t name, const std::string &_message)
+        : Record(&MessageRecord::handler, when, name), message(_message)
+    { }
+
+    static void
+    handler(Record *rec, Buffer &buf, Logger *out)
+    {
+        MessageRecord *r = static_cast<MessageRecord*>(rec);
+        out->logMessage(r->when, buf.names[r->name], r->message);
+        r->~MessageRecord();
+    }
+
+    std::string message;
+};
+
+struct AsyncLogger::Worker
+{
+    Worker() : stopping(false) { }
+
+    std::thread thread;
+    std::atomic<bool> stopping;
+    /** Protects the list of buffers */
+    std::mutex lock;
+    std::vector<Buffer*> buffers;
+    /** Protects the wrapped logger */
+    std::mutex outLock;
+};
+
+__thread AsyncLogger *AsyncLogger::curLogger = nullptr;
+__thread AsyncLogger::Buffer *AsyncLogger::curBuffer = nullptr;
+
+AsyncLogger::AsyncLogger(Logger *_out, size_t buffer_size)
+    : out(_out), bufferSize(buffer_size), running(true), worker(new Worker)
+{
+    async = this;
+    out->setAutoFlush(false);
+    worker->thread = std::thread(&AsyncLogger::run, this);
+
+    // write the pending messages before the simulator exits
+    registerExitCallback(new MakeCallback<AsyncLogger, &AsyncLogger::stop>(
+        this));
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+
+    for (auto buf : worker->buffers)
+        delete buf;
+}
+
+AsyncLogger::Buffer *
+AsyncLogger::threadBuffer()
+{
+    if (!running.load(std::memory_order_relaxed))
+        return nullptr;
+
+    if (curLogger != this) {
+        curBuffer = new Buffer(bufferSize);
+        curLogger = this;
+
+        std::lock_guard<std::mutex> guard(worker->lock);
+        worker->buffers.push_back(curBuffer);
+    }
+    return curBuffer;
+}
+
+uint32_t
+AsyncLogger::nameId(Buffer &buf, const std::string &name)
+{
+    if (name.empty())
+        return 0;
+
+    auto it = buf.ids.find(name);
+    if (it != buf.ids.end())
+        return it->second;
+
+    uint32_t id = buf.ids.size() + 1;
+    buf.ids.emplace(name, id);
+
+    new (alloc(buf, sizeof(NameRecord))) NameRecord(name);
+    buf.ring.push();
+    return id;
+}
+
+void *
+AsyncLogger::alloc(Buffer &buf, size_t size)
+{
+    void *mem;
+    // wait for the background thread to catch up
+    while (!(mem = buf.ring.alloc(size)))
+        std::this_thread::yield();
+    return mem;
+}
+
+void
+AsyncLogger::logMessage(Tick when, const std::string &name,
+                        const std::string &message)
+{
+    Buffer *buf = threadBuffer();
+    if (!buf) {
+        out->logMessage(when, name, message);
+        return;
+    }
+
+    uint32_t id = nameId(*buf, name);
+    new (alloc(*buf, sizeof(MessageRecord))) MessageRecord(when, id,
+                                                           message);
+    buf->ring.push();
+}
+
+std::ostream &
+AsyncLogger::getOstream()
+{
+    // the caller writes to the stream directly
+    sync();
+    return out->getOstream();
+}
+
+void
+AsyncLogger::sync()
+{
+    if (!running || std::this_thread::get_id() == worker->thread.get_id())
+        return;
+
+    std::vector<Buffer*> buffers;
+    {
+        std::lock_guard<std::mutex> guard(worker->lock);
+        buffers = worker->buffers;
+    }
+
+    // the records are removed after they have been written
+    for (auto buf : buffers) {
+        while (!buf->ring.empty())
+            std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> guard(worker->outLock);
+    out->flush();
+}
+
+void
+AsyncLogger::stop()
+{
+    if (!running)
+        return;
+
+    sync();
+    running = false;
+
+    // the background thread writes what has been added in the meantime
+    worker->stopping = true;
+    worker->thread.join();
+    out->setAutoFlush(true);
+}
+
+void
+AsyncLogger::run()
+{
+    std::vector<Buffer*> buffers;
+    bool dirty = false;
+    while (true) {
+        bool stopping = worker->stopping;
+        {
+            std::lock_guard<std::mutex> guard(worker->lock);
+            buffers = worker->buffers;
+        }
+
+        // the messages of each thread stay in order, but the messages
+        // of different threads are interleaved by buffer
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> guard(worker->outLock);
+            for (auto buf : buffers) {
+                while (void *p = buf->ring.front()) {
+                    Record *rec = static_cast<Record*>(p);
+                    rec->handle(rec, *buf, out.get());
+                    buf->ring.pop();
+                    found = true;
+                }
+            }
+        }
+        dirty |= found;
+
+        if (!found) {
+            if (dirty) {
+                std::lock_guard<std::mutex> guard(worker->outLock);
+                out->flush();
+                dirty = false;
+            }
+            if (stopping)
+                break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
 }
 
 } // namespace Trace
@@ -36,16 +36,27 @@
 #ifndef __BASE_TRACE_HH__
 #define __BASE_TRACE_HH__
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "base/cprintf.hh"
 #include "base/debug.hh"
 #include "base/match.hh"
+#include "base/spsc_ring.hh"
 #include "base/types.hh"
 #include "sim/core.hh"
 
 namespace Trace {
 
+class AsyncLogger;
+
 /** Debug logging base class.  Handles formatting and outputting
  *  time/name/message messages */
 class Logger
@@ -54,19 +65,16 @@ class Logger
     /** Name match for objects to ignore */
     ObjectMatch ignore;
 
+    /** Set if this logger defers the formatting of messages */
+    AsyncLogger *async;
+
   public:
-    /** Log a single message */
-    template <typename ...Args>
-    void dprintf(Tick when, const std::string &name, const char *fmt,
-                 const Args &...args)
-    {
-        if (!name.empty() && ignore.match(name))
-            return;
+    Logger() : async(nullptr) { }
 
-        std::ostringstream line;
-        ccprintf(line, fmt, args...);
-        logMessage(when, name, line.str());
-    }
+    /** Log a single message */
+    template <typename Fmt, typename ...Args>
+    void dprintf(Tick when, const std::string &name, const Fmt &fmt,
+                 const Args &...args);
 
     /** Dump a block of data of length len */
     virtual void dump(Tick when, const std::string &name,
@@ -86,6 +94,15 @@ class Logger
     /** Set objects to ignore */
     void setIgnore(ObjectMatch &ignore_) { ignore = ignore_; }
 
+    /** Wait until all messages have been written */
+    virtual void sync() { }
+
+    /** Whether to flush the output after every message */
+    virtual void setAutoFlush(bool auto_flush) { }
+
+    /** Flush the output */
+    virtual void flush() { }
+
     virtual ~Logger() { }
 };
 
@@ -95,17 +112,284 @@ class OstreamLogger : public Logger
 {
   protected:
     std::ostream &stream;
+    bool autoFlush;
 
   public:
-    OstreamLogger(std::ostream &stream_) : stream(stream_)
+    OstreamLogger(std::ostream &stream_) : stream(stream_), autoFlush(true)
     { }
 
     void logMessage(Tick when, const std::string &name,
                     const std::string &message) M5_ATTR_OVERRIDE;
 
     std::ostream &getOstream() M5_ATTR_OVERRIDE { return stream; }
+
+    void setAutoFlush(bool auto_flush) M5_ATTR_OVERRIDE
+    { autoFlush = auto_flush; }
+
+    void flush() M5_ATTR_OVERRIDE { stream.flush(); }
 };
 
+/** Logger that moves the formatting and output of messages off the
+ *  simulation threads. Each thread puts its messages into its own
+ *  lock-free ring buffer and a background thread formats them and
+ *  passes them to the wrapped logger, so that the output does not
+ *  change. Messages with a string literal as format and arguments that
+ *  are plain values (numbers, enums, strings) are stored raw, i.e.,
+ *  the format pointer, the tick, an id for the name and a copy of the
+ *  arguments. Other messages are formatted right away, because their
+ *  arguments might change until the background thread gets to them.
+ *  The output is flushed whenever the background thread runs out of
+ *  work instead of after every message. */
+class AsyncLogger : public Logger
+{
+  public:
+    /** Takes ownership of the given logger that does the output. Each
+     *  thread gets a ring buffer with buffer_size bytes. */
+    AsyncLogger(Logger *out, size_t buffer_size = 1 << 20);
+
+    ~AsyncLogger();
+
+    /** Log a single message, formatting it later if possible */
+    template <typename Fmt, typename ...Args>
+    void
+    defer(Tick when, const std::string &name, const Fmt &fmt,
+          const Args &...args)
+    {
+        // the format has to stay around
+        const bool literal = std::is_array<Fmt>::value;
+        deferImpl(std::integral_constant<bool, literal &&
+                      AllCapturable<Args...>::value>(),
+                  when, name, fmt, args...);
+    }
+
+    void logMessage(Tick when, const std::string &name,
+                    const std::string &message) M5_ATTR_OVERRIDE;
+
+    std::ostream &getOstream() M5_ATTR_OVERRIDE;
+
+    void sync() M5_ATTR_OVERRIDE;
+
+    /** Write all pending messages and stop the background thread. The
+     *  following messages are written directly. */
+    void stop();
+
+  private:
+    /** How an argument is stored in the ring buffer, if possible.
+     *  Strings are copied, since they might be temporaries. */
+    template <typename T, typename Enable = void>
+    struct Capture
+    {
+        static const bool value = false;
+        typedef T type;
+    };
+
+    template <typename ...T>
+    struct AllCapturable;
+
+    /** Compile-time list of indices to expand a tuple */
+    template <size_t ...I>
+    struct Indices { };
+
+    template <size_t N, size_t ...I>
+    struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+
+    template <size_t ...I>
+    struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+    /** The buffer of a simulation thread */
+    struct Buffer
+    {
+        Buffer(size_t size) : ring(size) { names.push_back(""); }
+
+        SpscRing ring;
+        /** The ids of the names of this thread (used by the producer) */
+        std::unordered_map<std::string, uint32_t> ids;
+        /** The names by id (used by the background thread) */
+        std::vector<std::string> names;
+    };
+
+    /** The header of all records in the ring buffers */
+    struct Record
+    {
+        typedef void (*Handler)(Record *rec, Buffer &buf, Logger *out);
+
+        Record(Handler _handle, Tick _when, uint32_t _name)
+            : handle(_handle), when(_when), name(_name)
+        { }
+
+        Handler handle;
+        Tick when;
+        uint32_t name;
+    };
+
+    /** A message that still needs to be formatted */
+    template <typename ...T>
+    struct FormatRecord : public Record
+    {
+        template <typename ...Args>
+        FormatRecord(Tick when, uint32_t name, const char *_fmt,
+                     const Args &...args)
+            : Record(&FormatRecord::handler, when, name), fmt(_fmt),
+              args(args...)
+        { }
+
+        template <size_t ...I>
+        void
+        format(std::ostream &os, Indices<I...>)
+        {
+            ccprintf(os, fmt, std::get<I>(args)...);
+        }
+
+        static void
+        handler(Record *rec, Buffer &buf, Logger *out)
+        {
+            FormatRecord *r = static_cast<FormatRecord*>(rec);
+            std::ostringstream line;
+            r->format(line, typename MakeIndices<sizeof...(T)>::type());
+            out->logMessage(r->when, buf.names[r->name], line.str());
+            r->~FormatRecord();
+        }
+
+        const char *fmt;
+        std::tuple<T...> args;
+    };
+
+    template <typename ...Args>
+    void
+    deferImpl(std::true_type, Tick when, const std::string &name,
+              const char *fmt, const Args &...args)
+    {
+        typedef FormatRecord<typename Capture<Args>::type...> Rec;
+        Buffer *buf = threadBuffer();
+        if (!buf) {
+            deferImpl(std::false_type(), when, name, fmt, args...);
+            return;
+        }
+
+        uint32_t id = nameId(*buf, name);
+        new (alloc(*buf, sizeof(Rec))) Rec(when, id, fmt, args...);
+        buf->ring.push();
+    }
+
+    template <typename Fmt, typename ...Args>
+    void
+    deferImpl(std::false_type, Tick when, const std::string &name,
+              const Fmt &fmt, const Args &...args)
+    {
+        std::ostringstream line;
+        ccprintf(line, fmt, args...);
+        logMessage(when, name, line.str());
+    }
+
+    struct NameRecord;
+    struct MessageRecord;
+
+    /** The buffer of the current thread or null if we are stopped */
+    Buffer *threadBuffer();
+
+    /** The id of the given name in the given buffer */
+    uint32_t nameId(Buffer &buf, const std::string &name);
+
+    /** Allocate a record, waiting for space if necessary */
+    void *alloc(Buffer &buf, size_t size);
+
+    /** The loop of the background thread */
+    void run();
+
+    struct Worker;
+
+    /** The logger and buffer the current thread used last */
+    static __thread AsyncLogger *curLogger;
+    static __thread Buffer *curBuffer;
+
+    /** The wrapped logger */
+    std::unique_ptr<Logger> out;
+    const size_t bufferSize;
+    std::atomic<bool> running;
+    std::unique_ptr<Worker> worker;
+};
+
+template <typename T>
+struct AsyncLogger::Capture<T, typename std::enable_if<
+    std::is_arithmetic<T>::value || std::is_enum<T>::value>::type>
+{
+    static const bool value = true;
+    typedef T type;
+};
+
+template <>
+struct AsyncLogger::Capture<std::string>
+{
+    static const bool value = true;
+    typedef std::string type;
+};
+
+template <size_t N>
+struct AsyncLogger::Capture<char[N]>
+{
+    static const bool value = true;
+    typedef std::string type;
+};
+
+template <>
+struct AsyncLogger::Capture<char *>
+{
+    static const bool value = true;
+    typedef std::string type;
+};
+
+template <>
+struct AsyncLogger::Capture<const char *>
+{
+    static const bool value = true;
+    typedef std::string type;
+};
+
+template <>
+struct AsyncLogger::Capture<void *>
+{
+    static const bool value = true;
+    typedef void *type;
+};
+
+template <>
+struct AsyncLogger::Capture<const void *>
+{
+    static const bool value = true;
+    typedef const void *type;
+};
+
+template <>
+struct AsyncLogger::AllCapturable<>
+{
+    static const bool value = true;
+};
+
+template <typename T, typename ...Rest>
+struct AsyncLogger::AllCapturable<T, Rest...>
+{
+    static const bool value = Capture<T>::value &&
+                              AllCapturable<Rest...>::value;
+};
+
+template <typename Fmt, typename ...Args>
+void
+Logger::dprintf(Tick when, const std::string &name, const Fmt &fmt,
+                const Args &...args)
+{
+    if (!name.empty() && ignore.match(name))
+        return;
+
+    if (async) {
+        async->defer(when, name, fmt, args...);
+        return;
+    }
+
+    std::ostringstream line;
+    ccprintf(line, fmt, args...);
+    logMessage(when, name, line.str());
+}
+
 /** Get the current global debug logger.  This takes ownership of the given
  *  logger which should be allocated using 'new' */
 Logger *getDebugLogger();
@@ -581,6 +581,9 @@ BaseCPU::takeOverFrom(BaseCPU *oldCPU)
     interrupts->setCPU(this);
     oldCPU->interrupts = NULL;
 
+    // the DTU only updates the suspend pin on changes
+    _denySuspend = oldCPU->_denySuspend;
+
     if (FullSystem) {
         for (ThreadID i = 0; i < size; ++i)
             threadContexts[i]->profileClear();
@@ -346,6 +346,22 @@ class BaseCPU : public MemObject
      */
     void flushTLBs();
 
+    /**
+     * Invalidate pre-decoded instructions that have been fetched from
+     * the given physical address range.
+     *
+     * CPU models that keep decoded instructions beyond a single fetch
+     * need to be told about writes to memory that do not pass their own
+     * data port, for example by a DMA engine or a DTU.
+     */
+    virtual void invalidatePredecoded(Addr paddr, Addr size) {}
+
+    /**
+     * Drop all pre-decoded instructions, e.g., because the mapping of
+     * the physical address space has changed.
+     */
+    virtual void flushPredecoded() {}
+
     /**
      * Determine if the CPU is switched out.
      *
@@ -213,6 +213,13 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
         checker = NULL;
     }
 
+    // the number of instructions in flight is bounded by the ROB, the IQ and
+    // the fetch queue. let the pool allocate that many instructions at once
+    typedef typename Impl::DynInst DynInst;
+    ObjectPool<DynInst>::reserve(params->numROBEntries +
+                                 params->numIQEntries +
+                                 params->fetchQueueSize);
+
     if (!FullSystem) {
         thread.resize(numThreads);
         tids.resize(numThreads);
@@ -106,7 +106,8 @@ class FullO3CPU : public BaseO3CPU
     typedef O3ThreadState<Impl> ImplState;
     typedef O3ThreadState<Impl> Thread;
 
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename Impl::DynInstList DynInstList;
+    typedef typename DynInstList::iterator ListIt;
 
     friend class O3ThreadContext<Impl>;
 
@@ -513,7 +514,7 @@ class FullO3CPU : public BaseO3CPU
 #endif
 
     /** List of all the instructions in flight. */
-    std::list<DynInstPtr> instList;
+    DynInstList instList;
 
     /** List of all the instructions that will be removed at the end of this
      *  cycle.
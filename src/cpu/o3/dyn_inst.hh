@@ -47,6 +47,7 @@
 #include <array>
 
 #include "arch/isa_traits.hh"
+#include "base/pool_alloc.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/isa_specific.hh"
@@ -95,6 +96,23 @@ class BaseO3DynInst : public BaseDynInst<Impl>
 
     ~BaseO3DynInst();
 
+    /**
+     * Instructions are allocated from a pool, which the CPU sizes according
+     * to the number of instructions that can be in flight.
+     */
+    static void *
+    operator new(size_t sz)
+    {
+        assert(sz == sizeof(BaseO3DynInst));
+        return ObjectPool<BaseO3DynInst>::allocate();
+    }
+
+    static void
+    operator delete(void *p)
+    {
+        ObjectPool<BaseO3DynInst>::deallocate(p);
+    }
+
     /** Executes the instruction.*/
     Fault execute();
 
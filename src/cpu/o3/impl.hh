@@ -31,7 +31,10 @@
 #ifndef __CPU_O3_IMPL_HH__
 #define __CPU_O3_IMPL_HH__
 
+#include <list>
+
 #include "arch/isa_traits.hh"
+#include "base/pool_alloc.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu_policy.hh"
 
@@ -66,6 +69,11 @@ struct O3CPUImpl
      */
     typedef RefCountingPtr<DynInst> DynInstPtr;
 
+    /** The list type for in-flight instructions. Its nodes are pooled to
+     *  avoid a heap allocation for every instruction in every list.
+     */
+    typedef std::list<DynInstPtr, PoolAllocator<DynInstPtr> > DynInstList;
+
     /** The O3CPU type to be used. */
     typedef FullO3CPU<O3CPUImpl> O3CPU;
 
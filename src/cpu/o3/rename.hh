@@ -46,6 +46,7 @@
 
 #include <list>
 
+#include "base/pool_alloc.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
 #include "cpu/timebuf.hh"
@@ -306,7 +307,10 @@ class DefaultRename
     /** A per-thread list of all destination register renames, used to either
      * undo rename mappings or free old physical registers.
      */
-    std::list<RenameHistory> historyBuffer[Impl::MaxThreads];
+    typedef std::list<RenameHistory, PoolAllocator<RenameHistory> >
+        HistoryBuffer;
+
+    HistoryBuffer historyBuffer[Impl::MaxThreads];
 
     /** Pointer to CPU. */
     O3CPU *cpu;
@@ -896,7 +896,7 @@ template <class Impl>
 void
 DefaultRename<Impl>::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
 {
-    typename std::list<RenameHistory>::iterator hb_it =
+    typename HistoryBuffer::iterator hb_it =
         historyBuffer[tid].begin();
 
     // After a syscall squashes everything, the history buffer may be empty
@@ -943,7 +943,7 @@ DefaultRename<Impl>::removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid)
             "history buffer %u (size=%i), until [sn:%lli].\n",
             tid, tid, historyBuffer[tid].size(), inst_seq_num);
 
-    typename std::list<RenameHistory>::iterator hb_it =
+    typename HistoryBuffer::iterator hb_it =
         historyBuffer[tid].end();
 
     --hb_it;
@@ -1406,7 +1406,7 @@ template <class Impl>
 void
 DefaultRename<Impl>::dumpHistory()
 {
-    typename std::list<RenameHistory>::iterator buf_it;
+    typename HistoryBuffer::iterator buf_it;
 
     for (ThreadID tid = 0; tid < numThreads; tid++) {
 
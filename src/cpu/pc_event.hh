@@ -100,6 +100,7 @@ class PCEventQueue
 
     bool remove(PCEvent *event);
     bool schedule(PCEvent *event);
+    bool empty() const { return pc_map.empty(); }
     bool service(ThreadContext *tc)
     {
         if (pc_map.empty())
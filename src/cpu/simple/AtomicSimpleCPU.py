@@ -62,6 +62,11 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
     fastmem = Param.Bool(False, "Access memory directly")
+    bb_cache = Param.Bool(False, "Execute pre-decoded basic blocks")
+    bb_cache_blocks = Param.Unsigned(8192,
+        "Maximum number of cached basic blocks")
+    bb_max_insts = Param.Unsigned(32,
+        "Maximum number of instructions per basic block")
 
     def addSimPointProbe(self, interval):
         simpoint = SimPoint()
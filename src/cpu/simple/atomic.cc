@@ -111,6 +111,10 @@ AtomicSimpleCPU::AtomicSimpleCPU(AtomicSimpleCPUParams *p)
       icachePort(name() + ".icache_port", this),
       dcachePort(name() + ".dcache_port", this),
       fastmem(p->fastmem), dcache_access(false), dcache_latency(0),
+      bbCache(p->bb_cache ? new BasicBlockCache(p->bb_cache_blocks,
+                                                p->bb_max_insts)
+                          : NULL),
+      curBlock(NULL), curBlockIdx(0), endOfBlock(false),
       ppCommit(nullptr)
 {
     _status = Idle;
@@ -122,6 +126,7 @@ AtomicSimpleCPU::~AtomicSimpleCPU()
     if (tickEvent.scheduled()) {
         deschedule(tickEvent);
     }
+    delete bbCache;
 }
 
 DrainState
@@ -132,6 +137,12 @@ AtomicSimpleCPU::drain()
 
     if (!isDrained()) {
         DPRINTF(Drain, "Requesting drain: %s\n", pcState());
+
+        // The tick event is descheduled if a previous drain attempt
+        // succeeded, but the DTU got messages for us afterwards.
+        if (_status == BaseSimpleCPU::Running && !tickEvent.scheduled())
+            schedule(tickEvent, clockEdge(Cycles(0)));
+
         return DrainState::Draining;
     } else {
         if (tickEvent.scheduled())
@@ -152,6 +163,9 @@ AtomicSimpleCPU::drainResume()
     DPRINTF(SimpleCPU, "Resume\n");
     verifyMemoryMode();
 
+    // the memory might have changed while we were drained
+    flushPredecoded();
+
     assert(!threadContexts.empty());
     if (threadContexts.size() > 1)
         fatal("The atomic CPU only supports one thread.\n");
@@ -205,6 +219,8 @@ AtomicSimpleCPU::takeOverFrom(BaseCPU *oldCPU)
     ifetch_req.setThreadContext(_cpuId, 0); // Add thread ID if we add MT
     data_read_req.setThreadContext(_cpuId, 0); // Add thread ID here too
     data_write_req.setThreadContext(_cpuId, 0); // Add thread ID here too
+
+    flushPredecoded();
 }
 
 void
@@ -216,6 +232,23 @@ AtomicSimpleCPU::verifyMemoryMode() const
     }
 }
 
+void
+AtomicSimpleCPU::invalidatePredecoded(Addr paddr, Addr size)
+{
+    if (bbCache && bbCache->invalidate(paddr, size))
+        leaveBlock();
+}
+
+void
+AtomicSimpleCPU::flushPredecoded()
+{
+    if (bbCache) {
+        bbCache->flush();
+        leaveBlock();
+        endOfBlock = false;
+    }
+}
+
 void
 AtomicSimpleCPU::activateContext(ThreadID thread_num)
 {
@@ -454,6 +487,10 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size,
                         system->getPhysMem().access(&pkt);
                     else
                         dcache_latency += dcachePort.sendAtomic(&pkt);
+
+                    // we might have written to code
+                    if (bbCache)
+                        invalidatePredecoded(req->getPaddr(), size);
                 }
                 dcache_access = true;
                 assert(!pkt.isError());
@@ -504,18 +541,27 @@ AtomicSimpleCPU::tick()
     DPRINTF(SimpleCPU, "Tick\n");
 
     Tick latency = 0;
+    // cycles of pre-decoded instructions beyond the CPU width
+    int extraCycles = 0;
+
+    // a pre-decoded block is always executed till the end
+    for (int i = 0; i < width || locked || curBlock; ++i) {
+        if (i >= width && !locked && i % width == 0)
+            extraCycles++;
 
-    for (int i = 0; i < width || locked; ++i) {
         numCycles++;
         ppCycles->notify(1);
 
-        if (!curStaticInst || !curStaticInst->isDelayedCommit()) {
+        // within a pre-decoded block, there are no interrupts or PC events
+        if (!curBlock &&
+            (!curStaticInst || !curStaticInst->isDelayedCommit())) {
             checkForInterrupts();
             checkPcEventQueue();
         }
 
         // We must have just got suspended by a PC event
         if (_status == Idle) {
+            leaveBlock();
             tryCompleteDrain();
             return;
         }
@@ -526,6 +572,16 @@ AtomicSimpleCPU::tick()
 
         bool needToFetch = !isRomMicroPC(pcState.microPC()) &&
                            !curMacroStaticInst;
+        if (needToFetch && curBlock) {
+            // take the next instruction from the pre-decoded block
+            const BasicBlockCache::Inst &binst = curBlock->insts[curBlockIdx];
+            assert(binst.pc.instAddr() == pcState.instAddr());
+            thread->pcState(binst.pc);
+            predecodedInst = binst.inst;
+            curBlockIdx++;
+            predecodedInsts++;
+            needToFetch = false;
+        }
         if (needToFetch) {
             ifetch_req.taskId(taskId());
             setupFetchRequest(&ifetch_req);
@@ -564,6 +620,9 @@ AtomicSimpleCPU::tick()
 
             preExecute();
 
+            if (bbCache && needToFetch && curStaticInst)
+                recordBlockInst();
+
             if (curStaticInst) {
                 fault = curStaticInst->execute(this, traceData);
 
@@ -603,6 +662,9 @@ AtomicSimpleCPU::tick()
         }
         if(fault != NoFault || !stayAtPC)
             advancePC(fault);
+
+        if (bbCache)
+            updateBlock(fault);
     }
 
     if (tryCompleteDrain())
@@ -611,11 +673,123 @@ AtomicSimpleCPU::tick()
     // instruction takes at least one cycle
     if (latency < clockPeriod())
         latency = clockPeriod();
+    latency += extraCycles * clockPeriod();
 
     if (_status != Idle)
         schedule(tickEvent, curTick() + latency);
 }
 
+static bool
+endsBasicBlock(const StaticInstPtr &inst)
+{
+    return inst->isControl() || inst->isSerializing() ||
+           inst->isNonSpeculative() || inst->isSyscall() ||
+           inst->isQuiesce() || inst->isIprAccess() ||
+           inst->isUnverifiable();
+}
+
+void
+AtomicSimpleCPU::recordBlockInst()
+{
+    const TheISA::PCState &pc = thread->pcState();
+    StaticInstPtr inst = curMacroStaticInst ? curMacroStaticInst
+                                            : curStaticInst;
+
+    // the fetch request has the physical address of the last chunk
+    const Addr pageMask = TheISA::PageBytes - 1;
+    Addr paddr = (ifetch_req.getPaddr() & ~pageMask) |
+                 (pc.instAddr() & pageMask);
+
+    // instructions that cross a page are executed the normal way
+    if ((pc.instAddr() & ~pageMask) != ((pc.nextInstAddr() - 1) & ~pageMask)) {
+        bbCache->finishBlock();
+        return;
+    }
+
+    if (bbCache->continuesBlock(pc.instAddr(), paddr)) {
+        bbCache->append(pc, inst);
+        return;
+    }
+
+    bbCache->finishBlock();
+
+    // if the first instruction was decoded to the same object, the block
+    // has been decoded in the same mode
+    BasicBlockCache::Block *blk = bbCache->lookup(pc.instAddr(), paddr);
+    if (blk && blk->insts[0].pc == pc && blk->insts[0].inst == inst) {
+        // PC events need to be checked before every instruction
+        if (system->pcEventQueue.empty()) {
+            DPRINTF(SimpleCPU, "Executing pre-decoded block @ %#x (%u)\n",
+                    pc.instAddr(), blk->insts.size());
+            curBlock = blk;
+            curBlockIdx = 1;
+            bbCacheHits++;
+        }
+        return;
+    }
+
+    bbCache->startBlock(pc.instAddr(), paddr);
+    bbCache->append(pc, inst);
+}
+
+void
+AtomicSimpleCPU::updateBlock(const Fault &fault)
+{
+    TheISA::PCState pc = thread->pcState();
+
+    if (fault != NoFault) {
+        leaveBlock();
+        endOfBlock = true;
+    }
+    else if (isRomMicroPC(pc.microPC()) ||
+             (curStaticInst && endsBasicBlock(curStaticInst))) {
+        endOfBlock = true;
+    }
+
+    // wait until the macro-op is complete
+    if (curMacroStaticInst || isRomMicroPC(pc.microPC()) || stayAtPC)
+        return;
+
+    if (endOfBlock) {
+        bbCache->finishBlock();
+        leaveBlock();
+        endOfBlock = false;
+    }
+    else if (curBlock) {
+        // stop if we left the block, e.g., because of a not-taken branch
+        // that is taken this time
+        if (curBlockIdx == curBlock->insts.size() ||
+            curBlock->insts[curBlockIdx].pc.instAddr() != pc.instAddr())
+            leaveBlock();
+    }
+}
+
+void
+AtomicSimpleCPU::leaveBlock()
+{
+    if (curBlock) {
+        curBlock = NULL;
+        // the decoder has not seen the instructions of the block
+        thread->decoder.reset();
+    }
+}
+
+void
+AtomicSimpleCPU::regStats()
+{
+    BaseSimpleCPU::regStats();
+
+    bbCacheHits
+        .name(name() + ".bbCacheHits")
+        .desc("Number of executed pre-decoded basic blocks")
+        .prereq(bbCacheHits);
+
+    predecodedInsts
+        .name(name() + ".predecodedInsts")
+        .desc("Number of instructions taken from pre-decoded basic blocks")
+        .prereq(predecodedInsts);
+}
+
 void
 AtomicSimpleCPU::regProbePoints()
 {
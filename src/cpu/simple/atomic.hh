@@ -44,6 +44,7 @@
 #define __CPU_SIMPLE_ATOMIC_HH__
 
 #include "cpu/simple/base.hh"
+#include "cpu/simple/bb_cache.hh"
 #include "params/AtomicSimpleCPU.hh"
 #include "sim/probe/probe.hh"
 
@@ -93,12 +94,16 @@ class AtomicSimpleCPU : public BaseSimpleCPU
      *     CPU state while it is in an LLSC region.
      *
      * <li>Stay at PC is true.
+     *
+     * <li>The DTU has unread messages for the CPU. These might be
+     *     pagefaults that other DTUs wait for to finish their drain.
      * </ul>
      */
     bool isDrained() {
         return microPC() == 0 &&
             !locked &&
-            !stayAtPC;
+            !stayAtPC &&
+            !_denySuspend;
     }
 
     /**
@@ -172,6 +177,35 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     bool dcache_access;
     Tick dcache_latency;
 
+    /** Pre-decoded basic blocks (NULL if disabled) */
+    BasicBlockCache *bbCache;
+    /** The pre-decoded block we are executing (NULL if none) */
+    BasicBlockCache::Block *curBlock;
+    /** The index of the next instruction in curBlock */
+    size_t curBlockIdx;
+    /** Whether the current macro-op ends the block that is recorded */
+    bool endOfBlock;
+
+    /**
+     * Adds the just decoded instruction to the block that is recorded or
+     * starts executing a cached block, if there is one at this PC.
+     */
+    void recordBlockInst();
+
+    /**
+     * Ends the recorded or executed block after an instruction, if
+     * necessary.
+     */
+    void updateBlock(const Fault &fault);
+
+    /**
+     * Stops executing from the current pre-decoded block.
+     */
+    void leaveBlock();
+
+    Stats::Scalar bbCacheHits;
+    Stats::Scalar predecodedInsts;
+
     /** Probe Points. */
     ProbePointArg<std::pair<SimpleThread*, const StaticInstPtr>> *ppCommit;
 
@@ -193,6 +227,11 @@ class AtomicSimpleCPU : public BaseSimpleCPU
 
     void verifyMemoryMode() const;
 
+    void invalidatePredecoded(Addr paddr, Addr size) M5_ATTR_OVERRIDE;
+    void flushPredecoded() M5_ATTR_OVERRIDE;
+
+    void regStats() M5_ATTR_OVERRIDE;
+
     virtual void activateContext(ThreadID thread_num);
     virtual void suspendContext(ThreadID thread_num);
 
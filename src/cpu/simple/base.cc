@@ -396,6 +396,18 @@ BaseSimpleCPU::preExecute()
         stayAtPC = false;
         curStaticInst = microcodeRom.fetchMicroop(pcState.microPC(),
                                                   curMacroStaticInst);
+    } else if (!curMacroStaticInst && predecodedInst) {
+        //The instruction has been decoded before; the PC state has already
+        //been updated
+        stayAtPC = false;
+        if (predecodedInst->isMacroop()) {
+            curMacroStaticInst = predecodedInst;
+            curStaticInst =
+                curMacroStaticInst->fetchMicroop(pcState.microPC());
+        } else {
+            curStaticInst = predecodedInst;
+        }
+        predecodedInst = NULL;
     } else if (!curMacroStaticInst) {
         //We're not in the middle of a macro instruction
         StaticInstPtr instPtr = NULL;
@@ -158,6 +158,10 @@ class BaseSimpleCPU : public BaseCPU, public ExecContext
     StaticInstPtr curStaticInst;
     StaticInstPtr curMacroStaticInst;
 
+    // already decoded instruction that should be executed next instead of
+    // decoding the fetched bytes (used for pre-decoded basic blocks)
+    StaticInstPtr predecodedInst;
+
     //This is the offset from the current pc that fetch should be performed at
     Addr fetchOffset;
     //This flag says to stay at the current pc. This is useful for
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include "arch/isa_traits.hh"
+#include "cpu/simple/bb_cache.hh"
+
+static inline Addr
+pageOf(Addr addr)
+{
+    return addr & ~(TheISA::PageBytes - 1);
+}
+
+BasicBlockCache::BasicBlockCache(size_t _maxBlocks, size_t _maxBlockSize)
+    : blocks(),
+      pages(),
+      building(),
+      buildingPc(invalidAddr),
+      maxBlocks(_maxBlocks),
+      maxBlockSize(_maxBlockSize)
+{
+    building.paddr = invalidAddr;
+}
+
+BasicBlockCache::~BasicBlockCache()
+{
+    flush();
+}
+
+BasicBlockCache::Block *
+BasicBlockCache::lookup(Addr pc, Addr paddr)
+{
+    BlockMap::iterator it = blocks.find(pc);
+    if (it == blocks.end())
+        return NULL;
+
+    // the translation has changed; the block is stale
+    if (it->second->paddr != paddr)
+    {
+        remove(pc);
+        return NULL;
+    }
+
+    return it->second;
+}
+
+void
+BasicBlockCache::startBlock(Addr pc, Addr paddr)
+{
+    assert(!recording());
+
+    building.paddr = paddr;
+    building.insts.clear();
+    buildingPc = pc;
+}
+
+bool
+BasicBlockCache::continuesBlock(Addr pc, Addr paddr) const
+{
+    if (!recording() || building.insts.empty())
+        return false;
+
+    return building.insts.back().pc.nextInstAddr() == pc &&
+           pageOf(pc) == pageOf(buildingPc) &&
+           pageOf(paddr) == pageOf(building.paddr);
+}
+
+void
+BasicBlockCache::append(const TheISA::PCState &pc, const StaticInstPtr &inst)
+{
+    assert(recording());
+
+    Inst i;
+    i.pc = pc;
+    i.inst = inst;
+    building.insts.push_back(i);
+
+    if (building.insts.size() == maxBlockSize)
+        finishBlock();
+}
+
+void
+BasicBlockCache::finishBlock()
+{
+    if (!recording())
+        return;
+
+    // single instructions are not worth it
+    if (building.insts.size() > 1)
+    {
+        // simply start over if the cache is full
+        if (blocks.size() >= maxBlocks)
+            flush();
+
+        // if we replace a block from the same page, it is already listed
+        BlockMap::iterator it = blocks.find(buildingPc);
+        bool listed = it != blocks.end() &&
+                      pageOf(it->second->paddr) == pageOf(building.paddr);
+        remove(buildingPc);
+
+        Block *blk = new Block(building);
+        blocks[buildingPc] = blk;
+        if (!listed)
+            pages[pageOf(blk->paddr)].push_back(buildingPc);
+    }
+
+    building.paddr = invalidAddr;
+    building.insts.clear();
+    buildingPc = invalidAddr;
+}
+
+bool
+BasicBlockCache::invalidate(Addr paddr, Addr size)
+{
+    bool removed = false;
+
+    if (size == 0)
+        return false;
+
+    // stop recording, if the block is affected
+    if (recording() &&
+        pageOf(building.paddr) >= pageOf(paddr) &&
+        pageOf(building.paddr) <= pageOf(paddr + size - 1))
+    {
+        building.paddr = invalidAddr;
+        building.insts.clear();
+        buildingPc = invalidAddr;
+    }
+
+    if (pages.empty())
+        return false;
+
+    for (Addr page = pageOf(paddr);
+         page <= pageOf(paddr + size - 1);
+         page += TheISA::PageBytes)
+    {
+        PageMap::iterator it = pages.find(page);
+        if (it == pages.end())
+            continue;
+
+        for (Addr pc : it->second)
+        {
+            // the block might have been replaced by one in a different page
+            BlockMap::iterator bit = blocks.find(pc);
+            if (bit != blocks.end() && pageOf(bit->second->paddr) == page)
+            {
+                delete bit->second;
+                blocks.erase(bit);
+                removed = true;
+            }
+        }
+        pages.erase(it);
+
+        // prevent an overflow at the end of the address space
+        if (page + TheISA::PageBytes < page)
+            break;
+    }
+
+    return removed;
+}
+
+void
+BasicBlockCache::flush()
+{
+    for (BlockMap::iterator it = blocks.begin(); it != blocks.end(); ++it)
+        delete it->second;
+    blocks.clear();
+    pages.clear();
+
+    building.paddr = invalidAddr;
+    building.insts.clear();
+    buildingPc = invalidAddr;
+}
+
+void
+BasicBlockCache::remove(Addr pc)
+{
+    // the entry in the page map is removed lazily
+    BlockMap::iterator it = blocks.find(pc);
+    if (it != blocks.end())
+    {
+        delete it->second;
+        blocks.erase(it);
+    }
+}
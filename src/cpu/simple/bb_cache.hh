@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __CPU_SIMPLE_BB_CACHE_HH__
+#define __CPU_SIMPLE_BB_CACHE_HH__
+
+#include <vector>
+
+#include "arch/types.hh"
+#include "base/hashmap.hh"
+#include "base/types.hh"
+#include "cpu/static_inst.hh"
+
+/**
+ * A cache of pre-decoded basic blocks. A block is a sequence of macro-ops
+ * that have been decoded back to back, together with the PC state after
+ * decoding, so that the CPU can execute them without fetching and decoding
+ * them again. Blocks end at control and serializing instructions and never
+ * cross a page boundary. They are identified by the virtual PC of their
+ * first instruction and remember the physical address they have been
+ * fetched from, so that changed translations and writes to code pages can
+ * be detected.
+ */
+class BasicBlockCache
+{
+  public:
+
+    struct Inst
+    {
+        /** The PC state after decoding the instruction */
+        TheISA::PCState pc;
+        /** The decoded instruction (macro-op, if it is microcoded) */
+        StaticInstPtr inst;
+    };
+
+    struct Block
+    {
+        /** The physical address of the first instruction */
+        Addr paddr;
+        std::vector<Inst> insts;
+    };
+
+    BasicBlockCache(size_t _maxBlocks, size_t _maxBlockSize);
+
+    ~BasicBlockCache();
+
+    /**
+     * Looks up the block starting at virtual address <pc> that has been
+     * fetched from physical address <paddr>.
+     */
+    Block *lookup(Addr pc, Addr paddr);
+
+    /**
+     * Starts recording a new block at the given addresses.
+     */
+    void startBlock(Addr pc, Addr paddr);
+
+    /**
+     * Appends the given instruction to the block that is being recorded.
+     * The block is finished automatically if it reached its maximum size.
+     */
+    void append(const TheISA::PCState &pc, const StaticInstPtr &inst);
+
+    /**
+     * Finishes the block that is being recorded (if any) and inserts it
+     * into the cache.
+     */
+    void finishBlock();
+
+    /**
+     * @return true if a block is being recorded
+     */
+    bool recording() const { return building.paddr != invalidAddr; }
+
+    /**
+     * @return true if the instruction at <pc>, fetched from <paddr>,
+     * continues the block that is being recorded
+     */
+    bool continuesBlock(Addr pc, Addr paddr) const;
+
+    /**
+     * Removes all blocks that have been fetched from the given physical
+     * address range.
+     *
+     * @return true if at least one block has been removed
+     */
+    bool invalidate(Addr paddr, Addr size);
+
+    /**
+     * Removes all blocks.
+     */
+    void flush();
+
+    size_t size() const { return blocks.size(); }
+
+  private:
+
+    static const Addr invalidAddr = static_cast<Addr>(-1);
+
+    void remove(Addr pc);
+
+    typedef m5::hash_map<Addr, Block*> BlockMap;
+    typedef m5::hash_map<Addr, std::vector<Addr>> PageMap;
+
+    /** All blocks, indexed by the virtual PC of their first instruction */
+    BlockMap blocks;
+
+    /** The PCs of the blocks in each physical page */
+    PageMap pages;
+
+    /** The block that is being recorded */
+    Block building;
+    Addr buildingPc;
+
+    const size_t maxBlocks;
+    const size_t maxBlockSize;
+};
+
+#endif // __CPU_SIMPLE_BB_CACHE_HH__
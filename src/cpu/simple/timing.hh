@@ -339,10 +339,14 @@ class TimingSimpleCPU : public BaseSimpleCPU
      * <li>A fetch event is scheduled. Normally this would never be the
      *     case with microPC() == 0, but right after a context is
      *     activated it can happen.
+     *
+     * <li>The DTU has unread messages for the CPU. These might be
+     *     pagefaults that other DTUs wait for to finish their drain.
      * </ul>
      */
     bool isDrained() {
-        return microPC() == 0 && !stayAtPC && !fetchEvent.scheduled();
+        return microPC() == 0 && !stayAtPC && !fetchEvent.scheduled() &&
+               !_denySuspend;
     }
 
     /**
@@ -0,0 +1,52 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+from MemObject import MemObject
+from m5.params import *
+from m5.proxy import *
+
+# Drives a CopyEngine without an operating system. For each channel, it
+# builds a chain of descriptors in memory, starts the channel and polls the
+# completion status until the last descriptor is done. Afterwards, it checks
+# the copied data and stops the simulation.
+class CopyEngineDriver(MemObject):
+    type = 'CopyEngineDriver'
+    cxx_header = "cpu/testers/ce_driver/ce_driver.hh"
+    port = MasterPort("Port to the memory and the copy engine registers")
+    system = Param.System(Parent.any, "System this driver is part of")
+
+    engine_addr = Param.Addr("Address of the copy engine registers (BAR0)")
+    mem_addr = Param.Addr(0x100000,
+        "Start of the memory for the descriptors and the buffers")
+    channels = Param.Unsigned(1, "Number of channels to use")
+    descriptors = Param.Unsigned(64, "Number of descriptors per channel")
+    desc_size = Param.MemorySize('4kB', "Number of bytes per descriptor")
+    status_interval = Param.Unsigned(1,
+        "Request the completion status for every N-th descriptor (the last "
+        "one always requests it)")
+    poll_interval = Param.Latency('100ns',
+        "Time between two reads of the completion status")
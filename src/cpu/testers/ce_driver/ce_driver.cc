@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include "cpu/testers/ce_driver/ce_driver.hh"
+
+#include <cstring>
+#include <limits>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/trace.hh"
+#include "debug/CopyEngineDriver.hh"
+#include "dev/copy_engine_defs.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+#include "sim/sim_exit.hh"
+#include "sim/system.hh"
+
+using namespace CopyEngineReg;
+
+// the register block of channel i starts at (i + 1) * CHAN_REGS_SIZE
+static const Addr CHAN_REGS_SIZE = 0x80;
+
+CopyEngineDriver::CopyEngineDriver(const Params *p)
+    : MemObject(p),
+      pollEvent(this),
+      port(name() + ".port", *this),
+      masterId(p->system->getMasterId(name())),
+      engineAddr(p->engine_addr),
+      memAddr(p->mem_addr),
+      descriptors(p->descriptors),
+      descSize(p->desc_size),
+      statusInterval(p->status_interval),
+      pollInterval(p->poll_interval),
+      chans(p->channels),
+      startTick(0)
+{
+    fatal_if(descriptors == 0, "%s: needs at least one descriptor\n",
+             name());
+    fatal_if(statusInterval == 0, "%s: status_interval can't be 0\n",
+             name());
+    fatal_if(descSize > std::numeric_limits<uint32_t>::max(),
+             "%s: descriptors can't copy more than 4 GiB\n", name());
+    // the completion status reports the descriptor address in units of 64
+    fatal_if(memAddr == 0 || (memAddr & (sizeof(DmaDesc) - 1)) != 0,
+             "%s: mem_addr has to be non-zero and %u byte aligned\n",
+             name(), sizeof(DmaDesc));
+
+    Addr addr = memAddr;
+    for (auto &c : chans) {
+        c.descAddr = addr;
+        c.statusAddr = c.descAddr + descriptors * sizeof(DmaDesc);
+        c.srcAddr = roundUp(c.statusAddr + sizeof(uint64_t),
+                            sizeof(DmaDesc));
+        c.dstAddr = c.srcAddr + descriptors * descSize;
+        c.done = false;
+        c.doneTick = 0;
+        addr = roundUp(c.dstAddr + descriptors * descSize, 0x1000);
+    }
+}
+
+void
+CopyEngineDriver::init()
+{
+    MemObject::init();
+
+    if (!port.isConnected())
+        fatal("%s: port is not connected\n", name());
+}
+
+void
+CopyEngineDriver::startup()
+{
+    MemObject::startup();
+
+    for (unsigned i = 0; i < chans.size(); i++)
+        setupChannel(i);
+
+    startTick = curTick();
+    schedule(pollEvent, curTick() + pollInterval);
+}
+
+BaseMasterPort &
+CopyEngineDriver::getMasterPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "port")
+        return port;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+void
+CopyEngineDriver::readMem(Addr addr, void *data, unsigned size)
+{
+    Request req(addr, size, 0, masterId);
+    Packet pkt(&req, MemCmd::ReadReq);
+    pkt.dataStatic(static_cast<uint8_t*>(data));
+    port.sendFunctional(&pkt);
+}
+
+void
+CopyEngineDriver::writeMem(Addr addr, const void *data, unsigned size)
+{
+    Request req(addr, size, 0, masterId);
+    Packet pkt(&req, MemCmd::WriteReq);
+    pkt.dataStatic(static_cast<const uint8_t*>(data));
+    port.sendFunctional(&pkt);
+}
+
+void
+CopyEngineDriver::writeReg(unsigned chan, Addr reg, uint64_t val,
+                           unsigned size)
+{
+    Addr addr = engineAddr + (chan + 1) * CHAN_REGS_SIZE + reg;
+    DPRINTF(CopyEngineDriver, "Writing %#x to register %#x of channel %u\n",
+            val, reg, chan);
+    writeMem(addr, &val, size);
+}
+
+uint8_t
+CopyEngineDriver::pattern(unsigned chan, unsigned desc, Addr off) const
+{
+    return (chan * 31 + desc * 7 + off) & 0xff;
+}
+
+void
+CopyEngineDriver::setupChannel(unsigned chan)
+{
+    Channel &c = chans[chan];
+
+    DPRINTF(CopyEngineDriver,
+            "Channel %u: %u descriptors @ %#x, src @ %#x, dst @ %#x\n",
+            chan, descriptors, c.descAddr, c.srcAddr, c.dstAddr);
+
+    std::vector<uint8_t> buf(descSize);
+    std::vector<uint8_t> zeros(descSize, 0);
+    for (unsigned i = 0; i < descriptors; i++) {
+        for (Addr off = 0; off < descSize; off++)
+            buf[off] = pattern(chan, i, off);
+        writeMem(c.srcAddr + i * descSize, buf.data(), descSize);
+        writeMem(c.dstAddr + i * descSize, zeros.data(), descSize);
+
+        bool last = i == descriptors - 1;
+        DmaDesc desc;
+        memset(&desc, 0, sizeof(desc));
+        desc.len = descSize;
+        if (last || (i + 1) % statusInterval == 0)
+            desc.command = DESC_CTRL_CP_STS;
+        desc.src = c.srcAddr + i * descSize;
+        desc.dest = c.dstAddr + i * descSize;
+        desc.next = last ? 0 : c.descAddr + (i + 1) * sizeof(DmaDesc);
+        writeMem(c.descAddr + i * sizeof(DmaDesc), &desc, sizeof(desc));
+    }
+
+    uint64_t status = 0;
+    writeMem(c.statusAddr, &status, sizeof(status));
+
+    writeReg(chan, CHAN_CMPLNADDR, c.statusAddr, sizeof(uint64_t));
+    writeReg(chan, CHAN_CHAINADDR, c.descAddr, sizeof(uint64_t));
+
+    ChanRegs::CHANCMD cmd;
+    cmd.start_dma(1);
+    writeReg(chan, CHAN_COMMAND, cmd(), sizeof(uint8_t));
+}
+
+void
+CopyEngineDriver::verifyChannel(unsigned chan)
+{
+    Channel &c = chans[chan];
+
+    std::vector<uint8_t> buf(descSize);
+    for (unsigned i = 0; i < descriptors; i++) {
+        readMem(c.dstAddr + i * descSize, buf.data(), descSize);
+        for (Addr off = 0; off < descSize; off++) {
+            if (buf[off] != pattern(chan, i, off)) {
+                panic("%s: channel %u, descriptor %u: read %#x @ %#x, "
+                      "expected %#x\n", name(), chan, i, buf[off],
+                      c.dstAddr + i * descSize + off,
+                      pattern(chan, i, off));
+            }
+        }
+    }
+}
+
+void
+CopyEngineDriver::poll()
+{
+    bool finished = true;
+    Addr lastDesc = (descriptors - 1) * sizeof(DmaDesc);
+
+    for (unsigned i = 0; i < chans.size(); i++) {
+        Channel &c = chans[i];
+        if (c.done)
+            continue;
+
+        uint64_t status;
+        readMem(c.statusAddr, &status, sizeof(status));
+        if ((status & ~mask(6)) == c.descAddr + lastDesc) {
+            DPRINTF(CopyEngineDriver, "Channel %u done after %llu ticks\n",
+                    i, curTick() - startTick);
+            c.done = true;
+            c.doneTick = curTick();
+        } else
+            finished = false;
+    }
+
+    if (!finished) {
+        schedule(pollEvent, curTick() + pollInterval);
+        return;
+    }
+
+    for (unsigned i = 0; i < chans.size(); i++)
+        verifyChannel(i);
+
+    bytesCopied = chans.size() * descriptors * descSize;
+    copyTicks = curTick() - startTick;
+    exitSimLoop("copy engine driver finished");
+}
+
+void
+CopyEngineDriver::regStats()
+{
+    MemObject::regStats();
+
+    using namespace Stats;
+
+    bytesCopied
+        .name(name() + ".bytes_copied")
+        .desc("Number of bytes copied by all channels")
+        ;
+
+    copyTicks
+        .name(name() + ".copy_ticks")
+        .desc("Ticks until all channels were done")
+        ;
+
+    bandwidth
+        .name(name() + ".bandwidth")
+        .desc("Achieved bandwidth in bytes/s")
+        .precision(0)
+        ;
+    bandwidth = bytesCopied / (copyTicks / constant(SimClock::Frequency));
+}
+
+CopyEngineDriver *
+CopyEngineDriverParams::create()
+{
+    return new CopyEngineDriver(this);
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __CPU_TESTERS_CE_DRIVER_CE_DRIVER_HH__
+#define __CPU_TESTERS_CE_DRIVER_CE_DRIVER_HH__
+
+#include <vector>
+
+#include "base/statistics.hh"
+#include "mem/mem_object.hh"
+#include "params/CopyEngineDriver.hh"
+#include "sim/eventq.hh"
+
+/**
+ * Drives the channels of a CopyEngine like a device driver would do, but
+ * without running an operating system. At startup, it writes a chain of
+ * descriptors and the source buffers for each channel into memory and
+ * starts the channels. Afterwards, it polls the completion status of each
+ * channel until the last descriptor of every channel has been copied,
+ * checks the copied data and exits the simulation loop.
+ *
+ * All accesses of the driver are functional, because their timing is not
+ * of interest: the time until the copy engine is done is the time it
+ * needed for the copies. The copy engine has to be reachable at
+ * engine_addr via the port, i.e., its BAR0 has to be fixed by the
+ * configuration.
+ */
+class CopyEngineDriver : public MemObject
+{
+  public:
+
+    typedef CopyEngineDriverParams Params;
+    CopyEngineDriver(const Params *p);
+
+    void init() M5_ATTR_OVERRIDE;
+
+    void startup() M5_ATTR_OVERRIDE;
+
+    void regStats() M5_ATTR_OVERRIDE;
+
+    BaseMasterPort &getMasterPort(const std::string &if_name,
+                                  PortID idx = InvalidPortID) M5_ATTR_OVERRIDE;
+
+  protected:
+
+    class DriverPort : public MasterPort
+    {
+      public:
+
+        DriverPort(const std::string &_name, CopyEngineDriver &_driver)
+            : MasterPort(_name, &_driver)
+        { }
+
+      protected:
+
+        bool recvTimingResp(PacketPtr pkt) M5_ATTR_OVERRIDE
+        { panic("CopyEngineDriver doesn't expect responses\n"); }
+
+        void recvReqRetry() M5_ATTR_OVERRIDE
+        { panic("CopyEngineDriver doesn't expect retries\n"); }
+    };
+
+    /** The memory layout of a channel */
+    struct Channel {
+        Addr descAddr;
+        Addr statusAddr;
+        Addr srcAddr;
+        Addr dstAddr;
+        bool done;
+        Tick doneTick;
+    };
+
+    void poll();
+
+    EventWrapper<CopyEngineDriver, &CopyEngineDriver::poll> pollEvent;
+
+    void readMem(Addr addr, void *data, unsigned size);
+    void writeMem(Addr addr, const void *data, unsigned size);
+
+    void writeReg(unsigned chan, Addr reg, uint64_t val, unsigned size);
+
+    uint8_t pattern(unsigned chan, unsigned desc, Addr off) const;
+
+    void setupChannel(unsigned chan);
+
+    void verifyChannel(unsigned chan);
+
+    DriverPort port;
+
+    /** Request id for all accesses */
+    MasterID masterId;
+
+    const Addr engineAddr;
+    const Addr memAddr;
+    const unsigned descriptors;
+    const Addr descSize;
+    const unsigned statusInterval;
+    const Tick pollInterval;
+
+    std::vector<Channel> chans;
+
+    Tick startTick;
+
+    Stats::Scalar bytesCopied;
+    Stats::Scalar copyTicks;
+    Stats::Formula bandwidth;
+};
+
+#endif // __CPU_TESTERS_CE_DRIVER_CE_DRIVER_HH__
@@ -0,0 +1,89 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+from MemObject import MemObject
+from m5.params import *
+from m5.proxy import *
+
+# How the destination of a command is chosen
+class DtuTrafficPattern(Enum): vals = ['uniform', 'hotspot', 'many_to_one',
+                                      'permutation']
+
+# How the time between two commands is chosen
+class DtuTrafficArrival(Enum): vals = ['periodic', 'poisson']
+
+# The traffic generator replaces the CPU of a PE and is connected to the
+# dcache_slave_port of the DTU. It programs the endpoints via the register
+# file and uses the local memory (SPM) behind the DTU for the message buffers.
+# All generators in a system need to use the same sizes, because they access
+# each others memory with the same layout.
+class DtuTrafficGen(MemObject):
+    type = 'DtuTrafficGen'
+    cxx_header = "cpu/testers/dtu_traffic_gen/dtu_traffic_gen.hh"
+    port = MasterPort("Port to the DTU")
+    system = Param.System(Parent.any, "System this generator is part of")
+
+    id = Param.Unsigned("Core id of the PE this generator belongs to")
+    pes = VectorParam.Unsigned("Core ids of all traffic generators")
+
+    regfile_base_addr = Param.Addr(0x5C0000000, "Register file address")
+    cmd_epid_bits = Param.Unsigned(8,
+        "Number of bits used to identify the endpoint in a command")
+
+    pattern = Param.DtuTrafficPattern('uniform', "Destination pattern")
+    hotspot = Param.Unsigned(0, "Core id of the hotspot (or the sink)")
+    hotspot_percent = Param.Percent(50,
+        "Percentage of commands that go to the hotspot")
+    seed = Param.Unsigned(0, "Seed for the permutation pattern")
+
+    arrival = Param.DtuTrafficArrival('periodic', "Arrival process")
+    interval = Param.Cycles(100, "(Mean) number of cycles between commands")
+    poll_interval = Param.Cycles(10,
+        "Number of cycles between checks for received messages")
+
+    read_percent = Param.Percent(0, "Percentage of READ commands")
+    write_percent = Param.Percent(0, "Percentage of WRITE commands")
+    reply = Param.Bool(True, "Reply to received messages")
+    wait_reply = Param.Bool(False,
+        "Wait for the reply to a message before issuing the next command")
+
+    msg_size = Param.MemorySize("64B", "Payload size of messages")
+    xfer_size = Param.MemorySize("1kB", "Size of READ and WRITE commands")
+    msg_slots = Param.Unsigned(8, "Number of slots in the receive buffers")
+    mem_pe = Param.Int(-1,
+        "Core id of the memory PE for READ/WRITE (-1 = use the pattern)")
+
+    # with paging, the generator builds an identity mapping of its local
+    # memory at address 0, which is where ROOT_PT points to by default, and
+    # cycles through local_pages pages as the source/destination of commands.
+    # This requires a DTU with TLB (tlb_entries > 0).
+    paging = Param.Bool(False, "Let the DTU translate local addresses")
+    local_pages = Param.Unsigned(1, "Number of local pages to use for data")
+
+    max_ops = Param.Counter(0,
+        "Number of commands to issue (0 = unlimited); the simulation is "
+        "stopped as soon as all generators are finished")
@@ -0,0 +1,745 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "base/intmath.hh"
+#include "base/random.hh"
+#include "cpu/testers/dtu_traffic_gen/dtu_traffic_gen.hh"
+#include "debug/DtuTrafficGen.hh"
+#include "mem/dtu/dtu.hh"
+#include "sim/sim_exit.hh"
+#include "sim/stats.hh"
+
+unsigned DtuTrafficGen::activeGens = 0;
+
+const char *DtuTrafficGen::opNames[] = {
+    "send",
+    "reply",
+    "read",
+    "write",
+    "fetch",
+    "ack",
+};
+
+Addr
+DtuTrafficGen::getRegAddr(DtuReg reg) const
+{
+    return regFileBaseAddr + static_cast<Addr>(reg) * sizeof(RegFile::reg_t);
+}
+
+Addr
+DtuTrafficGen::getRegAddr(CmdReg reg) const
+{
+    Addr off = numDtuRegs + static_cast<Addr>(reg);
+    return regFileBaseAddr + off * sizeof(RegFile::reg_t);
+}
+
+Addr
+DtuTrafficGen::getEpAddr(unsigned epId) const
+{
+    Addr off = numDtuRegs + numCmdRegs + epId * numEpRegs;
+    return regFileBaseAddr + off * sizeof(RegFile::reg_t);
+}
+
+bool
+DtuTrafficGen::CpuPort::recvTimingResp(PacketPtr pkt)
+{
+    gen.completeRequest(pkt);
+    return true;
+}
+
+void
+DtuTrafficGen::CpuPort::recvReqRetry()
+{
+    gen.recvRetry();
+}
+
+DtuTrafficGen::DtuTrafficGen(const DtuTrafficGenParams *p)
+  : MemObject(p),
+    tickEvent(this),
+    port("port", this),
+    state(State::INIT),
+    curOp(SEND),
+    curEp(),
+    curDest(),
+    curMsg(),
+    cmdStart(),
+    system(p->system),
+    masterId(p->system->getMasterId(name())),
+    id(p->id),
+    atomic(p->system->isAtomicMode()),
+    pes(p->pes),
+    regFileBaseAddr(p->regfile_base_addr),
+    cmdEpidBits(p->cmd_epid_bits),
+    pattern(p->pattern),
+    hotspot(p->hotspot),
+    hotspotPercent(p->hotspot_percent),
+    permDest(p->id),
+    arrival(p->arrival),
+    interval(p->interval),
+    pollInterval(p->poll_interval),
+    nextOpTick(0),
+    readPercent(p->read_percent),
+    writePercent(p->write_percent),
+    reply(p->reply),
+    waitReply(p->wait_reply),
+    awaitingReply(false),
+    sendStart(0),
+    msgSize(p->msg_size),
+    xferSize(p->xfer_size),
+    msgSlots(p->msg_slots),
+    memPe(p->mem_pe),
+    paging(p->paging),
+    localPages(p->local_pages),
+    maxOps(p->max_ops),
+    issuedOps(0),
+    finished(false),
+    counter(0),
+    fetchEp(RECV_EP),
+    retryPkt(nullptr)
+{
+    if (pes.empty())
+        fatal("%s: the list of PEs must not be empty\n", name());
+    if (std::find(pes.begin(), pes.end(), id) == pes.end())
+        fatal("%s: own core id %u is not in the list of PEs\n", name(), id);
+    if (readPercent + writePercent > 100)
+        fatal("%s: the READ and WRITE percentages exceed 100\n", name());
+    if (msgSlots == 0 || msgSlots > RecvEp::MAX_MSGS)
+        fatal("%s: number of slots needs to be in 1..%u\n",
+              name(), RecvEp::MAX_MSGS);
+
+    // every message slot has to hold the header and the payload
+    slotSize = 1;
+    while (slotSize < sizeof(Dtu::MessageHeader) + msgSize)
+        slotSize <<= 1;
+    if (slotSize >= (static_cast<Addr>(1) << MAX_MSG_SZ_BITS))
+        fatal("%s: message size %lu is too large\n", name(), msgSize);
+
+    // page tables (if paging), data buffer(s), receive buffer, reply buffer
+    // and the memory area for others
+    ptAddr = 0;
+    if (paging)
+    {
+        if (localPages == 0)
+            fatal("%s: at least one local page is required\n", name());
+        if (std::max(msgSize, xferSize) > DtuTlb::PAGE_SIZE)
+            fatal("%s: with paging, transfers can't exceed a page\n", name());
+
+        // root PT and one level 0 PT
+        dataAddr = ptAddr + 2 * DtuTlb::PAGE_SIZE;
+        recvBufAddr = dataAddr + localPages * DtuTlb::PAGE_SIZE;
+    }
+    else
+    {
+        dataAddr = 0;
+        recvBufAddr = roundUp(dataAddr + std::max(msgSize, xferSize), 64);
+    }
+    bufAddr = dataAddr;
+    replyBufAddr = recvBufAddr + msgSlots * slotSize;
+    memAreaAddr = roundUp(replyBufAddr + msgSlots * slotSize, 64);
+
+    if (paging && memAreaAddr + xferSize >
+        (DtuTlb::LEVEL_MASK + 1) * DtuTlb::PAGE_SIZE)
+        fatal("%s: too many local pages\n", name());
+
+    // all generators build the same permutation, which is a single cycle
+    // through all PEs, so that everybody sends to and receives from exactly
+    // one PE
+    if (pattern == Enums::permutation)
+    {
+        std::vector<unsigned> perm(pes);
+        std::sort(perm.begin(), perm.end());
+        std::mt19937 permGen(p->seed);
+        std::shuffle(perm.begin(), perm.end(), permGen);
+
+        size_t idx = std::find(perm.begin(), perm.end(), id) - perm.begin();
+        permDest = perm[(idx + 1) % perm.size()];
+    }
+
+    if (maxOps > 0 && issuesOps())
+        activeGens++;
+
+    // kick things into action
+    schedule(tickEvent, curTick());
+}
+
+BaseMasterPort &
+DtuTrafficGen::getMasterPort(const std::string& if_name, PortID idx)
+{
+    if (if_name == "port")
+        return port;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+bool
+DtuTrafficGen::issuesOps() const
+{
+    // the sink only replies
+    if (pattern == Enums::many_to_one && id == hotspot)
+        return false;
+
+    if (awaitingReply)
+        return false;
+
+    return maxOps == 0 || issuedOps < maxOps;
+}
+
+void
+DtuTrafficGen::checkFinished()
+{
+    if (finished || maxOps == 0 || issuedOps < maxOps || awaitingReply)
+        return;
+
+    DPRINTF(DtuTrafficGen, "Issued all %lu commands\n", maxOps);
+    finished = true;
+    if (--activeGens == 0)
+        exitSimLoop("all DTU traffic generators finished");
+}
+
+unsigned
+DtuTrafficGen::chooseDest()
+{
+    switch (pattern)
+    {
+    case Enums::hotspot:
+        if (id != hotspot && random_mt.random(0, 99) < hotspotPercent)
+            return hotspot;
+        break;
+    case Enums::many_to_one:
+        return hotspot;
+    case Enums::permutation:
+        return permDest;
+    default:
+        break;
+    }
+
+    if (pes.size() == 1)
+        return pes[0];
+
+    // uniform over all others
+    unsigned dest;
+    do
+    {
+        dest = pes[random_mt.random<size_t>(0, pes.size() - 1)];
+    }
+    while (dest == id);
+    return dest;
+}
+
+Tick
+DtuTrafficGen::chooseInterArrival()
+{
+    Tick mean = clockPeriod() * interval;
+    if (arrival == Enums::periodic)
+        return mean;
+
+    // exponentially distributed inter-arrival times
+    double u = random_mt.random<double>();
+    return static_cast<Tick>(-std::log(1.0 - u) * mean);
+}
+
+PacketPtr
+DtuTrafficGen::createPkt(Addr addr, size_t size, MemCmd cmd)
+{
+    Request::Flags flags;
+
+    auto req = new Request(addr, size, flags, masterId);
+    req->setThreadContext(id, 0);
+
+    auto pkt = new Packet(req, cmd);
+    auto pkt_data = new uint8_t[size];
+    memset(pkt_data, 0, size);
+    pkt->dataDynamic(pkt_data);
+
+    return pkt;
+}
+
+PacketPtr
+DtuTrafficGen::createRegPkt(Addr addr,
+                            const std::vector<RegFile::reg_t> &values)
+{
+    size_t size = values.size() * sizeof(RegFile::reg_t);
+    auto pkt = createPkt(addr, size, MemCmd::WriteReq);
+    memcpy(pkt->getPtr<uint8_t>(), &values[0], size);
+    return pkt;
+}
+
+PacketPtr
+DtuTrafficGen::createEpPkt(unsigned epId,
+                           RegFile::reg_t r0,
+                           RegFile::reg_t r1,
+                           RegFile::reg_t r2)
+{
+    return createRegPkt(getEpAddr(epId), {r0, r1, r2});
+}
+
+PacketPtr
+DtuTrafficGen::createCmdPkt(Op op,
+                            unsigned epId,
+                            Addr dataAddr,
+                            Addr dataSize,
+                            Addr offset)
+{
+    static const Dtu::Command::Opcode opcodes[] = {
+        Dtu::Command::SEND,
+        Dtu::Command::REPLY,
+        Dtu::Command::READ,
+        Dtu::Command::WRITE,
+        Dtu::Command::FETCH_MSG,
+        Dtu::Command::ACK_MSG,
+    };
+
+    RegFile::reg_t cmd = opcodes[op] | (epId << Dtu::numCmdOpcodeBits);
+
+    // the registers are written in order, i.e., all arguments are set when
+    // the command is executed
+    return createRegPkt(getRegAddr(CmdReg::COMMAND), {
+        cmd, dataAddr, dataSize, offset, REPLY_EP,
+        static_cast<RegFile::reg_t>(issuedOps)
+    });
+}
+
+void
+DtuTrafficGen::startOp()
+{
+    // with paging, we cycle through the local pages
+    if (paging)
+        bufAddr = dataAddr + (issuedOps % localPages) * DtuTlb::PAGE_SIZE;
+
+    issuedOps++;
+    nextOpTick = curTick() + chooseInterArrival();
+
+    int r = random_mt.random(0, 99);
+    if (r < readPercent)
+        curOp = READ;
+    else if (r < readPercent + writePercent)
+        curOp = WRITE;
+    else
+        curOp = SEND;
+
+    curDest = chooseDest();
+    state = State::START_CMD;
+}
+
+void
+DtuTrafficGen::scheduleIdle()
+{
+    Tick when = clockEdge(pollInterval);
+    if (issuesOps())
+        when = std::min(when, std::max(nextOpTick, clockEdge(Cycles(1))));
+    schedule(tickEvent, when);
+}
+
+bool
+DtuTrafficGen::sendPkt(PacketPtr pkt)
+{
+    DPRINTF(DtuTrafficGen, "Send %s %s request at address %#x\n",
+                           atomic ? "atomic" : "timed",
+                           pkt->isWrite() ? "write" : "read",
+                           pkt->getAddr());
+
+    if (atomic)
+    {
+        port.sendAtomic(pkt);
+        completeRequest(pkt);
+    }
+    else
+    {
+        bool retry = !port.sendTimingReq(pkt);
+
+        if (retry)
+        {
+            retryPkt = pkt;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+DtuTrafficGen::recvRetry()
+{
+    assert(retryPkt);
+    if (port.sendTimingReq(retryPkt))
+    {
+        DPRINTF(DtuTrafficGen, "Proceeding after successful retry\n");
+
+        retryPkt = nullptr;
+    }
+}
+
+void
+DtuTrafficGen::finishCmd(unsigned error)
+{
+    if (curOp < NUM_MEASURED_OPS)
+    {
+        Cycles lat = ticksToCycles(curTick() - cmdStart);
+
+        DPRINTF(DtuTrafficGen, "%s to PE%u finished after %lu cycles (%u)\n",
+                opNames[curOp], curDest, static_cast<uint64_t>(lat), error);
+
+        ops[curOp]++;
+        latency[curOp].sample(static_cast<Counter>(lat));
+        totalLatency[curOp] += static_cast<Counter>(lat);
+        if (error != Dtu::NONE)
+            errors[curOp]++;
+        else
+            bytes[curOp] += (curOp == READ || curOp == WRITE) ? xferSize
+                                                              : msgSize;
+
+        if (curOp == SEND && waitReply && error == Dtu::NONE)
+        {
+            awaitingReply = true;
+            sendStart = cmdStart;
+        }
+
+        if (curOp != REPLY)
+            checkFinished();
+    }
+
+    state = State::IDLE;
+}
+
+void
+DtuTrafficGen::completeRequest(PacketPtr pkt)
+{
+    Request* req = pkt->req;
+
+    DPRINTF(DtuTrafficGen, "Completing %s at address %#x %s\n",
+                           pkt->isWrite() ? "write" : "read",
+                           req->getPaddr(),
+                           pkt->isError() ? "error" : "success");
+
+    if (pkt->isError())
+        panic("%s access failed at %#x\n",
+              pkt->isWrite() ? "Write" : "Read", req->getPaddr());
+
+    bool idle = false;
+
+    if (pkt->isRead())
+    {
+        const RegFile::reg_t *regs = pkt->getConstPtr<RegFile::reg_t>();
+
+        if (state == State::CHECK_MSGS)
+        {
+            if (regs[0] > 0)
+            {
+                curOp = FETCH;
+                curEp = fetchEp;
+                curDest = id;
+                state = State::START_CMD;
+            }
+            else
+            {
+                state = State::IDLE;
+                idle = true;
+            }
+        }
+        else
+        {
+            assert(state == State::WAIT_CMD);
+
+            RegFile::reg_t opcodeMask =
+                (static_cast<RegFile::reg_t>(1) << Dtu::numCmdOpcodeBits) - 1;
+
+            // if the command is still running, we simply poll again
+            bool done = (regs[0] & opcodeMask) == Dtu::Command::IDLE;
+            if (done && curOp == FETCH)
+            {
+                // regs[3] is the OFFSET register
+                Addr msg = regs[3];
+                fetchEp = curEp == RECV_EP ? REPLY_EP : RECV_EP;
+
+                if (msg)
+                {
+                    DPRINTF(DtuTrafficGen, "EP%u: fetched message @ %#x\n",
+                            curEp, msg);
+
+                    curMsg = msg;
+                    if (curEp == RECV_EP)
+                    {
+                        receivedMsgs++;
+                        curOp = reply ? REPLY : ACK;
+                    }
+                    else
+                    {
+                        receivedReplies++;
+                        curOp = ACK;
+
+                        if (awaitingReply)
+                        {
+                            Tick rtt = curTick() - sendStart;
+                            roundTrip.sample(
+                                static_cast<Counter>(ticksToCycles(rtt)));
+                            awaitingReply = false;
+                            checkFinished();
+                        }
+                    }
+                    state = State::START_CMD;
+                }
+                else
+                    state = State::IDLE;
+            }
+            else if (done)
+            {
+                unsigned bits = Dtu::numCmdOpcodeBits + cmdEpidBits;
+                finishCmd(regs[0] >> bits);
+            }
+        }
+    }
+
+    delete pkt->req;
+
+    // the packet will delete the data
+    delete pkt;
+
+    // kick things into action again
+    if (idle)
+        scheduleIdle();
+    else
+        schedule(tickEvent, clockEdge(Cycles(1)));
+}
+
+void
+DtuTrafficGen::tick()
+{
+    using reg_t = RegFile::reg_t;
+
+    PacketPtr pkt = nullptr;
+
+    switch (state)
+    {
+    case State::INIT:
+    {
+        // the receive buffers are located in our local memory
+        reg_t r0 = (static_cast<reg_t>(EpType::RECEIVE) << 61) |
+                   (static_cast<reg_t>(slotSize) << 32) |
+                   (static_cast<reg_t>(msgSlots) << 16);
+
+        if (counter == 0)
+        {
+            DPRINTF(DtuTrafficGen, "Setup receive EPs (%u slots a %lu bytes)\n",
+                    msgSlots, slotSize);
+            pkt = createEpPkt(RECV_EP, r0, recvBufAddr, 0);
+        }
+        else
+        {
+            pkt = createEpPkt(REPLY_EP, r0, replyBufAddr, 0);
+            state = State::IDLE;
+            nextOpTick = curTick();
+        }
+        counter++;
+        break;
+    }
+
+    case State::IDLE:
+    {
+        if (issuesOps() && curTick() >= nextOpTick)
+        {
+            startOp();
+
+            // configure the endpoint for the destination
+            if (curOp == SEND)
+            {
+                reg_t r0 =
+                    (static_cast<reg_t>(EpType::SEND) << 61) | slotSize;
+                reg_t r1 =
+                    (static_cast<reg_t>(curDest) << (CREDITS_BITS + EP_BITS)) |
+                    (static_cast<reg_t>(RECV_EP) << CREDITS_BITS) |
+                    Dtu::CREDITS_UNLIM;
+                pkt = createEpPkt(SEND_EP, r0, r1, id);
+            }
+            else
+            {
+                Addr remote = memAreaAddr;
+                if (memPe >= 0)
+                {
+                    curDest = memPe;
+                    remote = 0;
+                }
+
+                reg_t r0 =
+                    (static_cast<reg_t>(EpType::MEMORY) << 61) | xferSize;
+                reg_t r2 =
+                    (static_cast<reg_t>(curDest) << FLAGS_BITS) |
+                    Dtu::MemoryFlags::READ | Dtu::MemoryFlags::WRITE;
+                pkt = createEpPkt(MEM_EP, r0, remote, r2);
+            }
+
+            DPRINTF(DtuTrafficGen, "Starting %s #%lu to PE%u\n",
+                    opNames[curOp], issuedOps, curDest);
+        }
+        else
+        {
+            // check whether there are messages to handle
+            pkt = createPkt(getRegAddr(DtuReg::MSG_CNT),
+                            sizeof(reg_t),
+                            MemCmd::ReadReq);
+            state = State::CHECK_MSGS;
+        }
+        break;
+    }
+
+    case State::START_CMD:
+    {
+        switch (curOp)
+        {
+        case SEND:
+            pkt = createCmdPkt(curOp, SEND_EP, bufAddr, msgSize, 0);
+            break;
+        case REPLY:
+            pkt = createCmdPkt(curOp, RECV_EP, bufAddr, msgSize, curMsg);
+            break;
+        case READ:
+        case WRITE:
+            pkt = createCmdPkt(curOp, MEM_EP, bufAddr, xferSize, 0);
+            break;
+        case FETCH:
+            pkt = createCmdPkt(curOp, curEp, 0, 0, 0);
+            break;
+        case ACK:
+            pkt = createCmdPkt(curOp, curEp, 0, 0, curMsg);
+            break;
+        }
+
+        cmdStart = curTick();
+        state = State::WAIT_CMD;
+        break;
+    }
+
+    case State::WAIT_CMD:
+    {
+        // read COMMAND, DATA_ADDR, DATA_SIZE and OFFSET
+        pkt = createPkt(getRegAddr(CmdReg::COMMAND),
+                        sizeof(reg_t) * 4,
+                        MemCmd::ReadReq);
+        break;
+    }
+
+    case State::CHECK_MSGS:
+        panic("Unexpected tick in state CHECK_MSGS");
+    }
+
+    // Block until a retry is received, if necessary.
+    sendPkt(pkt);
+}
+
+void
+DtuTrafficGen::initState()
+{
+    MemObject::initState();
+
+    if (!paging)
+        return;
+
+    // the DTU walks the page tables in our local memory, starting at
+    // ROOT_PT (which is 0 by default). we map everything behind the page
+    // tables 1:1 with a single level 0 PT.
+    PtUnit::PageTableEntry pte = 0;
+    pte.ixwr = DtuTlb::IRWX;
+
+    Addr level0Pt = ptAddr + DtuTlb::PAGE_SIZE;
+    pte.base = level0Pt >> DtuTlb::PAGE_BITS;
+    system->physProxy.write<uint64_t>(ptAddr, pte);
+
+    for (Addr addr = dataAddr; addr < memAreaAddr + xferSize;
+         addr += DtuTlb::PAGE_SIZE)
+    {
+        Addr idx = (addr >> DtuTlb::PAGE_BITS) & DtuTlb::LEVEL_MASK;
+        pte.base = addr >> DtuTlb::PAGE_BITS;
+        system->physProxy.write<uint64_t>(level0Pt + idx * DtuTlb::PTE_SIZE,
+                                          pte);
+    }
+}
+
+void
+DtuTrafficGen::regStats()
+{
+    MemObject::regStats();
+
+    using namespace Stats;
+
+    for (size_t i = 0; i < NUM_MEASURED_OPS; ++i)
+    {
+        std::string prefix = name() + "." + opNames[i];
+
+        ops[i]
+            .name(prefix + "Cmds")
+            .desc("Number of completed commands");
+        errors[i]
+            .name(prefix + "Errors")
+            .desc("Number of commands that failed");
+        bytes[i]
+            .name(prefix + "Bytes")
+            .desc("Number of transferred bytes");
+        totalLatency[i]
+            .name(prefix + "TotalLatency")
+            .desc("Total latency of all commands (in cycles)");
+        latency[i]
+            .init(16)
+            .name(prefix + "Latency")
+            .desc("Latency of the commands (in cycles)")
+            .flags(nozero);
+        avgLatency[i]
+            .name(prefix + "AvgLatency")
+            .desc("Average latency of the commands (in cycles)")
+            .precision(2);
+        avgLatency[i] = totalLatency[i] / ops[i];
+        bandwidth[i]
+            .name(prefix + "Bandwidth")
+            .desc("Achieved bandwidth (bytes/s)")
+            .precision(0);
+        bandwidth[i] = bytes[i] / simSeconds;
+    }
+
+    roundTrip
+        .init(16)
+        .name(name() + ".roundTrip")
+        .desc("Time from sending a message until the reply (in cycles)")
+        .flags(Stats::nozero);
+
+    receivedMsgs
+        .name(name() + ".receivedMsgs")
+        .desc("Number of received messages");
+    receivedReplies
+        .name(name() + ".receivedReplies")
+        .desc("Number of received replies");
+}
+
+DtuTrafficGen*
+DtuTrafficGenParams::create()
+{
+    return new DtuTrafficGen(this);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __CPU_DTU_TRAFFIC_GEN_DTU_TRAFFIC_GEN_HH__
+#define __CPU_DTU_TRAFFIC_GEN_DTU_TRAFFIC_GEN_HH__
+
+#include <vector>
+
+#include "base/statistics.hh"
+#include "mem/dtu/regfile.hh"
+#include "mem/mem_object.hh"
+#include "params/DtuTrafficGen.hh"
+#include "sim/system.hh"
+
+/**
+ * A traffic generator for the DTU. It is attached to the DTU instead of a
+ * CPU and drives it via the register file like software would do: it
+ * configures the endpoints, writes the command registers and polls for
+ * their completion. It issues SEND, READ and WRITE commands to destinations
+ * chosen by a pattern and replies to received messages. For each command
+ * type, the latency (from writing the command register until the DTU
+ * reports completion) and the transferred bytes are recorded.
+ */
+class DtuTrafficGen : public MemObject
+{
+  public:
+
+    DtuTrafficGen(const DtuTrafficGenParams *p);
+
+    BaseMasterPort& getMasterPort(const std::string &if_name,
+                                  PortID idx = InvalidPortID) override;
+
+    void initState() override;
+
+    void regStats() override;
+
+  protected:
+
+    /// main simulation loop
+    void tick();
+
+    EventWrapper<DtuTrafficGen, &DtuTrafficGen::tick> tickEvent;
+
+    class CpuPort : public MasterPort
+    {
+      private:
+        DtuTrafficGen& gen;
+      public:
+        CpuPort(const std::string& _name, DtuTrafficGen* _gen)
+            : MasterPort(_name, _gen), gen(*_gen)
+        { }
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+
+        void recvReqRetry() override;
+    };
+
+    CpuPort port;
+
+    enum class State
+    {
+        INIT,
+        IDLE,
+        START_CMD,
+        WAIT_CMD,
+        CHECK_MSGS,
+    };
+
+    /// The operations; the first ones are the measured commands
+    enum Op
+    {
+        SEND,
+        REPLY,
+        READ,
+        WRITE,
+        FETCH,
+        ACK,
+    };
+
+    static const unsigned NUM_MEASURED_OPS = FETCH;
+
+    // the endpoint layout (the same on all PEs)
+    static const unsigned SEND_EP   = 0;
+    static const unsigned RECV_EP   = 1;
+    static const unsigned REPLY_EP  = 2;
+    static const unsigned MEM_EP    = 3;
+
+    State state;
+
+    /// The operation that is currently executed
+    Op curOp;
+    unsigned curEp;
+    unsigned curDest;
+    Addr curMsg;
+    Tick cmdStart;
+
+    System *system;
+
+    /// Request id for all generated traffic
+    MasterID masterId;
+
+    const unsigned id;
+
+    const bool atomic;
+
+    std::vector<unsigned> pes;
+
+    const Addr regFileBaseAddr;
+    const unsigned cmdEpidBits;
+
+    const Enums::DtuTrafficPattern pattern;
+    const unsigned hotspot;
+    const int hotspotPercent;
+    /// The destination in the permutation pattern
+    unsigned permDest;
+
+    const Enums::DtuTrafficArrival arrival;
+    const Cycles interval;
+    const Cycles pollInterval;
+    Tick nextOpTick;
+
+    const int readPercent;
+    const int writePercent;
+    const bool reply;
+    const bool waitReply;
+    /// Whether we wait for a reply and when the message has been sent
+    bool awaitingReply;
+    Tick sendStart;
+
+    const Addr msgSize;
+    const Addr xferSize;
+    const unsigned msgSlots;
+    const int memPe;
+
+    const bool paging;
+    const unsigned localPages;
+
+    // the layout of the local memory
+    Addr slotSize;
+    Addr ptAddr;
+    Addr dataAddr;
+    Addr bufAddr;
+    Addr recvBufAddr;
+    Addr replyBufAddr;
+    Addr memAreaAddr;
+
+    const Counter maxOps;
+    Counter issuedOps;
+    bool finished;
+
+    /// used during initialization
+    int counter;
+
+    /// The receive EP to check next
+    unsigned fetchEp;
+
+    /// Stores the Packet for later retry
+    PacketPtr retryPkt;
+
+    /// The number of generators that have not finished yet
+    static unsigned activeGens;
+
+    bool issuesOps() const;
+
+    void checkFinished();
+
+    unsigned chooseDest();
+
+    Tick chooseInterArrival();
+
+    void startOp();
+
+    void finishCmd(unsigned error);
+
+    void scheduleIdle();
+
+    PacketPtr createPkt(Addr addr, size_t size, MemCmd cmd);
+
+    PacketPtr createRegPkt(Addr addr,
+                           const std::vector<RegFile::reg_t> &values);
+
+    PacketPtr createEpPkt(unsigned epId,
+                          RegFile::reg_t r0,
+                          RegFile::reg_t r1,
+                          RegFile::reg_t r2);
+
+    PacketPtr createCmdPkt(Op op,
+                           unsigned epId,
+                           Addr dataAddr,
+                           Addr dataSize,
+                           Addr offset);
+
+    bool sendPkt(PacketPtr pkt);
+
+    void completeRequest(PacketPtr pkt);
+
+    void recvRetry();
+
+    Addr getRegAddr(DtuReg reg) const;
+
+    Addr getRegAddr(CmdReg reg) const;
+
+    Addr getEpAddr(unsigned epId) const;
+
+    static const char *opNames[];
+
+    Stats::Scalar ops[NUM_MEASURED_OPS];
+    Stats::Scalar errors[NUM_MEASURED_OPS];
+    Stats::Scalar bytes[NUM_MEASURED_OPS];
+    Stats::Scalar totalLatency[NUM_MEASURED_OPS];
+    Stats::Histogram latency[NUM_MEASURED_OPS];
+    Stats::Formula avgLatency[NUM_MEASURED_OPS];
+    Stats::Formula bandwidth[NUM_MEASURED_OPS];
+    Stats::Histogram roundTrip;
+    Stats::Scalar receivedMsgs;
+    Stats::Scalar receivedReplies;
+};
+
+#endif // __CPU_DTU_TRAFFIC_GEN_DTU_TRAFFIC_GEN_HH__
@@ -0,0 +1,51 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+from MemObject import MemObject
+from m5.params import *
+from m5.proxy import *
+
+# Replays a trace recorded by NocTraceProbe. For each entry of cores, the
+# port with the same index injects the packets of that core into the NoC
+# and the sink with the same index receives the packets that are sent to
+# that core. Packets of other cores are skipped. The simulation is stopped
+# as soon as all packets have been replayed.
+class NocTraceReplay(MemObject):
+    type = 'NocTraceReplay'
+    cxx_header = "cpu/testers/noc_replay/noc_trace_replay.hh"
+    port = VectorMasterPort("Ports that inject the packets into the NoC")
+    sink = VectorSlavePort("Ports that receive the packets from the NoC")
+    system = Param.System(Parent.any, "System this replayer is part of")
+
+    trace_file = Param.String("The NoC trace to replay")
+    cores = VectorParam.Unsigned("Core ids to replay")
+
+    elastic = Param.Bool(True,
+        "Issue packets relative to their dependency instead of at the "
+        "recorded tick")
+    response_latency = Param.Cycles(1,
+        "Cycles until a sink responds to a packet")
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <map>
+
+#include "base/trace.hh"
+#include "cpu/testers/noc_replay/noc_trace_replay.hh"
+#include "debug/NocTraceReplay.hh"
+#include "mem/dtu/noc_addr.hh"
+#include "proto/noc.pb.h"
+#include "proto/protoio.hh"
+#include "sim/sim_exit.hh"
+
+NocTraceReplay::Source::Source(NocTraceReplay &_replay,
+                               unsigned _coreId,
+                               const std::string &portName)
+    : replay(_replay),
+      coreId(_coreId),
+      port(portName, &_replay, *this),
+      packets(),
+      retryPkt(),
+      lastIssue(),
+      lastRespArrived(),
+      lastResp(),
+      lastSeq(),
+      outstanding(),
+      issueEvent(this)
+{
+}
+
+void
+NocTraceReplay::Source::tryIssue()
+{
+    if (packets.empty() || retryPkt || issueEvent.scheduled())
+        return;
+
+    const TracePacket &tpkt = packets.front();
+
+    Tick when = tpkt.tick;
+    if (replay.elastic && tpkt.hasDep)
+    {
+        if (tpkt.depResp)
+        {
+            // we are woken up again when the response arrives
+            if (!lastRespArrived)
+                return;
+            when = lastResp + tpkt.delay;
+        }
+        else
+            when = lastIssue + tpkt.delay;
+    }
+
+    replay.schedule(issueEvent, std::max(when, curTick()));
+}
+
+void
+NocTraceReplay::Source::issue()
+{
+    assert(!retryPkt);
+
+    PacketPtr pkt = replay.createPacket(packets.front(), coreId);
+    packets.pop_front();
+
+    DPRINTF(NocTraceReplay, "%u -> %u: %s @ %#x (%u bytes)\n",
+            coreId, NocAddr(pkt->getAddr()).coreId, pkt->cmdString(),
+            pkt->getAddr(), pkt->getSize());
+
+    if (!port.sendTimingReq(pkt))
+        retryPkt = pkt;
+    else
+        completeIssue(pkt);
+}
+
+void
+NocTraceReplay::Source::recvRetry()
+{
+    assert(retryPkt);
+
+    PacketPtr pkt = retryPkt;
+    auto state = dynamic_cast<ReplaySenderState*>(pkt->senderState);
+    state->issued = curTick();
+
+    if (port.sendTimingReq(pkt))
+    {
+        retryPkt = NULL;
+        completeIssue(pkt);
+    }
+}
+
+void
+NocTraceReplay::Source::completeIssue(PacketPtr pkt)
+{
+    // the receiver owns packets without response
+    if (pkt->needsResponse())
+    {
+        auto state = dynamic_cast<ReplaySenderState*>(pkt->senderState);
+        state->seq = ++lastSeq;
+        outstanding++;
+    }
+    else
+        lastSeq++;
+
+    lastIssue = curTick();
+    lastRespArrived = false;
+
+    tryIssue();
+    replay.checkFinished();
+}
+
+void
+NocTraceReplay::Source::completeRequest(PacketPtr pkt)
+{
+    auto state = dynamic_cast<ReplaySenderState*>(pkt->popSenderState());
+    assert(state);
+
+    Cycles lat = replay.ticksToCycles(curTick() - state->issued);
+    replay.numPackets++;
+    replay.bytes += pkt->getSize();
+    replay.totalLatency += lat;
+    replay.latency.sample(lat);
+
+    // only the response to the last packet is a dependency
+    if (state->seq == lastSeq)
+    {
+        lastRespArrived = true;
+        lastResp = curTick();
+    }
+
+    assert(outstanding > 0);
+    outstanding--;
+
+    delete state;
+    delete pkt->req;
+    delete pkt;
+
+    tryIssue();
+    replay.checkFinished();
+}
+
+bool
+NocTraceReplay::SourcePort::recvTimingResp(PacketPtr pkt)
+{
+    src.completeRequest(pkt);
+    return true;
+}
+
+void
+NocTraceReplay::SourcePort::recvReqRetry()
+{
+    src.recvRetry();
+}
+
+NocTraceReplay::SinkPort::SinkPort(const std::string &_name,
+                                   NocTraceReplay *_replay,
+                                   unsigned _coreId)
+    : QueuedSlavePort(_name, _replay, queue),
+      queue(*_replay, *this),
+      replay(*_replay),
+      coreId(_coreId)
+{
+}
+
+Tick
+NocTraceReplay::SinkPort::recvAtomic(PacketPtr pkt)
+{
+    if (pkt->needsResponse())
+        pkt->makeResponse();
+    return replay.cyclesToTicks(replay.responseLatency);
+}
+
+void
+NocTraceReplay::SinkPort::recvFunctional(PacketPtr pkt)
+{
+    if (pkt->needsResponse())
+        pkt->makeResponse();
+}
+
+bool
+NocTraceReplay::SinkPort::recvTimingReq(PacketPtr pkt)
+{
+    if (pkt->needsResponse())
+    {
+        pkt->makeResponse();
+        schedTimingResp(pkt, replay.clockEdge(replay.responseLatency));
+    }
+    else
+    {
+        delete pkt->req;
+        delete pkt;
+    }
+    return true;
+}
+
+AddrRangeList
+NocTraceReplay::SinkPort::getAddrRanges() const
+{
+    AddrRangeList ranges;
+
+    Addr baseNocAddr = NocAddr(coreId, 0, 0).getAddr();
+    Addr topNocAddr  = NocAddr(coreId + 1, 0, 0).getAddr() - 1;
+
+    ranges.push_back(AddrRange(baseNocAddr, topNocAddr));
+    return ranges;
+}
+
+NocTraceReplay::NocTraceReplay(const NocTraceReplayParams *p)
+    : MemObject(p),
+      system(p->system),
+      masterId(p->system->getMasterId(name())),
+      traceFile(p->trace_file),
+      elastic(p->elastic),
+      responseLatency(p->response_latency),
+      sources(),
+      sinks(),
+      startTick(),
+      finished()
+{
+    for (size_t i = 0; i < p->cores.size(); ++i)
+    {
+        unsigned core = p->cores[i];
+        sources.push_back(new Source(*this, core,
+                                     csprintf("%s.port[%lu]", name(), i)));
+        sinks.push_back(new SinkPort(csprintf("%s.sink[%lu]", name(), i),
+                                     this, core));
+    }
+}
+
+NocTraceReplay::~NocTraceReplay()
+{
+    for (auto src : sources)
+        delete src;
+    for (auto sink : sinks)
+        delete sink;
+}
+
+BaseMasterPort &
+NocTraceReplay::getMasterPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "port" && idx < sources.size())
+        return sources[idx]->port;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+BaseSlavePort &
+NocTraceReplay::getSlavePort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "sink" && idx < sinks.size())
+        return *sinks[idx];
+    else
+        return MemObject::getSlavePort(if_name, idx);
+}
+
+void
+NocTraceReplay::init()
+{
+    MemObject::init();
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        fatal_if(!sources[i]->port.isConnected(),
+                 "Port %s is not connected", sources[i]->port.name());
+        fatal_if(!sinks[i]->isConnected(),
+                 "Port %s is not connected", sinks[i]->name());
+        sinks[i]->sendRangeChange();
+    }
+}
+
+void
+NocTraceReplay::loadTrace()
+{
+    ProtoInputStream trace(traceFile);
+
+    ProtoMessage::NocHeader header;
+    fatal_if(!trace.read(header), "Unable to read the header of %s",
+             traceFile);
+    fatal_if(header.tick_freq() != SimClock::Frequency,
+             "Trace %s has a tick frequency of %llu, expected %llu",
+             traceFile, header.tick_freq(), SimClock::Frequency);
+
+    std::map<unsigned, Source*> byCore;
+    std::map<unsigned, uint64_t> lastIds;
+    for (auto src : sources)
+        byCore[src->coreId] = src;
+
+    ProtoMessage::NocPacket msg;
+    while (trace.read(msg))
+    {
+        auto it = byCore.find(msg.src());
+        if (it == byCore.end())
+        {
+            skipped++;
+            continue;
+        }
+
+        // the dependency is always the previous packet of the source
+        fatal_if(msg.dep() != 0 && msg.dep() != lastIds[msg.src()],
+                 "Packet %llu in %s depends on %llu, which is not the "
+                 "previous packet of core %u",
+                 msg.id(), traceFile, msg.dep(), msg.src());
+        lastIds[msg.src()] = msg.id();
+
+        TracePacket tpkt;
+        tpkt.tick = msg.tick();
+        tpkt.dst = msg.dst();
+        tpkt.type = static_cast<Dtu::NocPacketType>(msg.type());
+        tpkt.cmd = static_cast<MemCmd::Command>(msg.cmd());
+        tpkt.addr = msg.addr();
+        tpkt.size = msg.size();
+        tpkt.hasDep = msg.dep() != 0;
+        tpkt.depResp = msg.dep_resp();
+        tpkt.delay = msg.delay();
+        it->second->packets.push_back(tpkt);
+    }
+}
+
+void
+NocTraceReplay::startup()
+{
+    fatal_if(!system->isTimingMode(),
+             "NocTraceReplay requires the timing mode");
+
+    loadTrace();
+
+    startTick = curTick();
+    for (auto src : sources)
+        src->tryIssue();
+    checkFinished();
+}
+
+PacketPtr
+NocTraceReplay::createPacket(const TracePacket &tpkt, unsigned src)
+{
+    Request *req = new Request(tpkt.addr, tpkt.size, 0, masterId);
+    PacketPtr pkt = new Packet(req, MemCmd(tpkt.cmd));
+    pkt->allocate();
+
+    // pretend to be a DTU, so that others can inspect the packet
+    auto state = new ReplaySenderState();
+    state->result = Dtu::NONE;
+    state->packetType = tpkt.type;
+    state->srcCore = src;
+    state->issued = curTick();
+    state->seq = 0;
+    pkt->pushSenderState(state);
+    return pkt;
+}
+
+void
+NocTraceReplay::checkFinished()
+{
+    if (finished)
+        return;
+
+    for (auto src : sources)
+    {
+        if (!src->packets.empty() || src->retryPkt || src->outstanding)
+            return;
+    }
+
+    finished = true;
+    replayTicks = curTick() - startTick;
+    exitSimLoop("NoC trace replay finished");
+}
+
+void
+NocTraceReplay::regStats()
+{
+    MemObject::regStats();
+
+    using namespace Stats;
+
+    numPackets
+        .name(name() + ".packets")
+        .desc("Number of replayed packets");
+    bytes
+        .name(name() + ".bytes")
+        .desc("Number of replayed bytes");
+    totalLatency
+        .name(name() + ".totalLatency")
+        .desc("Total latency of all packets (in cycles)");
+    latency
+        .init(16)
+        .name(name() + ".latency")
+        .desc("Latency from issue until the response (in cycles)")
+        .flags(nozero);
+    avgLatency
+        .name(name() + ".avgLatency")
+        .desc("Average latency of the packets (in cycles)")
+        .precision(2);
+    avgLatency = totalLatency / numPackets;
+    skipped
+        .name(name() + ".skipped")
+        .desc("Number of packets in the trace from other cores");
+    replayTicks
+        .name(name() + ".replayTicks")
+        .desc("Time until all packets have been replayed (in ticks)");
+}
+
+NocTraceReplay*
+NocTraceReplayParams::create()
+{
+    return new NocTraceReplay(this);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __CPU_NOC_REPLAY_NOC_TRACE_REPLAY_HH__
+#define __CPU_NOC_REPLAY_NOC_TRACE_REPLAY_HH__
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "mem/dtu/dtu.hh"
+#include "mem/mem_object.hh"
+#include "mem/qport.hh"
+#include "params/NocTraceReplay.hh"
+#include "sim/system.hh"
+
+/**
+ * Replays a NoC trace recorded by NocTraceProbe. It takes the place of
+ * the DTUs: for each core, it has a master port that injects the packets
+ * of that core into the NoC and a slave port that receives the packets for
+ * that core and responds to them after a fixed latency. Thus, it can be
+ * connected to any NoC model that routes by NoC address.
+ *
+ * The packets of each core are issued in the recorded order. In elastic
+ * mode, a packet is issued relative to its dependency: the given delay
+ * after the previous packet of the core has been issued or, if the
+ * response to it had arrived before in the recorded run, after its
+ * response has arrived. Thus, a faster or slower NoC shifts the following
+ * packets accordingly. Otherwise, each packet is issued at the recorded
+ * tick (or as soon as possible, if the NoC is behind).
+ */
+class NocTraceReplay : public MemObject
+{
+  public:
+
+    NocTraceReplay(const NocTraceReplayParams *p);
+
+    ~NocTraceReplay();
+
+    BaseMasterPort& getMasterPort(const std::string &if_name,
+                                  PortID idx = InvalidPortID) override;
+
+    BaseSlavePort& getSlavePort(const std::string &if_name,
+                                PortID idx = InvalidPortID) override;
+
+    void init() override;
+
+    void startup() override;
+
+    void regStats() override;
+
+  private:
+
+    struct TracePacket
+    {
+        Tick tick;
+        unsigned dst;
+        Dtu::NocPacketType type;
+        MemCmd::Command cmd;
+        Addr addr;
+        Addr size;
+        bool hasDep;
+        bool depResp;
+        Tick delay;
+    };
+
+    struct ReplaySenderState : public Dtu::NocSenderState
+    {
+        Tick issued;
+        uint64_t seq;
+    };
+
+    class Source;
+
+    class SourcePort : public MasterPort
+    {
+      private:
+        Source &src;
+      public:
+        SourcePort(const std::string &_name, NocTraceReplay *_replay,
+                   Source &_src)
+            : MasterPort(_name, _replay), src(_src)
+        { }
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+
+        void recvReqRetry() override;
+    };
+
+    /**
+     * The packets of one core in the trace
+     */
+    class Source
+    {
+      public:
+        Source(NocTraceReplay &_replay,
+               unsigned _coreId,
+               const std::string &portName);
+
+        const std::string name() const { return port.name(); }
+
+        void tryIssue();
+
+        void issue();
+
+        void recvRetry();
+
+        void completeIssue(PacketPtr pkt);
+
+        void completeRequest(PacketPtr pkt);
+
+        NocTraceReplay &replay;
+
+        const unsigned coreId;
+
+        SourcePort port;
+
+        std::deque<TracePacket> packets;
+
+        /// the packet that waits for a retry
+        PacketPtr retryPkt;
+
+        // the last issued packet
+        Tick lastIssue;
+        bool lastRespArrived;
+        Tick lastResp;
+        uint64_t lastSeq;
+
+        unsigned outstanding;
+
+        EventWrapper<Source, &Source::issue> issueEvent;
+    };
+
+    class SinkPort : public QueuedSlavePort
+    {
+      private:
+        RespPacketQueue queue;
+        NocTraceReplay &replay;
+        const unsigned coreId;
+      public:
+        SinkPort(const std::string &_name, NocTraceReplay *_replay,
+                 unsigned _coreId);
+      protected:
+        Tick recvAtomic(PacketPtr pkt) override;
+
+        void recvFunctional(PacketPtr pkt) override;
+
+        bool recvTimingReq(PacketPtr pkt) override;
+
+        AddrRangeList getAddrRanges() const override;
+    };
+
+    void loadTrace();
+
+    PacketPtr createPacket(const TracePacket &tpkt, unsigned src);
+
+    void checkFinished();
+
+    System *system;
+
+    /// Request id for all replayed packets
+    MasterID masterId;
+
+    const std::string traceFile;
+
+    const bool elastic;
+
+    const Cycles responseLatency;
+
+    std::vector<Source*> sources;
+
+    std::vector<SinkPort*> sinks;
+
+    Tick startTick;
+
+    bool finished;
+
+    Stats::Scalar numPackets;
+    Stats::Scalar bytes;
+    Stats::Scalar totalLatency;
+    Stats::Histogram latency;
+    Stats::Formula avgLatency;
+    Stats::Scalar skipped;
+    Stats::Scalar replayTicks;
+};
+
+#endif // __CPU_NOC_REPLAY_NOC_TRACE_REPLAY_HH__
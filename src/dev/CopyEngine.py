@@ -56,4 +56,9 @@ class CopyEngine(PciDevice):
     latBeforeBegin = Param.Latency('20ns', "Latency after a DMA command is seen before it's proccessed")
     latAfterCompletion = Param.Latency('20ns', "Latency after a DMA command is complete before it's reported as such")
 
-
+    DescPrefetch = Param.Unsigned(1, "Number of descriptors per channel "
+        "that are fetched ahead and processed at the same time")
+    Pipeline = Param.Bool(False, "Overlap the read of a descriptor with the "
+        "write of the previous one")
+    CoalesceCompletions = Param.Unsigned(1, "Number of descriptors with "
+        "completion status that are reported with a single write")
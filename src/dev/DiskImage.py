@@ -38,6 +38,12 @@ class DiskImage(SimObject):
 class RawDiskImage(DiskImage):
     type = 'RawDiskImage'
     cxx_header = "dev/disk_image.hh"
+    mmap = Param.Bool(False, "map the image into memory instead of using "
+                      "a stream")
+    read_ahead = Param.MemorySize("1MB", "read ahead of sequential reads "
+                                  "(mmap only)")
+    drop_behind = Param.Bool(False, "drop sequentially read data from the "
+                             "host page cache (mmap only)")
 
 class CowDiskImage(DiskImage):
     type = 'CowDiskImage'
@@ -45,4 +51,6 @@ class CowDiskImage(DiskImage):
     child = Param.DiskImage(RawDiskImage(read_only=True),
                             "child image")
     table_size = Param.Int(65536, "initial table size")
+    sparse_file = Param.String("", "store the written sectors in this "
+                               "sparse file instead of in memory")
     image_file = ""
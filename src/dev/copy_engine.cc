@@ -69,6 +69,10 @@ CopyEngine::CopyEngine(const Params *p)
 
     if (regs.chanCount > 64)
         fatal("CopyEngine interface doesn't support more than 64 DMA engines\n");
+    fatal_if(p->DescPrefetch == 0, "CopyEngine needs at least one "
+             "descriptor slot per channel\n");
+    fatal_if(p->CoalesceCompletions == 0, "CopyEngine can't coalesce zero "
+             "completion writes\n");
 
     for (int x = 0; x < regs.chanCount; x++) {
         CopyEngineChannel *ch = new CopyEngineChannel(this, x);
@@ -79,10 +83,17 @@ CopyEngine::CopyEngine(const Params *p)
 
 CopyEngine::CopyEngineChannel::CopyEngineChannel(CopyEngine *_ce, int cid)
     : cePort(_ce, _ce->sys),
-      ce(_ce), channelId(cid), busy(false), underReset(false),
-    refreshNext(false), latBeforeBegin(ce->params()->latBeforeBegin),
+      ce(_ce), channelId(cid), underReset(false),
+    refreshNext(false), lastDescriptorAddr(0), fetchAddress(0),
+    nextAddress(0), latBeforeBegin(ce->params()->latBeforeBegin),
     latAfterCompletion(ce->params()->latAfterCompletion),
-    completionDataReg(0), nextState(Idle),
+    completionDataReg(0), completionWriteData(0),
+    ring(ce->params()->DescPrefetch), ringHead(0), ringCount(0),
+    fetchState(FetchIdle), fetchPending(false), readPending(false),
+    writePending(false), statusPending(false), fetchSlot(0), readSlot(0),
+    writeSlot(0), pendingCompletions(0),
+    pipeline(ce->params()->Pipeline),
+    coalesceCompletions(ce->params()->CoalesceCompletions),
     fetchCompleteEvent(this), addrCompleteEvent(this),
     readCompleteEvent(this), writeCompleteEvent(this),
     statusCompleteEvent(this)
@@ -92,9 +103,13 @@ CopyEngine::CopyEngineChannel::CopyEngineChannel(CopyEngine *_ce, int cid)
         cr.descChainAddr = 0;
         cr.completionAddr = 0;
 
-        curDmaDesc = new DmaDesc;
-        memset(curDmaDesc, 0, sizeof(DmaDesc));
-        copyBuffer = new uint8_t[ce->params()->XferCap];
+        for (auto &s : ring) {
+            s.addr = 0;
+            memset(&s.desc, 0, sizeof(DmaDesc));
+            s.buffer = new uint8_t[ce->params()->XferCap];
+            s.state = SlotWritten;
+            s.reported = false;
+        }
 }
 
 CopyEngine::~CopyEngine()
@@ -106,8 +121,8 @@ CopyEngine::~CopyEngine()
 
 CopyEngine::CopyEngineChannel::~CopyEngineChannel()
 {
-    delete curDmaDesc;
-    delete [] copyBuffer;
+    for (auto &s : ring)
+        delete [] s.buffer;
 }
 
 BaseMasterPort &
@@ -136,25 +151,23 @@ void
 CopyEngine::CopyEngineChannel::recvCommand()
 {
     if (cr.command.start_dma()) {
-        assert(!busy);
+        assert(!busy());
         cr.status.dma_transfer_status(0);
-        nextState = DescriptorFetch;
+        fetchState = DescriptorFetch;
         fetchAddress = cr.descChainAddr;
-        if (ce->drainState() == DrainState::Running)
-            fetchDescriptor(cr.descChainAddr);
+        continueProcessing();
     } else if (cr.command.append_dma()) {
-        if (!busy) {
-            nextState = AddressFetch;
-            if (ce->drainState() == DrainState::Running)
-                fetchNextAddr(lastDescriptorAddr);
+        if (!busy()) {
+            fetchState = AddressFetch;
+            continueProcessing();
         } else
             refreshNext = true;
     } else if (cr.command.reset_dma()) {
-        if (busy)
+        if (busy()) {
             underReset = true;
-        else {
+            continueProcessing();
+        } else {
             cr.status.dma_transfer_status(3);
-            nextState = Idle;
         }
     } else if (cr.command.resume_dma() || cr.command.abort_dma() ||
             cr.command.suspend_dma())
@@ -246,7 +259,7 @@ CopyEngine::CopyEngineChannel::channelRead(Packet *pkt, Addr daddr, int size)
         break;
       case CHAN_STATUS:
         assert(size == sizeof(uint64_t));
-        pkt->set<uint64_t>(cr.status() | !busy);
+        pkt->set<uint64_t>(cr.status() | !busy());
         break;
       case CHAN_CHAINADDR:
         assert(size == sizeof(uint64_t) || size == sizeof(uint32_t));
@@ -437,6 +450,18 @@ CopyEngine::regStats()
         .desc("Number of copies processed by each engine")
         .flags(total)
         ;
+    descriptorsFetched
+        .init(regs.chanCount)
+        .name(name() + ".descriptors_fetched")
+        .desc("Number of descriptors fetched by each engine")
+        .flags(total)
+        ;
+    completionWrites
+        .init(regs.chanCount)
+        .name(name() + ".completion_writes")
+        .desc("Number of completion status writes by each engine")
+        .flags(total)
+        ;
 }
 
 void
@@ -447,15 +472,23 @@ CopyEngine::CopyEngineChannel::fetchDescriptor(Addr address)
     DPRINTF(DMACopyEngine, "Reading descriptor from at memory location %#x(%#x)\n",
            address, ce->platform->pciToDma(address));
     assert(address);
-    busy = true;
+    assert(ringCount < ring.size());
+
+    fetchSlot = slotIdx(ringCount++);
+    DescSlot &s = ring[fetchSlot];
+    s.addr = address;
+    s.state = SlotFetching;
+    s.reported = false;
+    fetchPending = true;
 
     DPRINTF(DMACopyEngine, "dmaAction: %#x, %d bytes, to addr %#x\n",
-            ce->platform->pciToDma(address), sizeof(DmaDesc), curDmaDesc);
+            ce->platform->pciToDma(address), sizeof(DmaDesc), &s.desc);
 
     cePort.dmaAction(MemCmd::ReadReq, ce->platform->pciToDma(address),
                      sizeof(DmaDesc), &fetchCompleteEvent,
-                     (uint8_t*)curDmaDesc, latBeforeBegin);
+                     (uint8_t*)&s.desc, latBeforeBegin);
     lastDescriptorAddr = address;
+    ce->descriptorsFetched[channelId]++;
 }
 
 void
@@ -463,41 +496,51 @@ CopyEngine::CopyEngineChannel::fetchDescComplete()
 {
     DPRINTF(DMACopyEngine, "Read of descriptor complete\n");
 
-    if ((curDmaDesc->command & DESC_CTRL_NULL)) {
+    DescSlot &s = ring[fetchSlot];
+    fetchPending = false;
+
+    if ((s.desc.command & DESC_CTRL_NULL)) {
         DPRINTF(DMACopyEngine, "Got NULL descriptor, skipping\n");
-        assert(!(curDmaDesc->command & DESC_CTRL_CP_STS));
-        if (curDmaDesc->command & DESC_CTRL_CP_STS) {
-            panic("Shouldn't be able to get here\n");
-            nextState = CompletionWrite;
-            if (inDrain()) return;
-            writeCompletionStatus();
-        } else {
-            anBegin("Idle");
-            anWait();
-            busy = false;
-            nextState = Idle;
-            inDrain();
-        }
+        if (s.desc.command & DESC_CTRL_CP_STS)
+            panic("NULL descriptor with completion status set\n");
+        // the descriptor that is fetched is always the youngest one
+        assert(fetchSlot == slotIdx(ringCount - 1));
+        ringCount--;
+        fetchState = FetchIdle;
+        continueProcessing();
         return;
     }
 
-    if (curDmaDesc->command & ~DESC_CTRL_CP_STS)
+    if (s.desc.command & ~DESC_CTRL_CP_STS)
         panic("Descriptor has flag other that completion status set\n");
+    if (s.desc.len > ce->params()->XferCap)
+        panic("Descriptor length %u exceeds the transfer cap\n", s.desc.len);
+
+    s.state = SlotFetched;
+    if (s.desc.next) {
+        fetchState = DescriptorFetch;
+        fetchAddress = s.desc.next;
+    } else
+        fetchState = FetchIdle;
 
-    nextState = DMARead;
-    if (inDrain()) return;
-    readCopyBytes();
+    continueProcessing();
 }
 
 void
-CopyEngine::CopyEngineChannel::readCopyBytes()
+CopyEngine::CopyEngineChannel::readCopyBytes(unsigned idx)
 {
+    DescSlot &s = ring[idx];
+
     anBegin("ReadCopyBytes");
     DPRINTF(DMACopyEngine, "Reading %d bytes from buffer to memory location %#x(%#x)\n",
-           curDmaDesc->len, curDmaDesc->dest,
-           ce->platform->pciToDma(curDmaDesc->src));
-    cePort.dmaAction(MemCmd::ReadReq, ce->platform->pciToDma(curDmaDesc->src),
-                     curDmaDesc->len, &readCompleteEvent, copyBuffer, 0);
+           s.desc.len, s.desc.dest,
+           ce->platform->pciToDma(s.desc.src));
+
+    readSlot = idx;
+    readPending = true;
+    s.state = SlotReading;
+    cePort.dmaAction(MemCmd::ReadReq, ce->platform->pciToDma(s.desc.src),
+                     s.desc.len, &readCompleteEvent, s.buffer, 0);
 }
 
 void
@@ -505,75 +548,170 @@ CopyEngine::CopyEngineChannel::readCopyBytesComplete()
 {
     DPRINTF(DMACopyEngine, "Read of bytes to copy complete\n");
 
-    nextState = DMAWrite;
-    if (inDrain()) return;
-    writeCopyBytes();
+    readPending = false;
+    ring[readSlot].state = SlotRead;
+    continueProcessing();
 }
 
 void
-CopyEngine::CopyEngineChannel::writeCopyBytes()
+CopyEngine::CopyEngineChannel::writeCopyBytes(unsigned idx)
 {
+    DescSlot &s = ring[idx];
+
     anBegin("WriteCopyBytes");
     DPRINTF(DMACopyEngine, "Writing %d bytes from buffer to memory location %#x(%#x)\n",
-           curDmaDesc->len, curDmaDesc->dest,
-           ce->platform->pciToDma(curDmaDesc->dest));
+           s.desc.len, s.desc.dest,
+           ce->platform->pciToDma(s.desc.dest));
 
-    cePort.dmaAction(MemCmd::WriteReq, ce->platform->pciToDma(curDmaDesc->dest),
-                     curDmaDesc->len, &writeCompleteEvent, copyBuffer, 0);
+    writeSlot = idx;
+    writePending = true;
+    s.state = SlotWriting;
+    cePort.dmaAction(MemCmd::WriteReq, ce->platform->pciToDma(s.desc.dest),
+                     s.desc.len, &writeCompleteEvent, s.buffer, 0);
 
-    ce->bytesCopied[channelId] += curDmaDesc->len;
+    ce->bytesCopied[channelId] += s.desc.len;
     ce->copiesProcessed[channelId]++;
 }
 
 void
 CopyEngine::CopyEngineChannel::writeCopyBytesComplete()
 {
+    DescSlot &s = ring[writeSlot];
+
     DPRINTF(DMACopyEngine, "Write of bytes to copy complete user1: %#x\n",
-            curDmaDesc->user1);
+            s.desc.user1);
 
-    cr.status.compl_desc_addr(lastDescriptorAddr >> 6);
+    writePending = false;
+    cr.status.compl_desc_addr(s.addr >> 6);
     completionDataReg = cr.status() | 1;
 
     anQ("DMAUsedDescQ", channelId, 1);
-    anQ("AppRecvQ", curDmaDesc->user1, curDmaDesc->len);
-    if (curDmaDesc->command & DESC_CTRL_CP_STS) {
-        nextState = CompletionWrite;
-        if (inDrain()) return;
-        writeCompletionStatus();
-        return;
+    anQ("AppRecvQ", s.desc.user1, s.desc.len);
+
+    s.state = SlotWritten;
+    if (s.desc.command & DESC_CTRL_CP_STS) {
+        // the descriptors before are reported by the same write
+        if (++pendingCompletions >= coalesceCompletions)
+            s.state = SlotCompleting;
     }
 
     continueProcessing();
 }
 
+bool
+CopyEngine::CopyEngineChannel::busy() const
+{
+    return ringCount > 0 || inFlight() || fetchState != FetchIdle ||
+           refreshNext || pendingCompletions > 0;
+}
+
+bool
+CopyEngine::CopyEngineChannel::inFlight() const
+{
+    return fetchPending || readPending || writePending || statusPending;
+}
+
+bool
+CopyEngine::CopyEngineChannel::hasMoreWork() const
+{
+    if (fetchPending || fetchState != FetchIdle || refreshNext)
+        return true;
+
+    for (unsigned i = 0; i < ringCount; i++) {
+        if (slot(i).state < SlotWritten)
+            return true;
+    }
+    return false;
+}
+
+bool
+CopyEngine::CopyEngineChannel::overlapsPendingWrite(unsigned i) const
+{
+    // don't read data that an older descriptor has yet to write
+    const DmaDesc &desc = slot(i).desc;
+    for (unsigned j = 0; j < i; j++) {
+        const DescSlot &s = slot(j);
+        if (s.state >= SlotWritten)
+            continue;
+        if (desc.src < s.desc.dest + s.desc.len &&
+            s.desc.dest < desc.src + desc.len)
+            return true;
+    }
+    return false;
+}
+
+void
+CopyEngine::CopyEngineChannel::retireDescriptors()
+{
+    while (ringCount > 0 && slot(0).state == SlotWritten) {
+        ringHead = (ringHead + 1) % ring.size();
+        ringCount--;
+    }
+}
+
 void
 CopyEngine::CopyEngineChannel::continueProcessing()
 {
-    busy = false;
+    retireDescriptors();
+
+    if (inDrain())
+        return;
 
     if (underReset) {
+        // the requests in flight can't be cancelled
+        if (inFlight())
+            return;
+
         anBegin("Reset");
         anWait();
         underReset = false;
         refreshNext = false;
-        busy = false;
-        nextState = Idle;
+        ringHead = ringCount = 0;
+        pendingCompletions = 0;
+        fetchState = FetchIdle;
         return;
     }
 
-    if (curDmaDesc->next) {
-        nextState = DescriptorFetch;
-        fetchAddress = curDmaDesc->next;
-        if (inDrain()) return;
-        fetchDescriptor(curDmaDesc->next);
-    } else if (refreshNext) {
-        nextState = AddressFetch;
-        refreshNext = false;
-        if (inDrain()) return;
-        fetchNextAddr(lastDescriptorAddr);
-    } else {
-        inDrain();
-        nextState = Idle;
+    // write the oldest descriptor that has been read. without pipelining,
+    // the write takes precedence over reading the next descriptor
+    unsigned i = 0;
+    while (i < ringCount && slot(i).state >= SlotWritten)
+        i++;
+    if (i < ringCount && slot(i).state == SlotRead && !writePending &&
+        (pipeline || !readPending))
+        writeCopyBytes(slotIdx(i));
+
+    // read the oldest descriptor that has been fetched
+    while (i < ringCount && slot(i).state > SlotFetched)
+        i++;
+    if (i < ringCount && slot(i).state == SlotFetched && !readPending &&
+        (pipeline || !writePending) && !overlapsPendingWrite(i))
+        readCopyBytes(slotIdx(i));
+
+    // write the status if enough descriptors wait for it or if nothing
+    // else will trigger it anymore
+    if (!statusPending && pendingCompletions > 0) {
+        bool due = !hasMoreWork();
+        for (unsigned j = 0; !due && j < ringCount; j++)
+            due = slot(j).state == SlotCompleting;
+        if (due)
+            writeCompletionStatus();
+    }
+
+    // fill up the ring
+    if (!fetchPending && ringCount < ring.size()) {
+        if (fetchState == FetchIdle && refreshNext) {
+            fetchState = AddressFetch;
+            refreshNext = false;
+        }
+
+        if (fetchState == DescriptorFetch)
+            fetchDescriptor(fetchAddress);
+        else if (fetchState == AddressFetch)
+            fetchNextAddr(lastDescriptorAddr);
+    }
+
+    if (!busy()) {
         anWait();
         anBegin("Idle");
     }
@@ -583,20 +721,41 @@ void
 CopyEngine::CopyEngineChannel::writeCompletionStatus()
 {
     anBegin("WriteCompletionStatus");
+
+    // the status covers all descriptors that have been written so far
+    for (unsigned i = 0; i < ringCount; i++) {
+        if (slot(i).state == SlotCompleting)
+            slot(i).reported = true;
+    }
+    completionWriteData = completionDataReg;
+    pendingCompletions = 0;
+    statusPending = true;
+
     DPRINTF(DMACopyEngine, "Writing completion status %#x to address %#x(%#x)\n",
-            completionDataReg, cr.completionAddr,
+            completionWriteData, cr.completionAddr,
             ce->platform->pciToDma(cr.completionAddr));
 
     cePort.dmaAction(MemCmd::WriteReq,
                      ce->platform->pciToDma(cr.completionAddr),
-                     sizeof(completionDataReg), &statusCompleteEvent,
-                     (uint8_t*)&completionDataReg, latAfterCompletion);
+                     sizeof(completionWriteData), &statusCompleteEvent,
+                     (uint8_t*)&completionWriteData, latAfterCompletion);
+    ce->completionWrites[channelId]++;
 }
 
 void
 CopyEngine::CopyEngineChannel::writeStatusComplete()
 {
     DPRINTF(DMACopyEngine, "Writing completion status complete\n");
+
+    statusPending = false;
+    for (unsigned i = 0; i < ringCount; i++) {
+        DescSlot &s = slot(i);
+        if (s.reported) {
+            s.state = SlotWritten;
+            s.reported = false;
+        }
+    }
+
     continueProcessing();
 }
 
@@ -605,48 +764,47 @@ CopyEngine::CopyEngineChannel::fetchNextAddr(Addr address)
 {
     anBegin("FetchNextAddr");
     DPRINTF(DMACopyEngine, "Fetching next address...\n");
-    busy = true;
+    fetchPending = true;
     cePort.dmaAction(MemCmd::ReadReq,
                      ce->platform->pciToDma(address + offsetof(DmaDesc, next)),
                      sizeof(Addr), &addrCompleteEvent,
-                     (uint8_t*)curDmaDesc + offsetof(DmaDesc, next), 0);
+                     (uint8_t*)&nextAddress, 0);
 }
 
 void
 CopyEngine::CopyEngineChannel::fetchAddrComplete()
 {
     DPRINTF(DMACopyEngine, "Fetching next address complete: %#x\n",
-            curDmaDesc->next);
-    if (!curDmaDesc->next) {
+            nextAddress);
+
+    fetchPending = false;
+    if (!nextAddress) {
         DPRINTF(DMACopyEngine, "Got NULL descriptor, nothing more to do\n");
-        busy = false;
-        nextState = Idle;
-        anWait();
-        anBegin("Idle");
-        inDrain();
-        return;
+        fetchState = FetchIdle;
+    } else {
+        fetchState = DescriptorFetch;
+        fetchAddress = nextAddress;
     }
-    nextState = DescriptorFetch;
-    fetchAddress = curDmaDesc->next;
-    if (inDrain()) return;
-    fetchDescriptor(curDmaDesc->next);
+
+    continueProcessing();
 }
 
 bool
 CopyEngine::CopyEngineChannel::inDrain()
 {
-    if (drainState() == DrainState::Draining) {
+    // wait for the requests in flight before reporting that we're drained
+    if (drainState() == DrainState::Draining && !inFlight()) {
         DPRINTF(Drain, "CopyEngine done draining, processing drain event\n");
         signalDrainDone();
     }
 
-    return ce->drainState() != DrainState::Running;
+    return drainState() != DrainState::Running;
 }
 
 DrainState
 CopyEngine::CopyEngineChannel::drain()
 {
-    if (nextState == Idle || ce->drainState() != DrainState::Running) {
+    if (!inFlight()) {
         return DrainState::Drained;
     } else {
         DPRINTF(Drain, "CopyEngineChannel not drained\n");
@@ -675,17 +833,27 @@ CopyEngine::unserialize(CheckpointIn &cp)
 void
 CopyEngine::CopyEngineChannel::serialize(CheckpointOut &cp) const
 {
+    // no DMA request is in flight in a drained channel
+    assert(!inFlight());
+
     SERIALIZE_SCALAR(channelId);
-    SERIALIZE_SCALAR(busy);
     SERIALIZE_SCALAR(underReset);
     SERIALIZE_SCALAR(refreshNext);
     SERIALIZE_SCALAR(lastDescriptorAddr);
     SERIALIZE_SCALAR(completionDataReg);
     SERIALIZE_SCALAR(fetchAddress);
-    int nextState = this->nextState;
-    SERIALIZE_SCALAR(nextState);
-    arrayParamOut(cp, "curDmaDesc", (uint8_t*)curDmaDesc, sizeof(DmaDesc));
-    SERIALIZE_ARRAY(copyBuffer, ce->params()->XferCap);
+    int fetchState = this->fetchState;
+    SERIALIZE_SCALAR(fetchState);
+    SERIALIZE_SCALAR(pendingCompletions);
+    SERIALIZE_SCALAR(ringCount);
+    for (unsigned i = 0; i < ringCount; i++) {
+        const DescSlot &s = slot(i);
+        ScopedCheckpointSection sec(cp, csprintf("slot%d", i));
+        paramOut(cp, "addr", s.addr);
+        paramOut(cp, "state", (int)s.state);
+        arrayParamOut(cp, "desc", (uint8_t*)&s.desc, sizeof(DmaDesc));
+        arrayParamOut(cp, "buffer", s.buffer, ce->params()->XferCap);
+    }
     cr.serialize(cp);
 
 }
@@ -693,52 +861,41 @@ void
 CopyEngine::CopyEngineChannel::unserialize(CheckpointIn &cp)
 {
     UNSERIALIZE_SCALAR(channelId);
-    UNSERIALIZE_SCALAR(busy);
     UNSERIALIZE_SCALAR(underReset);
     UNSERIALIZE_SCALAR(refreshNext);
     UNSERIALIZE_SCALAR(lastDescriptorAddr);
     UNSERIALIZE_SCALAR(completionDataReg);
     UNSERIALIZE_SCALAR(fetchAddress);
-    int nextState;
-    UNSERIALIZE_SCALAR(nextState);
-    this->nextState = (ChannelState)nextState;
-    arrayParamIn(cp, "curDmaDesc", (uint8_t*)curDmaDesc, sizeof(DmaDesc));
-    UNSERIALIZE_ARRAY(copyBuffer, ce->params()->XferCap);
+    int fetchState;
+    UNSERIALIZE_SCALAR(fetchState);
+    this->fetchState = (FetchState)fetchState;
+    UNSERIALIZE_SCALAR(pendingCompletions);
+    UNSERIALIZE_SCALAR(ringCount);
+    fatal_if(ringCount > ring.size(),
+             "%s: checkpoint has %u descriptors, but only %u slots\n",
+             name(), ringCount, ring.size());
+    ringHead = 0;
+    for (unsigned i = 0; i < ringCount; i++) {
+        DescSlot &s = slot(i);
+        ScopedCheckpointSection sec(cp, csprintf("slot%d", i));
+        paramIn(cp, "addr", s.addr);
+        int state;
+        paramIn(cp, "state", state);
+        s.state = (SlotState)state;
+        s.reported = false;
+        arrayParamIn(cp, "desc", (uint8_t*)&s.desc, sizeof(DmaDesc));
+        arrayParamIn(cp, "buffer", s.buffer, ce->params()->XferCap);
+    }
     cr.unserialize(cp);
 
 }
 
-void
-CopyEngine::CopyEngineChannel::restartStateMachine()
-{
-    switch(nextState) {
-      case AddressFetch:
-        fetchNextAddr(lastDescriptorAddr);
-        break;
-      case DescriptorFetch:
-        fetchDescriptor(fetchAddress);
-        break;
-      case DMARead:
-        readCopyBytes();
-        break;
-      case DMAWrite:
-        writeCopyBytes();
-        break;
-      case CompletionWrite:
-        writeCompletionStatus();
-        break;
-      case Idle:
-        break;
-      default:
-        panic("Unknown state for CopyEngineChannel\n");
-    }
-}
-
 void
 CopyEngine::CopyEngineChannel::drainResume()
 {
-    DPRINTF(DMACopyEngine, "Restarting state machine at state %d\n", nextState);
-    restartStateMachine();
+    DPRINTF(DMACopyEngine, "Restarting state machine with %u descriptors\n",
+            ringCount);
+    continueProcessing();
 }
 
 CopyEngine *
@@ -67,30 +67,74 @@ class CopyEngine : public PciDevice
         CopyEngine *ce;
         CopyEngineReg::ChanRegs  cr;
         int channelId;
-        CopyEngineReg::DmaDesc *curDmaDesc;
-        uint8_t *copyBuffer;
 
-        bool busy;
         bool underReset;
         bool refreshNext;
         Addr lastDescriptorAddr;
         Addr fetchAddress;
+        Addr nextAddress;
 
         Tick latBeforeBegin;
         Tick latAfterCompletion;
 
         uint64_t completionDataReg;
+        uint64_t completionWriteData;
 
-        enum ChannelState {
-            Idle,
+        enum FetchState {
+            FetchIdle,
             AddressFetch,
-            DescriptorFetch,
-            DMARead,
-            DMAWrite,
-            CompletionWrite
+            DescriptorFetch
         };
 
-        ChannelState nextState;
+        enum SlotState {
+            SlotFetching,
+            SlotFetched,
+            SlotReading,
+            SlotRead,
+            SlotWriting,
+            SlotWritten,
+            SlotCompleting
+        };
+
+        /**
+         * A descriptor in the ring along with its copy buffer. The slots
+         * pass the states in order, so that older slots are always at
+         * least as far as younger ones.
+         */
+        struct DescSlot {
+            Addr addr;
+            CopyEngineReg::DmaDesc desc;
+            uint8_t *buffer;
+            SlotState state;
+            /** Reported by the completion write that is in flight */
+            bool reported;
+        };
+
+        /**
+         * Ring of DescPrefetch descriptors. The descriptor fetch, the DMA
+         * read, the DMA write and the completion write are separate
+         * stages that can work on different slots at the same time. With
+         * a single slot, this is the classic fetch-read-write-complete
+         * state machine.
+         */
+        std::vector<DescSlot> ring;
+        unsigned ringHead;
+        unsigned ringCount;
+
+        FetchState fetchState;
+        bool fetchPending;
+        bool readPending;
+        bool writePending;
+        bool statusPending;
+        unsigned fetchSlot;
+        unsigned readSlot;
+        unsigned writeSlot;
+
+        /** Written descriptors that requested a completion write */
+        unsigned pendingCompletions;
+
+        const bool pipeline;
+        const unsigned coalesceCompletions;
 
       public:
         CopyEngineChannel(CopyEngine *_ce, int cid);
@@ -123,12 +167,12 @@ class CopyEngine : public PciDevice
         EventWrapper<CopyEngineChannel, &CopyEngineChannel::fetchAddrComplete>
             addrCompleteEvent;
 
-        void readCopyBytes();
+        void readCopyBytes(unsigned idx);
         void readCopyBytesComplete();
         EventWrapper<CopyEngineChannel, &CopyEngineChannel::readCopyBytesComplete>
             readCompleteEvent;
 
-        void writeCopyBytes();
+        void writeCopyBytes(unsigned idx);
         void writeCopyBytesComplete();
         EventWrapper <CopyEngineChannel, &CopyEngineChannel::writeCopyBytesComplete>
             writeCompleteEvent;
@@ -139,10 +183,21 @@ class CopyEngine : public PciDevice
             statusCompleteEvent;
 
 
+        /** The i-th oldest descriptor in the ring */
+        unsigned slotIdx(unsigned i) const
+        { return (ringHead + i) % ring.size(); }
+        DescSlot &slot(unsigned i) { return ring[slotIdx(i)]; }
+        const DescSlot &slot(unsigned i) const { return ring[slotIdx(i)]; }
+
+        bool busy() const;
+        bool inFlight() const;
+        bool hasMoreWork() const;
+        bool overlapsPendingWrite(unsigned i) const;
+        void retireDescriptors();
+
         void continueProcessing();
         void recvCommand();
         bool inDrain();
-        void restartStateMachine();
         inline void anBegin(const char *s)
         {
             CPA::cpa()->hwBegin(CPA::FL_NONE, ce->sys,
@@ -179,6 +234,8 @@ class CopyEngine : public PciDevice
 
     Stats::Vector bytesCopied;
     Stats::Vector copiesProcessed;
+    Stats::Vector descriptorsFetched;
+    Stats::Vector completionWrites;
 
     // device registers
     CopyEngineReg::Regs regs;
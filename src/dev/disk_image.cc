@@ -32,10 +32,14 @@
  * Disk Image Definitions
  */
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <fstream>
@@ -43,6 +47,7 @@
 
 #include "base/callback.hh"
 #include "base/misc.hh"
+#include "base/output.hh"
 #include "base/trace.hh"
 #include "debug/DiskImageRead.hh"
 #include "debug/DiskImageWrite.hh"
@@ -52,12 +57,47 @@
 
 using namespace std;
 
+////////////////////////////////////////////////////////////////////////
+//
+// Disk image
+//
+std::streampos
+DiskImage::readSectors(uint8_t *data, std::streampos offset,
+                       unsigned count) const
+{
+    std::streamoff bytes = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        std::streamoff res = read(data + i * SectorSize, offset + i);
+        bytes += res;
+        if (res != SectorSize)
+            break;
+    }
+    return bytes;
+}
+
+std::streampos
+DiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                        unsigned count)
+{
+    std::streamoff bytes = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        std::streamoff res = write(data + i * SectorSize, offset + i);
+        bytes += res;
+        if (res != SectorSize)
+            break;
+    }
+    return bytes;
+}
+
 ////////////////////////////////////////////////////////////////////////
 //
 // Raw Disk image
 //
 RawDiskImage::RawDiskImage(const Params* p)
-    : DiskImage(p), disk_size(0)
+    : DiskImage(p), disk_size(0), useMmap(p->mmap),
+      readAhead(p->read_ahead), dropBehind(p->drop_behind), fd(-1),
+      map(NULL), pageSize(sysconf(_SC_PAGESIZE)), seqEnd(0), raEnd(0),
+      dropEnd(0)
 { open(p->image_file, p->read_only); }
 
 RawDiskImage::~RawDiskImage()
@@ -71,6 +111,32 @@ RawDiskImage::open(const string &filename, bool rd_only)
         readonly = rd_only;
         file = filename;
 
+        if (useMmap) {
+            fd = ::open(file.c_str(), readonly ? O_RDONLY : O_RDWR);
+            if (fd == -1)
+                panic("Error opening %s: %s", filename, strerror(errno));
+
+            struct stat st;
+            if (fstat(fd, &st) == -1)
+                panic("Unable to stat %s: %s", filename, strerror(errno));
+            if (st.st_size == 0)
+                panic("Cannot map the empty image %s", filename);
+            disk_size = st.st_size;
+
+            // a private mapping leaves read-only images untouched
+            int prot = readonly ? PROT_READ : PROT_READ | PROT_WRITE;
+            int flags = readonly ? MAP_PRIVATE : MAP_SHARED;
+            void *addr = mmap(NULL, st.st_size, prot, flags, fd, 0);
+            if (addr == MAP_FAILED)
+                panic("Unable to map %s: %s", filename, strerror(errno));
+            map = static_cast<uint8_t*>(addr);
+
+            // we do the read-ahead ourselves
+            if (readAhead > 0)
+                madvise(map, st.st_size, MADV_RANDOM);
+            return;
+        }
+
         ios::openmode mode = ios::in | ios::binary;
         if (!readonly)
             mode |= ios::out;
@@ -83,6 +149,14 @@ RawDiskImage::open(const string &filename, bool rd_only)
 void
 RawDiskImage::close()
 {
+    if (map) {
+        munmap(map, (std::streamoff)disk_size);
+        map = NULL;
+    }
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
     stream.close();
 }
 
@@ -99,30 +173,93 @@ RawDiskImage::size() const
     return disk_size / SectorSize;
 }
 
+void
+RawDiskImage::prefetch(uint64_t start, uint64_t len) const
+{
+    uint64_t end = start + len;
+    uint64_t size = (std::streamoff)disk_size;
+
+    // only sequential accesses are worth reading ahead
+    bool sequential = start == seqEnd;
+    seqEnd = end;
+    if (!sequential) {
+        raEnd = end;
+        return;
+    }
+
+    // extend the window as soon as half of it has been consumed
+    if (readAhead > 0 && end + readAhead / 2 > raEnd) {
+        uint64_t raStart = std::max(raEnd, end) & ~(pageSize - 1);
+        raEnd = std::min(end + readAhead, size);
+        if (raEnd > raStart)
+            madvise(map + raStart, raEnd - raStart, MADV_WILLNEED);
+    }
+
+    // drop the pages we streamed through from the host page cache
+    if (dropBehind) {
+        uint64_t dropTo = start & ~(pageSize - 1);
+        if (dropTo > dropEnd) {
+            madvise(map + dropEnd, dropTo - dropEnd, MADV_DONTNEED);
+            posix_fadvise(fd, dropEnd, dropTo - dropEnd,
+                          POSIX_FADV_DONTNEED);
+            dropEnd = dropTo;
+        }
+    }
+}
+
 std::streampos
 RawDiskImage::read(uint8_t *data, std::streampos offset) const
+{
+    return readSectors(data, offset, 1);
+}
+
+std::streampos
+RawDiskImage::readSectors(uint8_t *data, std::streampos offset,
+                          unsigned count) const
 {
     if (!initialized)
         panic("RawDiskImage not initialized");
 
-    if (!stream.is_open())
-        panic("file not open!\n");
+    uint64_t start = (std::streamoff)offset * SectorSize;
+    std::streamoff len = (std::streamoff)count * SectorSize;
 
-    stream.seekg(offset * SectorSize, ios::beg);
-    if (!stream.good())
-        panic("Could not seek to location in file");
+    if (map) {
+        uint64_t size = (std::streamoff)disk_size;
+        if (start >= size)
+            return 0;
+
+        len = std::min<uint64_t>(len, size - start);
+        prefetch(start, len);
+        memcpy(data, map + start, len);
+    } else {
+        if (!stream.is_open())
+            panic("file not open!\n");
 
-    streampos pos = stream.tellg();
-    stream.read((char *)data, SectorSize);
+        stream.seekg(start, ios::beg);
+        if (!stream.good())
+            panic("Could not seek to location in file");
 
-    DPRINTF(DiskImageRead, "read: offset=%d\n", (uint64_t)offset);
-    DDUMP(DiskImageRead, data, SectorSize);
+        streampos pos = stream.tellg();
+        stream.read((char *)data, len);
+        len = stream.tellg() - pos;
+    }
 
-    return stream.tellg() - pos;
+    DPRINTF(DiskImageRead, "read: offset=%d count=%d\n",
+            (uint64_t)offset, count);
+    DDUMP(DiskImageRead, data, count * SectorSize);
+
+    return len;
 }
 
 std::streampos
 RawDiskImage::write(const uint8_t *data, std::streampos offset)
+{
+    return writeSectors(data, offset, 1);
+}
+
+std::streampos
+RawDiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                           unsigned count)
 {
     if (!initialized)
         panic("RawDiskImage not initialized");
@@ -130,18 +267,33 @@ RawDiskImage::write(const uint8_t *data, std::streampos offset)
     if (readonly)
         panic("Cannot write to a read only disk image");
 
+    uint64_t start = (std::streamoff)offset * SectorSize;
+    std::streamoff len = (std::streamoff)count * SectorSize;
+
+    DPRINTF(DiskImageWrite, "write: offset=%d count=%d\n",
+            (uint64_t)offset, count);
+    DDUMP(DiskImageWrite, data, count * SectorSize);
+
+    if (map) {
+        // the mapping cannot grow
+        uint64_t size = (std::streamoff)disk_size;
+        if (start >= size)
+            return 0;
+
+        len = std::min<uint64_t>(len, size - start);
+        memcpy(map + start, data, len);
+        return len;
+    }
+
     if (!stream.is_open())
         panic("file not open!\n");
 
-    stream.seekp(offset * SectorSize, ios::beg);
+    stream.seekp(start, ios::beg);
     if (!stream.good())
         panic("Could not seek to location in file");
 
-    DPRINTF(DiskImageWrite, "write: offset=%d\n", (uint64_t)offset);
-    DDUMP(DiskImageWrite, data, SectorSize);
-
     streampos pos = stream.tellp();
-    stream.write((const char *)data, SectorSize);
+    stream.write((const char *)data, len);
     return stream.tellp() - pos;
 }
 
@@ -169,8 +321,18 @@ class CowDiskCallback : public Callback
 };
 
 CowDiskImage::CowDiskImage(const Params *p)
-    : DiskImage(p), filename(p->image_file), child(p->child), table(NULL)
+    : DiskImage(p), filename(p->image_file), child(p->child), table(NULL),
+      sparseFile(p->sparse_file), sparseFd(-1), index(NULL)
 {
+    if (!sparseFile.empty()) {
+        // the overlay only lives as long as the simulation
+        sparseFile = simout.resolve(sparseFile);
+        sparseFd = ::open(sparseFile.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+                          0644);
+        if (sparseFd == -1)
+            panic("Error opening %s: %s", sparseFile, strerror(errno));
+    }
+
     if (filename.empty()) {
         initSectorTable(p->table_size);
     } else {
@@ -187,12 +349,94 @@ CowDiskImage::CowDiskImage(const Params *p)
 
 CowDiskImage::~CowDiskImage()
 {
-    SectorTable::iterator i = table->begin();
-    SectorTable::iterator end = table->end();
+    if (table) {
+        SectorTable::iterator i = table->begin();
+        SectorTable::iterator end = table->end();
 
-    while (i != end) {
-        delete (*i).second;
-        ++i;
+        while (i != end) {
+            delete (*i).second;
+            ++i;
+        }
+        delete table;
+    }
+
+    delete index;
+    if (sparseFd != -1)
+        ::close(sparseFd);
+}
+
+void
+CowDiskImage::clearSectors(size_t hash_size)
+{
+    if (sparseFd != -1) {
+        delete index;
+        index = new SectorIndex(hash_size);
+        if (ftruncate(sparseFd, 0) == -1)
+            panic("Unable to truncate %s: %s", sparseFile, strerror(errno));
+    } else {
+        if (table) {
+            for (auto &sec : *table)
+                delete sec.second;
+            delete table;
+        }
+        table = new SectorTable(hash_size);
+    }
+}
+
+bool
+CowDiskImage::contains(uint64_t sector) const
+{
+    if (index)
+        return index->find(sector) != index->end();
+    return table->find(sector) != table->end();
+}
+
+bool
+CowDiskImage::lookup(uint64_t sector, uint8_t *data) const
+{
+    if (index) {
+        if (index->find(sector) == index->end())
+            return false;
+
+        ssize_t res = pread(sparseFd, data, SectorSize,
+                            sector * SectorSize);
+        if (res != SectorSize)
+            panic("Unable to read sector %llu from %s: %s",
+                  sector, sparseFile, strerror(errno));
+        return true;
+    }
+
+    SectorTable::const_iterator i = table->find(sector);
+    if (i == table->end())
+        return false;
+
+    memcpy(data, (*i).second->data, SectorSize);
+    return true;
+}
+
+void
+CowDiskImage::store(uint64_t sector, const uint8_t *data, unsigned count)
+{
+    if (index) {
+        ssize_t len = (ssize_t)count * SectorSize;
+        if (pwrite(sparseFd, data, len, sector * SectorSize) != len)
+            panic("Unable to write sector %llu to %s: %s",
+                  sector, sparseFile, strerror(errno));
+
+        for (unsigned i = 0; i < count; ++i)
+            index->insert(sector + i);
+        return;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        SectorTable::iterator it = table->find(sector + i);
+        if (it == table->end()) {
+            Sector *s = new Sector;
+            memcpy(s, data + i * SectorSize, SectorSize);
+            table->insert(make_pair(sector + i, s));
+        } else {
+            memcpy((*it).second->data, data + i * SectorSize, SectorSize);
+        }
     }
 }
 
@@ -251,18 +495,17 @@ CowDiskImage::open(const string &file)
 
     uint64_t sector_count;
     SafeReadSwap(stream, sector_count);
-    table = new SectorTable(sector_count);
-
+    clearSectors(sector_count);
 
     for (uint64_t i = 0; i < sector_count; i++) {
         uint64_t offset;
         SafeReadSwap(stream, offset);
 
-        Sector *sector = new Sector;
-        SafeRead(stream, sector, sizeof(Sector));
+        Sector sector;
+        SafeRead(stream, &sector, sizeof(Sector));
 
-        assert(table->find(offset) == table->end());
-        (*table)[offset] = sector;
+        assert(!contains(offset));
+        store(offset, sector.data, 1);
     }
 
     stream.close();
@@ -274,7 +517,7 @@ CowDiskImage::open(const string &file)
 void
 CowDiskImage::initSectorTable(int hash_size)
 {
-    table = new SectorTable(hash_size);
+    clearSectors(hash_size);
 
     initialized = true;
 }
@@ -329,6 +572,21 @@ CowDiskImage::save(const string &file) const
 
     SafeWriteSwap(stream, (uint32_t)VersionMajor);
     SafeWriteSwap(stream, (uint32_t)VersionMinor);
+
+    if (index) {
+        SafeWriteSwap(stream, (uint64_t)index->size());
+
+        Sector sector;
+        for (uint64_t offset : *index) {
+            lookup(offset, sector.data);
+            SafeWriteSwap(stream, offset);
+            SafeWrite(stream, sector.data, sizeof(Sector));
+        }
+
+        stream.close();
+        return;
+    }
+
     SafeWriteSwap(stream, (uint64_t)table->size());
 
     uint64_t size = table->size();
@@ -350,6 +608,15 @@ CowDiskImage::save(const string &file) const
 void
 CowDiskImage::writeback()
 {
+    if (index) {
+        Sector sector;
+        for (uint64_t offset : *index) {
+            lookup(offset, sector.data);
+            child->write(sector.data, offset);
+        }
+        return;
+    }
+
     SectorTable::iterator i = table->begin();
     SectorTable::iterator end = table->end();
 
@@ -365,6 +632,13 @@ CowDiskImage::size() const
 
 std::streampos
 CowDiskImage::read(uint8_t *data, std::streampos offset) const
+{
+    return readSectors(data, offset, 1);
+}
+
+std::streampos
+CowDiskImage::readSectors(uint8_t *data, std::streampos offset,
+                          unsigned count) const
 {
     if (!initialized)
         panic("CowDiskImage not initialized");
@@ -372,19 +646,43 @@ CowDiskImage::read(uint8_t *data, std::streampos offset) const
     if (offset > size())
         panic("access out of bounds");
 
-    SectorTable::const_iterator i = table->find(offset);
-    if (i == table->end())
-        return child->read(data, offset);
-    else {
-        memcpy(data, (*i).second->data, SectorSize);
-        DPRINTF(DiskImageRead, "read: offset=%d\n", (uint64_t)offset);
-        DDUMP(DiskImageRead, data, SectorSize);
-        return SectorSize;
+    uint64_t first = (std::streamoff)offset;
+    std::streamoff bytes = 0;
+    unsigned i = 0;
+    while (i < count) {
+        uint8_t *dst = data + i * SectorSize;
+        if (lookup(first + i, dst)) {
+            DPRINTF(DiskImageRead, "read: offset=%d\n", first + i);
+            DDUMP(DiskImageRead, dst, SectorSize);
+            bytes += SectorSize;
+            i++;
+            continue;
+        }
+
+        // read the following unmodified sectors from the child at once
+        unsigned j = i + 1;
+        while (j < count && !contains(first + j))
+            j++;
+
+        std::streamoff res = child->readSectors(dst, first + i, j - i);
+        bytes += res;
+        if (res != (std::streamoff)(j - i) * SectorSize)
+            break;
+        i = j;
     }
+
+    return bytes;
 }
 
 std::streampos
 CowDiskImage::write(const uint8_t *data, std::streampos offset)
+{
+    return writeSectors(data, offset, 1);
+}
+
+std::streampos
+CowDiskImage::writeSectors(const uint8_t *data, std::streampos offset,
+                           unsigned count)
 {
     if (!initialized)
         panic("RawDiskImage not initialized");
@@ -392,19 +690,13 @@ CowDiskImage::write(const uint8_t *data, std::streampos offset)
     if (offset > size())
         panic("access out of bounds");
 
-    SectorTable::iterator i = table->find(offset);
-    if (i == table->end()) {
-        Sector *sector = new Sector;
-        memcpy(sector, data, SectorSize);
-        table->insert(make_pair(offset, sector));
-    } else {
-        memcpy((*i).second->data, data, SectorSize);
-    }
+    store((std::streamoff)offset, data, count);
 
-    DPRINTF(DiskImageWrite, "write: offset=%d\n", (uint64_t)offset);
-    DDUMP(DiskImageWrite, data, SectorSize);
+    DPRINTF(DiskImageWrite, "write: offset=%d count=%d\n",
+            (uint64_t)offset, count);
+    DDUMP(DiskImageWrite, data, count * SectorSize);
 
-    return SectorSize;
+    return (std::streamoff)count * SectorSize;
 }
 
 void
@@ -64,10 +64,25 @@ class DiskImage : public SimObject
                                 std::streampos offset) const = 0;
     virtual std::streampos write(const uint8_t *data,
                                  std::streampos offset) = 0;
+
+    /**
+     * Read/write count consecutive sectors starting at sector offset. The
+     * default implementation accesses one sector at a time.
+     * @return the number of bytes read/written
+     */
+    virtual std::streampos readSectors(uint8_t *data, std::streampos offset,
+                                       unsigned count) const;
+    virtual std::streampos writeSectors(const uint8_t *data,
+                                        std::streampos offset,
+                                        unsigned count);
 };
 
 /**
- * Specialization for accessing a raw disk image
+ * Specialization for accessing a raw disk image. The file is either
+ * accessed via a stream or mapped into memory. With the mapping,
+ * sequential reads let the host read ahead by the given amount and,
+ * optionally, drop the pages behind the stream from the host page cache
+ * again, so that streaming a large image does not evict everything else.
  */
 class RawDiskImage : public DiskImage
 {
@@ -77,6 +92,20 @@ class RawDiskImage : public DiskImage
     bool readonly;
     mutable std::streampos disk_size;
 
+    const bool useMmap;
+    const uint64_t readAhead;
+    const bool dropBehind;
+    int fd;
+    uint8_t *map;
+    uint64_t pageSize;
+    // the end of the last access and of the read-ahead window (in bytes)
+    mutable uint64_t seqEnd;
+    mutable uint64_t raEnd;
+    // everything below has been dropped from the page cache
+    mutable uint64_t dropEnd;
+
+    void prefetch(uint64_t start, uint64_t len) const;
+
   public:
     typedef RawDiskImageParams Params;
     RawDiskImage(const Params *p);
@@ -89,6 +118,11 @@ class RawDiskImage : public DiskImage
 
     virtual std::streampos read(uint8_t *data, std::streampos offset) const;
     virtual std::streampos write(const uint8_t *data, std::streampos offset);
+
+    std::streampos readSectors(uint8_t *data, std::streampos offset,
+                               unsigned count) const M5_ATTR_OVERRIDE;
+    std::streampos writeSectors(const uint8_t *data, std::streampos offset,
+                                unsigned count) M5_ATTR_OVERRIDE;
 };
 
 /**
@@ -100,6 +134,10 @@ class RawDiskImage : public DiskImage
  * This object is designed to provide a mechanism for persistant
  * changes to a main disk image, or to provide a place for temporary
  * changes to the image to take place that later may be thrown away.
+ *
+ * The written sectors are either kept in memory or, if a sparse file is
+ * given, stored in that file at their position in the image. In the latter
+ * case, only the set of written sectors is kept in memory.
  */
 class CowDiskImage : public DiskImage
 {
@@ -112,12 +150,22 @@ class CowDiskImage : public DiskImage
         uint8_t data[SectorSize];
     };
     typedef m5::hash_map<uint64_t, Sector *> SectorTable;
+    typedef m5::hash_set<uint64_t> SectorIndex;
 
   protected:
     std::string filename;
     DiskImage *child;
     SectorTable *table;
 
+    std::string sparseFile;
+    int sparseFd;
+    SectorIndex *index;
+
+    bool contains(uint64_t sector) const;
+    bool lookup(uint64_t sector, uint8_t *data) const;
+    void store(uint64_t sector, const uint8_t *data, unsigned count);
+    void clearSectors(size_t hash_size);
+
   public:
     typedef CowDiskImageParams Params;
     CowDiskImage(const Params *p);
@@ -136,6 +184,11 @@ class CowDiskImage : public DiskImage
 
     virtual std::streampos read(uint8_t *data, std::streampos offset) const;
     virtual std::streampos write(const uint8_t *data, std::streampos offset);
+
+    std::streampos readSectors(uint8_t *data, std::streampos offset,
+                               unsigned count) const M5_ATTR_OVERRIDE;
+    std::streampos writeSectors(const uint8_t *data, std::streampos offset,
+                                unsigned count) M5_ATTR_OVERRIDE;
 };
 
 void SafeRead(std::ifstream &stream, void *data, int count);
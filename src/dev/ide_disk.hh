@@ -336,8 +336,8 @@ class IdeDisk : public SimObject
     EventWrapper<IdeDisk, &IdeDisk::dmaWriteDone> dmaWriteEvent;
 
     // Disk image read/write
-    void readDisk(uint32_t sector, uint8_t *data);
-    void writeDisk(uint32_t sector, uint8_t *data);
+    void readDisk(uint32_t sector, uint8_t *data, unsigned count = 1);
+    void writeDisk(uint32_t sector, uint8_t *data, unsigned count = 1);
 
     // State machine management
     void updateState(DevAction_t action);
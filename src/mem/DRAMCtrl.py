@@ -62,6 +62,12 @@ class AddrMap(Enum): vals = ['RoRaBaChCo', 'RoRaBaCoCh', 'RoCoRaBaCh']
 class PageManage(Enum): vals = ['open', 'open_adaptive', 'close',
                                 'close_adaptive']
 
+# Enum for the energy model, either DRAMPower, which records all
+# commands and replays them at every refresh, or the built-in analytic
+# model that follows the same equations, but accumulates the energy as
+# the commands are issued.
+class DRAMPowerModel(Enum): vals = ['drampower', 'analytic']
+
 # DRAMCtrl is a single-channel single-ported DRAM controller model
 # that aims to model the most important system-level performance
 # effects of a DRAM without getting into too much detail of the DRAM
@@ -98,6 +104,11 @@ class DRAMCtrl(AbstractMemory):
     addr_mapping = Param.AddrMap('RoRaBaCoCh', "Address mapping policy")
     page_policy = Param.PageManage('open_adaptive', "Page management policy")
 
+    # measuring the host time of the scheduler makes the stats
+    # nondeterministic and is therefore only done on request
+    sched_host_time = Param.Bool(False, "Report the host time spent in "
+                                 "the scheduler")
+
     # enforce a limit on the number of accesses per row
     max_accesses_per_row = Param.Unsigned(16, "Max accesses per row before "
                                           "closing");
@@ -134,6 +145,8 @@ class DRAMCtrl(AbstractMemory):
     # For power modelling we need to know if the DRAM has a DLL or not
     dll = Param.Bool(True, "DRAM has DLL or not")
 
+    power_model = Param.DRAMPowerModel('drampower', "DRAM energy model")
+
     # DRAMPower provides in addition to the core power, the possibility to
     # include RD/WR termination and IO power. This calculation assumes some
     # default values. The integration of DRAMPower with gem5 does not include
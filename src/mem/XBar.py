@@ -85,6 +85,17 @@ class BaseXBar(MemObject):
     use_default_range = Param.Bool(False, "Perform address mapping for " \
                                        "the default port")
 
+    # Optionally, a bit field of the address can be used to index a table
+    # of ports directly, which avoids the search in the address map if
+    # many ports are distinguished by these bits (e.g., the core id of
+    # NoC addresses). Each entry belongs to the port whose range lies
+    # completely within the addresses that share this field value;
+    # everything else is looked up in the address map.
+    decode_shift = Param.Unsigned(0, "Position of the bit field used " \
+                                     "for direct port decoding")
+    decode_bits = Param.Unsigned(0, "Width of the bit field used for " \
+                                    "direct port decoding (0 = disabled)")
+
 class NoncoherentXBar(BaseXBar):
     type = 'NoncoherentXBar'
     cxx_header = "mem/noncoherent_xbar.hh"
@@ -44,6 +44,7 @@
 
 #include <vector>
 
+#include "base/memops.hh"
 #include "cpu/base.hh"
 #include "cpu/thread_context.hh"
 #include "debug/LLSC.hh"
@@ -427,8 +428,11 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
         TRACE_PACKET("Read");
         pkt->makeResponse();
     } else if (pkt->isWrite()) {
+        // functional writes are typically large blobs, like binaries
+        // that are loaded, which the host does not touch again soon
         if (pmemAddr)
-            memcpy(hostAddr, pkt->getConstPtr<uint8_t>(), pkt->getSize());
+            MemOps::copyBlock(hostAddr, pkt->getConstPtr<uint8_t>(),
+                              pkt->getSize());
         TRACE_PACKET("Write");
         pkt->makeResponse();
     } else if (pkt->isPrint()) {
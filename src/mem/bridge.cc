@@ -83,6 +83,12 @@ Bridge::Bridge(Params *p)
 {
 }
 
+Tick
+Bridge::linkLatency() const
+{
+    return clockPeriod() * ticksToCycles(params()->delay);
+}
+
 BaseMasterPort&
 Bridge::getMasterPort(const std::string &if_name, PortID idx)
 {
@@ -319,7 +319,14 @@ class Bridge : public MemObject
 
     virtual void init();
 
+    Tick linkLatency() const M5_ATTR_OVERRIDE;
+
     typedef BridgeParams Params;
+    const Params *
+    params() const
+    {
+        return dynamic_cast<const Params *>(_params);
+    }
 
     Bridge(Params *p);
 };
@@ -90,3 +90,14 @@ class TaggedPrefetcher(QueuedPrefetcher):
     cxx_header = "mem/cache/prefetch/tagged.hh"
 
     degree = Param.Int(2, "Number of prefetches to generate")
+
+class StreamPrefetcher(QueuedPrefetcher):
+    type = 'StreamPrefetcher'
+    cxx_class = 'StreamPrefetcher'
+    cxx_header = "mem/cache/prefetch/stream.hh"
+
+    streams = Param.Unsigned(8, "Number of tracked streams")
+    window = Param.Unsigned(4, "Max. distance in blocks to belong to a stream")
+    threshold = Param.Int(2, "Number of accesses to confirm a stream")
+    degree = Param.Unsigned(4, "Number of prefetches to generate per access")
+    distance = Param.Unsigned(16, "Max. number of blocks to run ahead")
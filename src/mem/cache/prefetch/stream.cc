@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Stream prefetcher implementation.
+ */
+
+#include "debug/HWPrefetch.hh"
+#include "mem/cache/prefetch/stream.hh"
+
+StreamPrefetcher::StreamPrefetcher(const StreamPrefetcherParams *p)
+    : QueuedPrefetcher(p),
+      window(p->window),
+      threshold(p->threshold),
+      degree(p->degree),
+      distance(p->distance),
+      streams(p->streams),
+      useCounter(0),
+      issued(),
+      issuedOrder(),
+      issueCounter(0),
+      maxIssued(p->streams * p->distance * 2)
+{
+    fatal_if(p->streams == 0, "The stream prefetcher needs streams");
+    fatal_if(degree > distance, "The degree has to be <= the distance");
+}
+
+StreamPrefetcher::Stream *
+StreamPrefetcher::findStream(Addr blk)
+{
+    Addr maxDist = window * blkSize;
+    for (Stream &s : streams)
+    {
+        if (!s.valid)
+            continue;
+
+        Addr dist = blk > s.lastBlk ? blk - s.lastBlk : s.lastBlk - blk;
+        if (dist <= maxDist)
+            return &s;
+    }
+    return NULL;
+}
+
+StreamPrefetcher::Stream *
+StreamPrefetcher::allocateStream(Addr blk)
+{
+    Stream *victim = &streams[0];
+    for (Stream &s : streams)
+    {
+        if (!s.valid)
+        {
+            victim = &s;
+            break;
+        }
+        if (s.lastUse < victim->lastUse)
+            victim = &s;
+    }
+
+    victim->valid = true;
+    victim->lastBlk = blk;
+    victim->pfNext = blk;
+    victim->dir = 0;
+    victim->conf = 0;
+    return victim;
+}
+
+Tick
+StreamPrefetcher::notify(const PacketPtr &pkt)
+{
+    if (observeAccess(pkt))
+    {
+        Addr blk = pkt->getAddr() & ~(Addr)(blkSize - 1);
+
+        auto it = issued.find(blk);
+        if (it != issued.end())
+        {
+            // count every prefetch only once
+            issued.erase(it);
+            pfUseful++;
+        }
+        else if (!inCache(blk, pkt->isSecure()))
+        {
+            // repeated accesses to the block a stream is waiting for are
+            // not separate misses
+            Stream *s = findStream(blk);
+            if (!s || s->lastBlk != blk)
+                pfUncovered++;
+        }
+    }
+
+    return QueuedPrefetcher::notify(pkt);
+}
+
+void
+StreamPrefetcher::calculatePrefetch(const PacketPtr &pkt,
+                                    std::vector<Addr> &addresses)
+{
+    Addr blk = pkt->getAddr() & ~(Addr)(blkSize - 1);
+
+    Stream *s = findStream(blk);
+    if (!s)
+    {
+        DPRINTF(HWPrefetch, "Allocating stream for %#x\n", blk);
+        s = allocateStream(blk);
+        s->lastUse = ++useCounter;
+        return;
+    }
+
+    s->lastUse = ++useCounter;
+    if (blk == s->lastBlk)
+        return;
+
+    int dir = blk > s->lastBlk ? 1 : -1;
+    if (dir == s->dir)
+        s->conf = std::min(s->conf + 1, threshold);
+    else
+    {
+        s->dir = dir;
+        s->conf = 1;
+        s->pfNext = blk;
+    }
+    s->lastBlk = blk;
+
+    if (s->conf < threshold)
+        return;
+
+    // the demand accesses might have overtaken the prefetches
+    Addr ahead = dir > 0 ? s->pfNext - blk : blk - s->pfNext;
+    if (s->pfNext == blk || ahead > distance * blkSize)
+        s->pfNext = dir > 0 ? blk + blkSize : blk - blkSize;
+
+    for (unsigned i = 0; i < degree; ++i)
+    {
+        Addr pf_addr = s->pfNext;
+        ahead = dir > 0 ? pf_addr - blk : blk - pf_addr;
+        if (ahead > distance * blkSize)
+            break;
+
+        if (!samePage(blk, pf_addr))
+        {
+            pfSpanPage++;
+            break;
+        }
+
+        DPRINTF(HWPrefetch, "Stream at %#x (dir=%d): prefetching %#x\n",
+                blk, dir, pf_addr);
+        addresses.push_back(pf_addr);
+        s->pfNext = dir > 0 ? pf_addr + blkSize : pf_addr - blkSize;
+    }
+}
+
+PacketPtr
+StreamPrefetcher::getPacket()
+{
+    PacketPtr pkt = QueuedPrefetcher::getPacket();
+    if (pkt)
+    {
+        if (issued.emplace(pkt->getAddr(), issueCounter).second)
+        {
+            issuedOrder.emplace_back(pkt->getAddr(), issueCounter++);
+            if (issuedOrder.size() > maxIssued)
+            {
+                // the block might have been used and issued again since
+                auto it = issued.find(issuedOrder.front().first);
+                if (it != issued.end() &&
+                    it->second == issuedOrder.front().second)
+                    issued.erase(it);
+                issuedOrder.pop_front();
+            }
+        }
+    }
+    return pkt;
+}
+
+void
+StreamPrefetcher::regStats()
+{
+    QueuedPrefetcher::regStats();
+
+    pfUseful
+        .name(name() + ".pfUseful")
+        .desc("number of prefetched blocks used by a demand access");
+
+    pfUncovered
+        .name(name() + ".pfUncovered")
+        .desc("number of demand misses not covered by a prefetch");
+
+    pfAccuracy
+        .name(name() + ".pfAccuracy")
+        .desc("fraction of issued prefetches that were used")
+        .precision(4);
+    pfAccuracy = pfUseful / pfIssued;
+
+    pfCoverage
+        .name(name() + ".pfCoverage")
+        .desc("fraction of demand misses covered by a prefetch")
+        .precision(4);
+    pfCoverage = pfUseful / (pfUseful + pfUncovered);
+}
+
+StreamPrefetcher*
+StreamPrefetcherParams::create()
+{
+   return new StreamPrefetcher(this);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Describes a stream prefetcher.
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_STREAM_HH__
+#define __MEM_CACHE_PREFETCH_STREAM_HH__
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mem/cache/prefetch/queued.hh"
+#include "params/StreamPrefetcher.hh"
+
+/**
+ * The stream prefetcher detects ascending and descending sequences of
+ * accesses to neighbouring blocks and runs ahead of them, issuing up to
+ * <degree> prefetches per access until it is <distance> blocks ahead. It is
+ * meant for caches that are backed by the NoC, where the DTU bundles
+ * adjacent prefetches into a single NoC request.
+ */
+class StreamPrefetcher : public QueuedPrefetcher
+{
+  protected:
+    struct Stream
+    {
+        Stream() : valid(false), lastBlk(0), pfNext(0), dir(0), conf(0),
+                   lastUse(0)
+        { }
+
+        bool valid;
+        Addr lastBlk;
+        Addr pfNext;
+        int dir;
+        int conf;
+        uint64_t lastUse;
+    };
+
+    const unsigned window;
+    const int threshold;
+    const unsigned degree;
+    const unsigned distance;
+
+    std::vector<Stream> streams;
+    uint64_t useCounter;
+
+    /**
+     * The recently issued prefetches. Bounded to the number of blocks all
+     * streams can be ahead of the demand accesses. A block can be issued
+     * again after it has been used, so that each issue gets a sequence
+     * number to let the oldest entry in issuedOrder only remove itself.
+     */
+    std::unordered_map<Addr, uint64_t> issued;
+    std::deque<std::pair<Addr, uint64_t>> issuedOrder;
+    uint64_t issueCounter;
+    const size_t maxIssued;
+
+    Stats::Scalar pfUseful;
+    Stats::Scalar pfUncovered;
+    Stats::Formula pfAccuracy;
+    Stats::Formula pfCoverage;
+
+    Stream *findStream(Addr blk);
+    Stream *allocateStream(Addr blk);
+
+  public:
+    StreamPrefetcher(const StreamPrefetcherParams *p);
+
+    Tick notify(const PacketPtr &pkt);
+
+    void calculatePrefetch(const PacketPtr &pkt,
+                           std::vector<Addr> &addresses);
+
+    PacketPtr getPacket();
+
+    void regStats();
+};
+
+#endif // __MEM_CACHE_PREFETCH_STREAM_HH__
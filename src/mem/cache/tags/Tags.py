@@ -66,6 +66,11 @@ class LRU(BaseSetAssoc):
     cxx_class = 'LRU'
     cxx_header = "mem/cache/tags/lru.hh"
 
+class CompactLRU(BaseSetAssoc):
+    type = 'CompactLRU'
+    cxx_class = 'CompactLRU'
+    cxx_header = "mem/cache/tags/compact_lru.hh"
+
 class RandomRepl(BaseSetAssoc):
     type = 'RandomRepl'
     cxx_class = 'RandomRepl'
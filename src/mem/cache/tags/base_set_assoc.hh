@@ -205,9 +205,7 @@ public:
     CacheBlk* accessBlock(Addr addr, bool is_secure, Cycles &lat,
                                  int context_src)
     {
-        Addr tag = extractTag(addr);
-        int set = extractSet(addr);
-        BlkType *blk = sets[set].findBlk(tag, is_secure);
+        BlkType *blk = findBlock(addr, is_secure);
         lat = accessLatency;;
 
         // Access all tags in parallel, hence one in each way.  The data side
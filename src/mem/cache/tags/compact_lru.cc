@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Definitions of a LRU tag store with a compact tag array.
+ */
+
+#include "base/bitfield.hh"
+#include "debug/CacheRepl.hh"
+#include "mem/cache/tags/compact_lru.hh"
+#include "mem/cache/base.hh"
+
+#if defined(__SSE2__)
+#define COMPACT_LRU_SSE2 1
+#include <emmintrin.h>
+#endif
+
+CompactLRU::CompactLRU(const Params *p)
+    : BaseSetAssoc(p),
+      keys(numSets * assoc),
+      ages(numSets * assoc)
+{
+    // the matches are returned as a bitmask
+    fatal_if(assoc > 64, "CompactLRU supports at most 64 ways\n");
+
+    for (unsigned i = 0; i < numSets; ++i) {
+        for (unsigned j = 0; j < assoc; ++j) {
+            // as in the LRU tags, all ways start in order of their index
+            keys[i * assoc + j] = makeKey(blks[i * assoc + j].tag, false);
+            ages[i * assoc + j] = j;
+        }
+    }
+}
+
+uint64_t
+CompactLRU::matchWays(unsigned set, uint64_t key) const
+{
+    const uint64_t *set_keys = &keys[set * assoc];
+    uint64_t mask = 0;
+    unsigned i = 0;
+
+#if COMPACT_LRU_SSE2
+    // SSE2 has no 64-bit comparison, so that we compare the 32-bit halves
+    // and combine the results of both halves
+    const __m128i needle = _mm_set1_epi64x(key);
+    for (; i + 2 <= assoc; i += 2) {
+        __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(set_keys + i));
+        __m128i eq = _mm_cmpeq_epi32(v, needle);
+        __m128i swapped = _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1));
+        eq = _mm_and_si128(eq, swapped);
+        uint64_t bits = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        mask |= bits << i;
+    }
+#endif
+
+    for (; i < assoc; ++i)
+        mask |= static_cast<uint64_t>(set_keys[i] == key) << i;
+    return mask;
+}
+
+void
+CompactLRU::touch(unsigned set, unsigned way)
+{
+    uint8_t *set_ages = &ages[set * assoc];
+    uint8_t old = set_ages[way];
+
+    // all ways that were used more recently get one step older
+    for (unsigned i = 0; i < assoc; ++i)
+        set_ages[i] += set_ages[i] < old;
+    set_ages[way] = 0;
+}
+
+void
+CompactLRU::age(unsigned set, unsigned way)
+{
+    uint8_t *set_ages = &ages[set * assoc];
+    uint8_t old = set_ages[way];
+
+    // all ways that were used less recently get one step younger
+    for (unsigned i = 0; i < assoc; ++i)
+        set_ages[i] -= set_ages[i] > old;
+    set_ages[way] = assoc - 1;
+}
+
+CacheBlk*
+CompactLRU::findBlock(Addr addr, bool is_secure) const
+{
+    Addr tag = extractTag(addr);
+    unsigned set = extractSet(addr);
+
+    // invalidated blocks keep their key, so that there might be more
+    // than one match
+    uint64_t mask = matchWays(set, makeKey(tag, is_secure));
+    while (mask) {
+        int way = findLsbSet(mask);
+        BlkType *blk = &blks[set * assoc + way];
+        if (blk->isValid() && blk->tag == tag &&
+            blk->isSecure() == is_secure)
+            return blk;
+        mask &= mask - 1;
+    }
+    return NULL;
+}
+
+CacheBlk*
+CompactLRU::accessBlock(Addr addr, bool is_secure, Cycles &lat,
+                        int master_id)
+{
+    CacheBlk *blk = BaseSetAssoc::accessBlock(addr, is_secure, lat, master_id);
+
+    if (blk != NULL) {
+        touch(blk->set, blk->way);
+        DPRINTF(CacheRepl, "set %x: moving blk %x (%s) to MRU\n",
+                blk->set, regenerateBlkAddr(blk->tag, blk->set),
+                is_secure ? "s" : "ns");
+    }
+
+    return blk;
+}
+
+CacheBlk*
+CompactLRU::findVictim(Addr addr)
+{
+    int set = extractSet(addr);
+    const uint8_t *set_ages = &ages[set * assoc];
+
+    // the oldest way among the allocatable ones
+    unsigned victim = 0;
+    for (unsigned i = 1; i < allocAssoc; ++i) {
+        if (set_ages[i] > set_ages[victim])
+            victim = i;
+    }
+
+    BlkType *blk = &blks[set * assoc + victim];
+    if (blk->isValid()) {
+        DPRINTF(CacheRepl, "set %x: selecting blk %x for replacement\n",
+                set, regenerateBlkAddr(blk->tag, set));
+    }
+
+    return blk;
+}
+
+void
+CompactLRU::insertBlock(PacketPtr pkt, BlkType *blk)
+{
+    BaseSetAssoc::insertBlock(pkt, blk);
+
+    keys[blk->set * assoc + blk->way] = makeKey(blk->tag, pkt->isSecure());
+    touch(blk->set, blk->way);
+}
+
+void
+CompactLRU::invalidate(CacheBlk *blk)
+{
+    BaseSetAssoc::invalidate(blk);
+
+    // should be evicted before valid blocks
+    age(blk->set, blk->way);
+}
+
+CompactLRU*
+CompactLRUParams::create()
+{
+    return new CompactLRU(this);
+}
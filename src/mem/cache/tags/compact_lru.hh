@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Declaration of a LRU tag store with a compact tag array.
+ * Like the LRU tags, it always evicts the true least-recently-used way
+ * of a set. However, the tags of a set are stored contiguously and
+ * compared against the searched tag at once, and the LRU order is kept
+ * as an age per way instead of a list of block pointers.
+ */
+
+#ifndef __MEM_CACHE_TAGS_COMPACT_LRU_HH__
+#define __MEM_CACHE_TAGS_COMPACT_LRU_HH__
+
+#include <vector>
+
+#include "mem/cache/tags/base_set_assoc.hh"
+#include "params/CompactLRU.hh"
+
+class CompactLRU : public BaseSetAssoc
+{
+  public:
+    /** Convenience typedef. */
+    typedef CompactLRUParams Params;
+
+    /**
+     * Construct and initialize this tag store.
+     */
+    CompactLRU(const Params *p);
+
+    /**
+     * Destructor
+     */
+    ~CompactLRU() {}
+
+    CacheBlk* accessBlock(Addr addr, bool is_secure, Cycles &lat,
+                         int context_src);
+    CacheBlk* findBlock(Addr addr, bool is_secure) const;
+    CacheBlk* findVictim(Addr addr);
+    void insertBlock(PacketPtr pkt, BlkType *blk);
+    void invalidate(CacheBlk *blk);
+
+  private:
+    /**
+     * Build the key of a tag in the tag array. The key contains the
+     * secure bit, so that a single comparison checks both.
+     */
+    static uint64_t makeKey(Addr tag, bool is_secure)
+    {
+        return (tag << 1) | is_secure;
+    }
+
+    /**
+     * Get a bitmask of the ways in the given set whose key matches.
+     * @param set The set to search.
+     * @param key The key to compare against.
+     * @return Bit i is set if way i matches.
+     */
+    uint64_t matchWays(unsigned set, uint64_t key) const;
+
+    /**
+     * Make the given way the most-recently-used one of its set.
+     */
+    void touch(unsigned set, unsigned way);
+
+    /**
+     * Make the given way the least-recently-used one of its set.
+     */
+    void age(unsigned set, unsigned way);
+
+    /**
+     * The keys of all blocks, assoc consecutive entries per set. The key
+     * is written on insertion only, so that it stays valid if the cache
+     * revalidates a block. Thus, a match still has to be confirmed by
+     * the block itself.
+     */
+    std::vector<uint64_t> keys;
+
+    /**
+     * The LRU position of all blocks, assoc consecutive entries per set.
+     * The ages of a set are a permutation of 0..assoc-1 and 0 is the
+     * most-recently-used way.
+     */
+    std::vector<uint8_t> ages;
+};
+
+#endif // __MEM_CACHE_TAGS_COMPACT_LRU_HH__
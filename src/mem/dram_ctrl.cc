@@ -44,6 +44,7 @@
  */
 
 #include "base/bitfield.hh"
+#include "base/time.hh"
 #include "base/trace.hh"
 #include "debug/DRAM.hh"
 #include "debug/DRAMPower.hh"
@@ -84,12 +85,13 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     tWR(p->tWR), tRTP(p->tRTP), tRFC(p->tRFC), tREFI(p->tREFI), tRRD(p->tRRD),
     tRRD_L(p->tRRD_L), tXAW(p->tXAW), activationLimit(p->activation_limit),
     memSchedPolicy(p->mem_sched_policy), addrMapping(p->addr_mapping),
-    pageMgmt(p->page_policy),
+    pageMgmt(p->page_policy), schedHostTiming(p->sched_host_time),
     maxAccessesPerRow(p->max_accesses_per_row),
     frontendLatency(p->static_frontend_latency),
     backendLatency(p->static_backend_latency),
     busBusyUntil(0), prevArrival(0),
-    nextReqTime(0), activeRank(0), timeStampOffset(0)
+    nextReqTime(0), activeRank(0), timeStampOffset(0),
+    analyticPower(p->power_model == Enums::analytic)
 {
     // sanity check the ranks since we rely on bit slicing for the
     // address decoding
@@ -128,6 +130,11 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
         }
     }
 
+    readQueue.init(ranksPerChannel * banksPerRank);
+    writeQueue.init(ranksPerChannel * banksPerRank);
+
+    initEnergyModel(p);
+
     // perform a basic check of the write thresholds
     if (p->write_low_thresh_perc >= p->write_high_thresh_perc)
         fatal("Write buffer low threshold %d must be smaller than the "
@@ -192,6 +199,44 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
 
 }
 
+void
+DRAMCtrl::initEnergyModel(const DRAMCtrlParams* p)
+{
+    // the commands take a whole number of clock cycles; the times are
+    // in ns and the currents in mA, so that we end up with pJ and mW
+    auto ns = [this](Tick t) {
+        return divCeil(t, tCK) * tCK / (double)SimClock::Int::ns;
+    };
+    // power of both voltage domains for the given currents
+    auto power = [p](double idd, double idd2) {
+        return (idd * p->VDD + idd2 * p->VDD2) * 1000;
+    };
+
+    EnergyModel &m = energyModel;
+    m.act = ns(tRAS) * (power(p->IDD0, p->IDD02) -
+                        power(p->IDD3N, p->IDD3N2));
+    m.pre = ns(tRP) * (power(p->IDD0, p->IDD02) -
+                       power(p->IDD2N, p->IDD2N2));
+    m.read = ns(tBURST) * (power(p->IDD4R, p->IDD4R2) -
+                           power(p->IDD3N, p->IDD3N2));
+    m.write = ns(tBURST) * (power(p->IDD4W, p->IDD4W2) -
+                            power(p->IDD3N, p->IDD3N2));
+    m.ref = ns(tRFC) * (power(p->IDD5, p->IDD52) -
+                        power(p->IDD3N, p->IDD3N2));
+    m.actBack = power(p->IDD3N, p->IDD3N2);
+    m.preBack = power(p->IDD2N, p->IDD2N2);
+    m.actPdn = p->dll ? power(p->IDD3P1, p->IDD3P12)
+                      : power(p->IDD3P0, p->IDD3P02);
+    m.prePdn = p->dll ? power(p->IDD2P1, p->IDD2P12)
+                      : power(p->IDD2P0, p->IDD2P02);
+
+    // all devices of a rank operate in lockstep
+    double *vals[] = {&m.act, &m.pre, &m.read, &m.write, &m.ref,
+                      &m.actBack, &m.preBack, &m.actPdn, &m.prePdn};
+    for (auto v : vals)
+        *v *= devicesPerRank;
+}
+
 void
 DRAMCtrl::init()
 {
@@ -709,141 +754,224 @@ DRAMCtrl::processRespondEvent()
     }
 }
 
-bool
-DRAMCtrl::chooseNext(std::deque<DRAMPacket*>& queue, Tick extra_col_delay)
+void
+DRAMCtrl::DRAMQueue::push_back(DRAMPacket* dram_pkt)
+{
+    dram_pkt->seqNum = nextSeqNum++;
+
+    BankQueue& bq = bankQueues[dram_pkt->bankId];
+    dram_pkt->queueIt = pkts.insert(pkts.end(), dram_pkt);
+    dram_pkt->bankIt = bq.pkts.insert(bq.pkts.end(), dram_pkt);
+    DRAMPacketList& row_pkts = bq.rows[dram_pkt->row];
+    dram_pkt->rowIt = row_pkts.insert(row_pkts.end(), dram_pkt);
+}
+
+void
+DRAMCtrl::DRAMQueue::erase(DRAMPacket* dram_pkt)
+{
+    BankQueue& bq = bankQueues[dram_pkt->bankId];
+    auto row_pkts = bq.rows.find(dram_pkt->row);
+    assert(row_pkts != bq.rows.end());
+
+    row_pkts->second.erase(dram_pkt->rowIt);
+    if (row_pkts->second.empty())
+        bq.rows.erase(row_pkts);
+    bq.pkts.erase(dram_pkt->bankIt);
+    pkts.erase(dram_pkt->queueIt);
+}
+
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::DRAMQueue::firstInBank(uint16_t bank_id) const
+{
+    const BankQueue& bq = bankQueues[bank_id];
+    return bq.pkts.empty() ? NULL : bq.pkts.front();
+}
+
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::DRAMQueue::firstInRow(uint16_t bank_id, uint32_t row) const
+{
+    const BankQueue& bq = bankQueues[bank_id];
+    auto row_pkts = bq.rows.find(row);
+    return row_pkts == bq.rows.end() ? NULL : row_pkts->second.front();
+}
+
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::DRAMQueue::firstNotInRow(uint16_t bank_id, uint32_t row) const
+{
+    const BankQueue& bq = bankQueues[bank_id];
+    // if all packets target the row, there is nothing to find
+    if (countInRow(bank_id, row) == bq.pkts.size())
+        return NULL;
+
+    // we only have to skip the leading packets to the row
+    for (const auto& p : bq.pkts) {
+        if (p->row != row)
+            return p;
+    }
+    return NULL;
+}
+
+size_t
+DRAMCtrl::DRAMQueue::countInRow(uint16_t bank_id, uint32_t row) const
+{
+    const BankQueue& bq = bankQueues[bank_id];
+    auto row_pkts = bq.rows.find(row);
+    return row_pkts == bq.rows.end() ? 0 : row_pkts->second.size();
+}
+
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::chooseNext(const DRAMQueue& queue, Tick extra_col_delay)
 {
     // This method does the arbitration between requests. The chosen
-    // packet is simply moved to the head of the queue. The other
-    // methods know that this is the place to look. For example, with
-    // FCFS, this method does nothing
+    // packet is returned and stays in the queue until the caller is
+    // done with it. For example, with FCFS, this simply picks the
+    // oldest packet to an available rank
     assert(!queue.empty());
 
-    // bool to indicate if a packet to an available rank is found
-    bool found_packet = false;
     if (queue.size() == 1) {
         DRAMPacket* dram_pkt = queue.front();
         // available rank corresponds to state refresh idle
         if (ranks[dram_pkt->rank]->isAvailable()) {
-            found_packet = true;
             DPRINTF(DRAM, "Single request, going to a free rank\n");
-        } else {
-            DPRINTF(DRAM, "Single request, going to a busy rank\n");
+            return dram_pkt;
         }
-        return found_packet;
+        DPRINTF(DRAM, "Single request, going to a busy rank\n");
+        return NULL;
     }
 
     if (memSchedPolicy == Enums::fcfs) {
-        // check if there is a packet going to a free rank
-        for(auto i = queue.begin(); i != queue.end() ; ++i) {
-            DRAMPacket* dram_pkt = *i;
-            if (ranks[dram_pkt->rank]->isAvailable()) {
-                queue.erase(i);
-                queue.push_front(dram_pkt);
-                found_packet = true;
-                break;
-            }
+        // find the oldest packet going to a free rank; the oldest
+        // packet of each bank is sufficient for that
+        DRAMPacket* selected_pkt = NULL;
+        for (uint16_t bank_id = 0; bank_id < ranksPerChannel * banksPerRank;
+             bank_id++) {
+            DRAMPacket* dram_pkt = queue.firstInBank(bank_id);
+            if (dram_pkt && dram_pkt->rankRef.isAvailable() &&
+                (!selected_pkt || dram_pkt->seqNum < selected_pkt->seqNum))
+                selected_pkt = dram_pkt;
         }
+        return selected_pkt;
     } else if (memSchedPolicy == Enums::frfcfs) {
-        found_packet = reorderQueue(queue, extra_col_delay);
+        return reorderQueue(queue, extra_col_delay);
     } else
         panic("No scheduling policy chosen\n");
-    return found_packet;
 }
 
-bool
-DRAMCtrl::reorderQueue(std::deque<DRAMPacket*>& queue, Tick extra_col_delay)
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::timedChooseNext(const DRAMQueue& queue, Tick extra_col_delay)
 {
-    // Only determine this if needed
-    uint64_t earliest_banks = 0;
-    bool hidden_bank_prep = false;
+    if (!schedHostTiming)
+        return chooseNext(queue, extra_col_delay);
 
-    // search for seamless row hits first, if no seamless row hit is
-    // found then determine if there are other packets that can be issued
-    // without incurring additional bus delay due to bank timing
-    // Will select closed rows first to enable more open row possibilies
-    // in future selections
-    bool found_hidden_bank = false;
+    Time start;
+    start.setTimer();
 
-    // remember if we found a row hit, not seamless, but bank prepped
-    // and ready
-    bool found_prepped_pkt = false;
+    DRAMPacket* dram_pkt = chooseNext(queue, extra_col_delay);
 
-    // if we have no row hit, prepped or not, and no seamless packet,
-    // just go for the earliest possible
-    bool found_earliest_pkt = false;
+    Time end;
+    end.setTimer();
+    schedHostTime += (double)(end - start);
+    schedDecisions++;
+    return dram_pkt;
+}
 
-    auto selected_pkt_it = queue.end();
+DRAMCtrl::DRAMPacket*
+DRAMCtrl::reorderQueue(const DRAMQueue& queue, Tick extra_col_delay)
+{
+    // Look for seamless row hits first. If no seamless row hit is
+    // found, determine if there are other packets that can be issued
+    // without incurring additional bus delay due to bank timing. If
+    // the bank commands of these can be hidden, or there is no prepped
+    // row hit, select them to enable more open row possibilities in
+    // future selections. Otherwise go for the prepped row hit.
+    //
+    // Within each category, the oldest packet wins (FCFS), so that it
+    // is sufficient to consider the oldest row hit and the oldest
+    // packet to another row of each bank.
+
+    // the oldest row hit that can issue seamlessly
+    DRAMPacket* seamless_pkt = NULL;
+    // the oldest row hit, not seamless, but bank prepped and ready
+    DRAMPacket* prepped_pkt = NULL;
+    // do we have any packet to another than the open row?
+    bool got_row_miss = false;
 
     // time we need to issue a column command to be seamless
     const Tick min_col_at = std::max(busBusyUntil - tCL + extra_col_delay,
                                      curTick());
 
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        DRAMPacket* dram_pkt = *i;
-        const Bank& bank = dram_pkt->bankRef;
+    for (uint32_t i = 0; i < ranksPerChannel; i++) {
+        // check if rank is available, if not, jump to the next rank
+        if (!ranks[i]->isAvailable())
+            continue;
+
+        for (uint32_t j = 0; j < banksPerRank; j++) {
+            uint16_t bank_id = i * banksPerRank + j;
+            const DRAMQueue::BankQueue& bq = queue.bank(bank_id);
+            if (bq.pkts.empty())
+                continue;
 
-        // check if rank is available, if not, jump to the next packet
-        if (dram_pkt->rankRef.isAvailable()) {
-            // check if it is a row hit
-            if (bank.openRow == dram_pkt->row) {
+            const Bank& bank = ranks[i]->banks[j];
+            DRAMPacket* hit = queue.firstInRow(bank_id, bank.openRow);
+            if (hit) {
                 // no additional rank-to-rank or same bank-group
                 // delays, or we switched read/write and might as well
                 // go for the row hit
                 if (bank.colAllowedAt <= min_col_at) {
-                    // FCFS within the hits, giving priority to
-                    // commands that can issue seamlessly, without
-                    // additional delay, such as same rank accesses
-                    // and/or different bank-group accesses
-                    DPRINTF(DRAM, "Seamless row buffer hit\n");
-                    selected_pkt_it = i;
-                    // no need to look through the remaining queue entries
-                    break;
-                } else if (!found_hidden_bank && !found_prepped_pkt) {
-                    // if we did not find a packet to a closed row that can
-                    // issue the bank commands without incurring delay, and
-                    // did not yet find a packet to a prepped row, remember
-                    // the current one
-                    selected_pkt_it = i;
-                    found_prepped_pkt = true;
-                    DPRINTF(DRAM, "Prepped row buffer hit\n");
-                }
-            } else if (!found_earliest_pkt) {
-                // if we have not initialised the bank status, do it
-                // now, and only once per scheduling decisions
-                if (earliest_banks == 0) {
-                    // determine entries with earliest bank delay
-                    pair<uint64_t, bool> bankStatus =
-                        minBankPrep(queue, min_col_at);
-                    earliest_banks = bankStatus.first;
-                    hidden_bank_prep = bankStatus.second;
-                }
-
-                // bank is amongst first available banks
-                // minBankPrep will give priority to packets that can
-                // issue seamlessly
-                if (bits(earliest_banks, dram_pkt->bankId, dram_pkt->bankId)) {
-                    found_earliest_pkt = true;
-                    found_hidden_bank = hidden_bank_prep;
-
-                    // give priority to packets that can issue
-                    // bank commands 'behind the scenes'
-                    // any additional delay if any will be due to
-                    // col-to-col command requirements
-                    if (hidden_bank_prep || !found_prepped_pkt)
-                        selected_pkt_it = i;
+                    if (!seamless_pkt || hit->seqNum < seamless_pkt->seqNum)
+                        seamless_pkt = hit;
+                } else if (!prepped_pkt ||
+                           hit->seqNum < prepped_pkt->seqNum) {
+                    prepped_pkt = hit;
                 }
             }
+
+            if (queue.countInRow(bank_id, bank.openRow) < bq.pkts.size())
+                got_row_miss = true;
         }
     }
 
-    if (selected_pkt_it != queue.end()) {
-        DRAMPacket* selected_pkt = *selected_pkt_it;
-        queue.erase(selected_pkt_it);
-        queue.push_front(selected_pkt);
-        return true;
+    if (seamless_pkt) {
+        // FCFS within the hits, giving priority to commands that can
+        // issue seamlessly, without additional delay, such as same
+        // rank accesses and/or different bank-group accesses
+        DPRINTF(DRAM, "Seamless row buffer hit\n");
+        return seamless_pkt;
+    }
+
+    if (got_row_miss) {
+        // determine entries with earliest bank delay
+        pair<uint64_t, bool> bankStatus = minBankPrep(queue, min_col_at);
+        uint64_t earliest_banks = bankStatus.first;
+        bool hidden_bank_prep = bankStatus.second;
+
+        // the oldest packet to another row of one of the earliest
+        // banks (minBankPrep gives priority to packets that can issue
+        // seamlessly)
+        DRAMPacket* earliest_pkt = NULL;
+        for (uint16_t bank_id = 0; bank_id < ranksPerChannel * banksPerRank;
+             bank_id++) {
+            if (!bits(earliest_banks, bank_id, bank_id))
+                continue;
+
+            const Bank& bank = ranks[bank_id / banksPerRank]->
+                banks[bank_id % banksPerRank];
+            DRAMPacket* miss = queue.firstNotInRow(bank_id, bank.openRow);
+            if (miss && (!earliest_pkt ||
+                         miss->seqNum < earliest_pkt->seqNum))
+                earliest_pkt = miss;
+        }
+
+        // give priority to packets that can issue bank commands
+        // 'behind the scenes'; any additional delay if any will be due
+        // to col-to-col command requirements
+        if (earliest_pkt && (hidden_bank_prep || !prepped_pkt))
+            return earliest_pkt;
     }
 
-    return false;
+    if (prepped_pkt)
+        DPRINTF(DRAM, "Prepped row buffer hit\n");
+    return prepped_pkt;
 }
 
 void
@@ -908,9 +1036,12 @@ DRAMCtrl::activateBank(Rank& rank_ref, Bank& bank_ref,
             bank_ref.bank, rank_ref.rank, act_tick,
             ranks[rank_ref.rank]->numBanksActive);
 
-    rank_ref.power.powerlib.doCommand(MemCommand::ACT, bank_ref.bank,
-                                      divCeil(act_tick, tCK) -
-                                      timeStampOffset);
+    if (analyticPower)
+        rank_ref.addCmdEnergy(Rank::ENERGY_ACT);
+    else
+        rank_ref.power.powerlib.doCommand(MemCommand::ACT, bank_ref.bank,
+                                          divCeil(act_tick, tCK) -
+                                          timeStampOffset);
 
     DPRINTF(DRAMPower, "%llu,ACT,%d,%d\n", divCeil(act_tick, tCK) -
             timeStampOffset, bank_ref.bank, rank_ref.rank);
@@ -1010,11 +1141,16 @@ DRAMCtrl::prechargeBank(Rank& rank_ref, Bank& bank, Tick pre_at, bool trace)
             "%d active\n", bank.bank, rank_ref.rank, pre_at,
             rank_ref.numBanksActive);
 
-    if (trace) {
+    // the analytic model also accounts for the banks closed by a
+    // precharge all, like DRAMPower does
+    if (analyticPower)
+        rank_ref.addCmdEnergy(Rank::ENERGY_PRE);
 
-        rank_ref.power.powerlib.doCommand(MemCommand::PRE, bank.bank,
-                                                divCeil(pre_at, tCK) -
-                                                timeStampOffset);
+    if (trace) {
+        if (!analyticPower)
+            rank_ref.power.powerlib.doCommand(MemCommand::PRE, bank.bank,
+                                              divCeil(pre_at, tCK) -
+                                              timeStampOffset);
         DPRINTF(DRAMPower, "%llu,PRE,%d,%d\n", divCeil(pre_at, tCK) -
                 timeStampOffset, bank.bank, rank_ref.rank);
     }
@@ -1150,26 +1286,20 @@ DRAMCtrl::doDRAMAccess(DRAMPacket* dram_pkt)
         bool got_bank_conflict = false;
 
         // either look at the read queue or write queue
-        const deque<DRAMPacket*>& queue = dram_pkt->isRead ? readQueue :
-            writeQueue;
-        auto p = queue.begin();
+        const DRAMQueue& queue = dram_pkt->isRead ? readQueue : writeQueue;
+
         // make sure we are not considering the packet that we are
-        // currently dealing with (which is the head of the queue)
-        ++p;
+        // currently dealing with (which is still in the queue)
+        size_t same_row = queue.countInRow(dram_pkt->bankId, dram_pkt->row);
+        size_t same_bank = queue.bank(dram_pkt->bankId).pkts.size();
+        assert(same_row > 0);
 
-        // keep on looking until we find a hit or reach the end of the queue
-        // 1) if a hit is found, then both open and close adaptive policies keep
-        // the page open
+        // 1) if a hit is found, then both open and close adaptive policies
+        // keep the page open
         // 2) if no hit is found, got_bank_conflict is set to true if a bank
         // conflict request is waiting in the queue
-        while (!got_more_hits && p != queue.end()) {
-            bool same_rank_bank = (dram_pkt->rank == (*p)->rank) &&
-                (dram_pkt->bank == (*p)->bank);
-            bool same_row = dram_pkt->row == (*p)->row;
-            got_more_hits |= same_rank_bank && same_row;
-            got_bank_conflict |= same_rank_bank && !same_row;
-            ++p;
-        }
+        got_more_hits = same_row > 1;
+        got_bank_conflict = same_bank > same_row;
 
         // auto pre-charge when either
         // 1) open_adaptive policy, we have not got any more hits, and
@@ -1202,9 +1332,13 @@ DRAMCtrl::doDRAMAccess(DRAMPacket* dram_pkt)
     DPRINTF(DRAM, "Access to %lld, ready at %lld bus busy until %lld.\n",
             dram_pkt->addr, dram_pkt->readyTime, busBusyUntil);
 
-    dram_pkt->rankRef.power.powerlib.doCommand(command, dram_pkt->bank,
-                                                 divCeil(cmd_at, tCK) -
-                                                 timeStampOffset);
+    if (analyticPower)
+        dram_pkt->rankRef.addCmdEnergy(dram_pkt->isRead ? Rank::ENERGY_RD :
+                                                          Rank::ENERGY_WR);
+    else
+        dram_pkt->rankRef.power.powerlib.doCommand(command, dram_pkt->bank,
+                                                     divCeil(cmd_at, tCK) -
+                                                     timeStampOffset);
 
     DPRINTF(DRAMPower, "%llu,%s,%d,%d\n", divCeil(cmd_at, tCK) -
             timeStampOffset, mem_cmd, dram_pkt->bank, dram_pkt->rank);
@@ -1313,25 +1447,20 @@ DRAMCtrl::processNextReqEvent()
                 return;
             }
         } else {
-            // bool to check if there is a read to a free rank
-            bool found_read = false;
-
-            // Figure out which read request goes next, and move it to the
-            // front of the read queue
+            // Figure out which read request goes next
             // If we are changing command type, incorporate the minimum
             // bus turnaround delay which will be tCS (different rank) case
-            found_read = chooseNext(readQueue,
-                             switched_cmd_type ? tCS : 0);
+            DRAMPacket* dram_pkt = timedChooseNext(readQueue,
+                                       switched_cmd_type ? tCS : 0);
 
             // if no read to an available rank is found then return
             // at this point. There could be writes to the available ranks
             // which are above the required threshold. However, to
             // avoid adding more complexity to the code, return and wait
             // for a refresh event to kick things into action again.
-            if (!found_read)
+            if (!dram_pkt)
                 return;
 
-            DRAMPacket* dram_pkt = readQueue.front();
             assert(dram_pkt->rankRef.isAvailable());
             // here we get a bit creative and shift the bus busy time not
             // just the tWTR, but also a CAS latency to capture the fact
@@ -1345,7 +1474,7 @@ DRAMCtrl::processNextReqEvent()
             doDRAMAccess(dram_pkt);
 
             // At this point we're done dealing with the request
-            readQueue.pop_front();
+            readQueue.erase(dram_pkt);
 
             // sanity check
             assert(dram_pkt->size <= burstSize);
@@ -1377,22 +1506,18 @@ DRAMCtrl::processNextReqEvent()
             busState = READ_TO_WRITE;
         }
     } else {
-        // bool to check if write to free rank is found
-        bool found_write = false;
-
         // If we are changing command type, incorporate the minimum
         // bus turnaround delay
-        found_write = chooseNext(writeQueue,
-                                 switched_cmd_type ? std::min(tRTW, tCS) : 0);
+        DRAMPacket* dram_pkt = timedChooseNext(writeQueue,
+            switched_cmd_type ? std::min(tRTW, tCS) : 0);
 
         // if no writes to an available rank are found then return.
         // There could be reads to the available ranks. However, to avoid
         // adding more complexity to the code, return at this point and wait
         // for a refresh event to kick things into action again.
-        if (!found_write)
+        if (!dram_pkt)
             return;
 
-        DRAMPacket* dram_pkt = writeQueue.front();
         assert(dram_pkt->rankRef.isAvailable());
         // sanity check
         assert(dram_pkt->size <= burstSize);
@@ -1407,7 +1532,7 @@ DRAMCtrl::processNextReqEvent()
 
         doDRAMAccess(dram_pkt);
 
-        writeQueue.pop_front();
+        writeQueue.erase(dram_pkt);
         isInWriteQueue.erase(burstAlign(dram_pkt->addr));
         delete dram_pkt;
 
@@ -1444,7 +1569,7 @@ DRAMCtrl::processNextReqEvent()
 }
 
 pair<uint64_t, bool>
-DRAMCtrl::minBankPrep(const deque<DRAMPacket*>& queue,
+DRAMCtrl::minBankPrep(const DRAMQueue& queue,
                       Tick min_col_at) const
 {
     uint64_t bank_mask = 0;
@@ -1461,14 +1586,6 @@ DRAMCtrl::minBankPrep(const deque<DRAMPacket*>& queue,
     // delay on the data bus
     bool hidden_bank_prep = false;
 
-    // determine if we have queued transactions targetting the
-    // bank in question
-    vector<bool> got_waiting(ranksPerChannel * banksPerRank, false);
-    for (const auto& p : queue) {
-        if(p->rankRef.isAvailable())
-            got_waiting[p->bankId] = true;
-    }
-
     // Find command with optimal bank timing
     // Will prioritize commands that can issue seamlessly.
     for (int i = 0; i < ranksPerChannel; i++) {
@@ -1477,7 +1594,8 @@ DRAMCtrl::minBankPrep(const deque<DRAMPacket*>& queue,
 
             // if we have waiting requests for the bank, and it is
             // amongst the first available, update the mask
-            if (got_waiting[bank_id]) {
+            if (ranks[i]->isAvailable() &&
+                !queue.bank(bank_id).pkts.empty()) {
                 // make sure this rank is not currently refreshing.
                 assert(ranks[i]->isAvailable());
                 // simplistic approximation of when the bank can issue
@@ -1530,7 +1648,7 @@ DRAMCtrl::Rank::Rank(DRAMCtrl& _memory, const DRAMCtrlParams* _p)
     : EventManager(&_memory), memory(_memory),
       pwrStateTrans(PWR_IDLE), pwrState(PWR_IDLE), pwrStateTick(0),
       refreshState(REF_IDLE), refreshDueAt(0),
-      power(_p, false), numBanksActive(0),
+      powerStatsStart(0), power(_p, false), numBanksActive(0),
       activateEvent(*this), prechargeEvent(*this),
       refreshEvent(*this), powerEvent(*this)
 { }
@@ -1655,9 +1773,10 @@ DRAMCtrl::Rank::processRefreshEvent()
             }
 
             // precharge all banks in rank
-            power.powerlib.doCommand(MemCommand::PREA, 0,
-                                     divCeil(pre_at, memory.tCK) -
-                                     memory.timeStampOffset);
+            if (!memory.analyticPower)
+                power.powerlib.doCommand(MemCommand::PREA, 0,
+                                         divCeil(pre_at, memory.tCK) -
+                                         memory.timeStampOffset);
 
             DPRINTF(DRAMPower, "%llu,PREA,0,%d\n",
                     divCeil(pre_at, memory.tCK) -
@@ -1692,28 +1811,33 @@ DRAMCtrl::Rank::processRefreshEvent()
             b.actAllowedAt = ref_done_at;
         }
 
-        // at the moment this affects all ranks
-        power.powerlib.doCommand(MemCommand::REF, 0,
-                                 divCeil(curTick(), memory.tCK) -
-                                 memory.timeStampOffset);
-
-        // at the moment sort the list of commands and update the counters
-        // for DRAMPower libray when doing a refresh
-        sort(power.powerlib.cmdList.begin(),
-             power.powerlib.cmdList.end(), DRAMCtrl::sortTime);
-
-        // update the counters for DRAMPower, passing false to
-        // indicate that this is not the last command in the
-        // list. DRAMPower requires this information for the
-        // correct calculation of the background energy at the end
-        // of the simulation. Ideally we would want to call this
-        // function with true once at the end of the
-        // simulation. However, the discarded energy is extremly
-        // small and does not effect the final results.
-        power.powerlib.updateCounters(false);
-
-        // call the energy function
-        power.powerlib.calcEnergy();
+        if (memory.analyticPower) {
+            // the energy has been accounted for as we went
+            addCmdEnergy(ENERGY_REF);
+        } else {
+            // at the moment this affects all ranks
+            power.powerlib.doCommand(MemCommand::REF, 0,
+                                     divCeil(curTick(), memory.tCK) -
+                                     memory.timeStampOffset);
+
+            // at the moment sort the list of commands and update the
+            // counters for DRAMPower libray when doing a refresh
+            sort(power.powerlib.cmdList.begin(),
+                 power.powerlib.cmdList.end(), DRAMCtrl::sortTime);
+
+            // update the counters for DRAMPower, passing false to
+            // indicate that this is not the last command in the
+            // list. DRAMPower requires this information for the
+            // correct calculation of the background energy at the end
+            // of the simulation. Ideally we would want to call this
+            // function with true once at the end of the
+            // simulation. However, the discarded energy is extremly
+            // small and does not effect the final results.
+            power.powerlib.updateCounters(false);
+
+            // call the energy function
+            power.powerlib.calcEnergy();
+        }
 
         // Update the stats
         updatePowerStats();
@@ -1773,6 +1897,8 @@ DRAMCtrl::Rank::processPowerEvent()
 
     // update the accounting
     pwrStateTime[prev_state] += duration;
+    if (memory.analyticPower)
+        addBackgroundEnergy(prev_state, duration);
 
     pwrState = pwrStateTrans;
     pwrStateTick = curTick();
@@ -1820,9 +1946,82 @@ DRAMCtrl::Rank::processPowerEvent()
     }
 }
 
+void
+DRAMCtrl::Rank::addCmdEnergy(EnergyCmd cmd)
+{
+    const EnergyModel &model = memory.energyModel;
+    double energy = 0;
+
+    switch (cmd) {
+      case ENERGY_ACT:
+        energy = model.act;
+        actEnergy += energy;
+        break;
+      case ENERGY_PRE:
+        energy = model.pre;
+        preEnergy += energy;
+        break;
+      case ENERGY_RD:
+        energy = model.read;
+        readEnergy += energy;
+        break;
+      case ENERGY_WR:
+        energy = model.write;
+        writeEnergy += energy;
+        break;
+      case ENERGY_REF:
+        energy = model.ref;
+        refreshEnergy += energy;
+        break;
+    }
+
+    totalEnergy += energy;
+}
+
+void
+DRAMCtrl::Rank::addBackgroundEnergy(PowerState state, Tick duration)
+{
+    const EnergyModel &model = memory.energyModel;
+    // mW * ns = pJ
+    double ns = duration / (double)SimClock::Int::ns;
+    double energy;
+
+    // like DRAMPower, we count the refresh as active time
+    switch (state) {
+      case PWR_IDLE:
+        energy = model.preBack * ns;
+        preBackEnergy += energy;
+        break;
+      case PWR_PRE_PDN:
+        energy = model.prePdn * ns;
+        preBackEnergy += energy;
+        break;
+      case PWR_ACT_PDN:
+        energy = model.actPdn * ns;
+        actBackEnergy += energy;
+        break;
+      default:
+        energy = model.actBack * ns;
+        actBackEnergy += energy;
+        break;
+    }
+
+    totalEnergy += energy;
+}
+
 void
 DRAMCtrl::Rank::updatePowerStats()
 {
+    if (memory.analyticPower) {
+        // the energy has been accounted for as we went
+        Tick elapsed = curTick() - powerStatsStart;
+        if (elapsed > 0) {
+            averagePower = totalEnergy.value() /
+                (elapsed / (double)SimClock::Int::ns);
+        }
+        return;
+    }
+
     // Get the energy and power from DRAMPower
     Data::MemoryPowerModel::Energy energy =
         power.powerlib.getEnergy();
@@ -1891,6 +2090,12 @@ DRAMCtrl::Rank::regStats()
         .name(name() + ".averagePower")
         .desc("Core power per rank (mW)");
 }
+
+void
+DRAMCtrl::Rank::resetStats()
+{
+    powerStatsStart = curTick();
+}
 void
 DRAMCtrl::regStats()
 {
@@ -1986,6 +2191,25 @@ DRAMCtrl::regStats()
 
     avgMemAccLat = totMemAccLat / (readBursts - servicedByWrQ);
 
+    // unnamed stats are not printed
+    if (schedHostTiming) {
+        schedDecisions
+            .name(name() + ".schedDecisions")
+            .desc("Number of scheduling decisions");
+
+        schedHostTime
+            .name(name() + ".schedHostTime")
+            .desc("Host time spent in the scheduler (in seconds)")
+            .precision(6);
+
+        avgSchedHostTime
+            .name(name() + ".avgSchedHostTime")
+            .desc("Average host time per scheduling decision (in seconds)")
+            .precision(9);
+    }
+
+    avgSchedHostTime = schedHostTime / schedDecisions;
+
     numRdRetry
         .name(name() + ".numRdRetry")
         .desc("Number of times read queue was full causing retry");
@@ -2150,6 +2374,17 @@ DRAMCtrl::regStats()
         (writeBursts - mergedWrBursts + readBursts - servicedByWrQ) * 100;
 }
 
+void
+DRAMCtrl::resetStats()
+{
+    AbstractMemory::resetStats();
+
+    // the average power of the analytic model refers to the new interval
+    for (auto r : ranks) {
+        r->resetStats();
+    }
+}
+
 void
 DRAMCtrl::recvFunctional(PacketPtr pkt)
 {
@@ -52,8 +52,11 @@
 #define __MEM_DRAM_CTRL_HH__
 
 #include <deque>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "enums/AddrMap.hh"
@@ -289,11 +292,23 @@ class DRAMCtrl : public AbstractMemory
          */
         Stats::Vector pwrStateTime;
 
+        /**
+         * Tick of the last stats reset, to determine the average power of
+         * the analytic energy model.
+         */
+        Tick powerStatsStart;
+
         /**
          * Function to update Power Stats
          */
         void updatePowerStats();
 
+        /**
+         * Account the background energy of the given power state for the
+         * given duration (analytic energy model only).
+         */
+        void addBackgroundEnergy(PowerState state, Tick duration);
+
         /**
          * Schedule a power state transition in the future, and
          * potentially override an already scheduled transition.
@@ -363,11 +378,35 @@ class DRAMCtrl : public AbstractMemory
          */
         void checkDrainDone();
 
+        /**
+         * The commands the analytic energy model accounts for.
+         */
+        enum EnergyCmd {
+            ENERGY_ACT,
+            ENERGY_PRE,
+            ENERGY_RD,
+            ENERGY_WR,
+            ENERGY_REF
+        };
+
+        /**
+         * Add the energy of a command to the stats of this rank (analytic
+         * energy model only).
+         *
+         * @param cmd The issued command
+         */
+        void addCmdEnergy(EnergyCmd cmd);
+
         /*
          * Function to register Stats
          */
         void regStats();
 
+        /*
+         * Function to reset Stats
+         */
+        void resetStats();
+
         void processActivateEvent();
         EventWrapper<Rank, &Rank::processActivateEvent>
         activateEvent;
@@ -407,6 +446,9 @@ class DRAMCtrl : public AbstractMemory
         { }
     };
 
+    class DRAMPacket;
+    typedef std::list<DRAMPacket*> DRAMPacketList;
+
     /**
      * A DRAM packet stores packets along with the timestamp of when
      * the packet entered the queue, and also the decoded address.
@@ -460,17 +502,88 @@ class DRAMCtrl : public AbstractMemory
         Bank& bankRef;
         Rank& rankRef;
 
+        /**
+         * Position in the read or write queue. The sequence number
+         * reflects the arrival order, the iterators allow us to remove
+         * the packet from the lists of the queue in constant time.
+         */
+        uint64_t seqNum;
+        DRAMPacketList::iterator queueIt;
+        DRAMPacketList::iterator bankIt;
+        DRAMPacketList::iterator rowIt;
+
         DRAMPacket(PacketPtr _pkt, bool is_read, uint8_t _rank, uint8_t _bank,
                    uint32_t _row, uint16_t bank_id, Addr _addr,
                    unsigned int _size, Bank& bank_ref, Rank& rank_ref)
             : entryTime(curTick()), readyTime(curTick()),
               pkt(_pkt), isRead(is_read), rank(_rank), bank(_bank), row(_row),
               bankId(bank_id), addr(_addr), size(_size), burstHelper(NULL),
-              bankRef(bank_ref), rankRef(rank_ref)
+              bankRef(bank_ref), rankRef(rank_ref), seqNum(0)
         { }
 
     };
 
+    /**
+     * A read or write queue of the controller. Besides keeping all
+     * packets in arrival order, the packets are bucketed per bank and,
+     * within a bank, per row. This way, the scheduler can find the
+     * oldest packet and the oldest row hit of each bank without
+     * walking through the whole queue, so that a scheduling decision
+     * scales with the number of banks instead of the queue depth.
+     */
+    class DRAMQueue {
+
+      public:
+
+        struct BankQueue {
+            /** All packets to this bank in arrival order */
+            DRAMPacketList pkts;
+            /** The packets per row in arrival order */
+            std::unordered_map<uint32_t, DRAMPacketList> rows;
+        };
+
+        DRAMQueue() : nextSeqNum(0) { }
+
+        void init(size_t banks) { bankQueues.resize(banks); }
+
+        size_t size() const { return pkts.size(); }
+        bool empty() const { return pkts.empty(); }
+
+        DRAMPacket* front() const { return pkts.front(); }
+        DRAMPacketList::const_iterator begin() const { return pkts.begin(); }
+        DRAMPacketList::const_iterator end() const { return pkts.end(); }
+
+        const BankQueue& bank(uint16_t bank_id) const
+        { return bankQueues[bank_id]; }
+
+        /** Appends the packet and assigns its sequence number */
+        void push_back(DRAMPacket* dram_pkt);
+
+        /** Removes the given packet from the queue */
+        void erase(DRAMPacket* dram_pkt);
+
+        /** @return the oldest packet to the given bank (or NULL) */
+        DRAMPacket* firstInBank(uint16_t bank_id) const;
+
+        /** @return the oldest packet to the given bank and row (or NULL) */
+        DRAMPacket* firstInRow(uint16_t bank_id, uint32_t row) const;
+
+        /**
+         * @return the oldest packet to the given bank that does not
+         * target the given row (or NULL)
+         */
+        DRAMPacket* firstNotInRow(uint16_t bank_id, uint32_t row) const;
+
+        /** @return the number of packets to the given bank and row */
+        size_t countInRow(uint16_t bank_id, uint32_t row) const;
+
+      private:
+
+        DRAMPacketList pkts;
+        std::vector<BankQueue> bankQueues;
+        uint64_t nextSeqNum;
+    };
+
     /**
      * Bunch of things requires to setup "events" in gem5
      * When event "respondEvent" occurs for example, the method
@@ -568,28 +681,34 @@ class DRAMCtrl : public AbstractMemory
 
     /**
      * The memory schduler/arbiter - picks which request needs to
-     * go next, based on the specified policy such as FCFS or FR-FCFS
-     * and moves it to the head of the queue.
+     * go next, based on the specified policy such as FCFS or FR-FCFS.
      * Prioritizes accesses to the same rank as previous burst unless
      * controller is switching command type.
      *
      * @param queue Queued requests to consider
      * @param extra_col_delay Any extra delay due to a read/write switch
-     * @return true if a packet is scheduled to a rank which is available else
-     * false
+     * @return the packet to schedule, or NULL if there is no packet to
+     * a rank which is available
+     */
+    DRAMPacket* chooseNext(const DRAMQueue& queue, Tick extra_col_delay);
+
+    /**
+     * Calls chooseNext and, if enabled, accounts the host time spent for
+     * it.
      */
-    bool chooseNext(std::deque<DRAMPacket*>& queue, Tick extra_col_delay);
+    DRAMPacket* timedChooseNext(const DRAMQueue& queue,
+                                Tick extra_col_delay);
 
     /**
-     * For FR-FCFS policy reorder the read/write queue depending on row buffer
-     * hits and earliest bursts available in DRAM
+     * For FR-FCFS policy choose a packet from the read/write queue depending
+     * on row buffer hits and earliest bursts available in DRAM
      *
      * @param queue Queued requests to consider
      * @param extra_col_delay Any extra delay due to a read/write switch
-     * @return true if a packet is scheduled to a rank which is available else
-     * false
+     * @return the packet to schedule, or NULL if there is no packet to
+     * a rank which is available
      */
-    bool reorderQueue(std::deque<DRAMPacket*>& queue, Tick extra_col_delay);
+    DRAMPacket* reorderQueue(const DRAMQueue& queue, Tick extra_col_delay);
 
     /**
      * Find which are the earliest banks ready to issue an activate
@@ -601,7 +720,7 @@ class DRAMCtrl : public AbstractMemory
      * @return One-hot encoded mask of bank indices
      * @return boolean indicating burst can issue seamlessly, with no gaps
      */
-    std::pair<uint64_t, bool> minBankPrep(const std::deque<DRAMPacket*>& queue,
+    std::pair<uint64_t, bool> minBankPrep(const DRAMQueue& queue,
                                           Tick min_col_at) const;
 
     /**
@@ -648,8 +767,8 @@ class DRAMCtrl : public AbstractMemory
     /**
      * The controller's main read and write queues
      */
-    std::deque<DRAMPacket*> readQueue;
-    std::deque<DRAMPacket*> writeQueue;
+    DRAMQueue readQueue;
+    DRAMQueue writeQueue;
 
     /**
      * To avoid iterating over the write queue to check for
@@ -735,6 +854,11 @@ class DRAMCtrl : public AbstractMemory
     Enums::AddrMap addrMapping;
     Enums::PageManage pageMgmt;
 
+    /**
+     * Whether the host time of the scheduler is measured and reported.
+     */
+    const bool schedHostTiming;
+
     /**
      * Max column accesses (read and write) per row, before forefully
      * closing it.
@@ -801,6 +925,11 @@ class DRAMCtrl : public AbstractMemory
     Stats::Scalar totMemAccLat;
     Stats::Scalar totBusLat;
 
+    // Host time spent in the scheduler
+    Stats::Scalar schedDecisions;
+    Stats::Scalar schedHostTime;
+    Stats::Formula avgSchedHostTime;
+
     // Average latencies per request
     Stats::Formula avgQLat;
     Stats::Formula avgBusLat;
@@ -836,6 +965,38 @@ class DRAMCtrl : public AbstractMemory
     // timestamp offset
     uint64_t timeStampOffset;
 
+    /**
+     * Whether the built-in analytic energy model is used instead of
+     * DRAMPower. It follows the equations of DRAMPower, but accumulates
+     * the energy of each rank as the commands are issued and the power
+     * states change, instead of recording the commands and replaying
+     * them at every refresh.
+     */
+    const bool analyticPower;
+
+    /**
+     * The parameters of the analytic energy model, covering all devices
+     * of a rank and shared by all ranks: the energy per command in pJ
+     * and the background power per power state in mW.
+     */
+    struct EnergyModel {
+        double act;
+        double pre;
+        double read;
+        double write;
+        double ref;
+        double actBack;
+        double preBack;
+        double actPdn;
+        double prePdn;
+    } energyModel;
+
+    /**
+     * Derive the parameters of the analytic energy model from the
+     * currents, voltages and timings of the DRAM.
+     */
+    void initEnergyModel(const DRAMCtrlParams* p);
+
     /** @todo this is a temporary workaround until the 4-phase code is
      * committed. upstream caches needs this packet until true is returned, so
      * hold onto it for deletion until a subsequent call
@@ -847,7 +1008,8 @@ class DRAMCtrl : public AbstractMemory
      * dumped periodically, note accumulated energy values will
      * appear in the stats (even if the stats are reset). This is a
      * result of the energy values coming from DRAMPower, and there
-     * is currently no support for resetting the state.
+     * is currently no support for resetting the state. The analytic
+     * energy model does not have this limitation.
      *
      * @param rank Currrent rank
      */
@@ -880,6 +1042,7 @@ class DRAMCtrl : public AbstractMemory
     virtual void init() M5_ATTR_OVERRIDE;
     virtual void startup() M5_ATTR_OVERRIDE;
     virtual void drainResume() M5_ATTR_OVERRIDE;
+    virtual void resetStats() M5_ATTR_OVERRIDE;
 
   protected:
 
@@ -30,6 +30,13 @@ from MemObject import MemObject
 from m5.params import *
 from m5.proxy import *
 
+# the position of the valid bit and the core id in NoC addresses. Keep
+# this in sync with VALID_SHIFT, CORE_SHIFT and CORE_BITS in
+# src/mem/dtu/noc_addr.hh.
+NOC_VALID_SHIFT = 64 - 5
+NOC_CORE_BITS = 10
+NOC_CORE_SHIFT = NOC_VALID_SHIFT - NOC_CORE_BITS
+
 
 class BaseDtu(MemObject):
     type = 'BaseDtu'
@@ -85,3 +92,8 @@ class Dtu(BaseDtu):
     transfer_to_mem_request_latency = Param.Cycles(1, "Number of cycles passed for requesting something from local memory, when transferring")
     transfer_to_noc_latency = Param.Cycles(3, "Number of cycles passed from collecting the data in the buffer until sending it to the NoC");
     noc_to_transfer_latency = Param.Cycles(3, "Number of cycles passed from receiving data from the NoC until starting to transfer it to the local memory");
+
+    cache_bundle_cycles = Param.Cycles(4, "Number of cycles to wait for adjacent LLC prefetches to fetch them with one NoC request (0 = never bundle)")
+
+    wc_buffer_size = Param.MemorySize("512B", "Size of the aligned region in which LLC writebacks are combined into one NoC packet (0 = disabled)")
+    wc_timeout = Param.Cycles(16, "Number of cycles after which the write-combining buffer is flushed")
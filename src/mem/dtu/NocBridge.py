@@ -0,0 +1,46 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+from MemObject import MemObject
+from m5.params import *
+
+class NocBridge(MemObject):
+    type = 'NocBridge'
+    cxx_header = "mem/dtu/noc_bridge.hh"
+    slave = SlavePort("Receives the requests for remote PEs from our NoC")
+    master = MasterPort("Issues the requests of remote PEs into our NoC")
+    ranges = VectorParam.AddrRange([],
+        "NoC address ranges of the PEs simulated by our peers")
+    core_ranks = VectorParam.UInt32([],
+        "The rank of the process that simulates the PE with the given core id")
+    delay = Param.Latency('10ns', "NoC latency between the partitions")
+    multi_rank  = Param.UInt32('0', "Rank of this gem5 process (multi run)")
+    sync_start  = Param.Latency('0t', "first multi sync barrier")
+    sync_repeat = Param.Latency('0t',
+        "multi sync barrier repeat (0 = just below the delay)")
+    server_name = Param.String('localhost', "Message server name")
+    server_port = Param.UInt32('2200', "Message server port")
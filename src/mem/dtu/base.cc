@@ -105,7 +105,8 @@ BaseDtu::DtuSlavePort::DtuSlavePort(const std::string& _name, BaseDtu& _dtu)
     dtu(_dtu),
     busy(false),
     sendReqRetry(false),
-    pendingResponses()
+    pendingResponses(),
+    responses(0)
 { }
 
 void
@@ -136,6 +137,16 @@ BaseDtu::DtuSlavePort::schedTimingResp(PacketPtr pkt, Tick when)
 
     auto respEvent = new ResponseEvent(*this, pkt);
     dtu.schedule(respEvent, when);
+    responses++;
+}
+
+void
+BaseDtu::DtuSlavePort::responseSent()
+{
+    assert(responses > 0);
+    responses--;
+
+    dtu.checkDrained();
 }
 
 Tick
@@ -146,7 +157,10 @@ BaseDtu::DtuSlavePort::recvAtomic(PacketPtr pkt)
                           pkt->getAddr(),
                           pkt->getSize());
 
-    handleRequest(pkt, &busy, false);
+    // atomic requests are finished on return. thus, they never make us busy,
+    // which would otherwise stall the first timing request after a switch
+    bool dummy = false;
+    handleRequest(pkt, &dummy, false);
 
     return 0;
 }
@@ -210,6 +224,7 @@ BaseDtu::DtuSlavePort::recvRespRetry()
             DPRINTF(DtuSlavePort, "Poping %p from queue\n", ev);
             pendingResponses.pop();
             delete ev;
+            responseSent();
         }
         else
             break;
@@ -237,7 +252,10 @@ BaseDtu::DtuSlavePort::ResponseEvent::process()
         }
         // if it succeeded, let the event system delete the event
         else
+        {
             setFlags(AutoDelete);
+            port.responseSent();
+        }
     }
     else
     {
@@ -322,6 +340,32 @@ BaseDtu::init()
         cacheMemSlavePort.sendRangeChange();
 }
 
+bool
+BaseDtu::isIdle() const
+{
+    return nocSlavePort.isIdle() &&
+           icacheSlavePort.isIdle() &&
+           dcacheSlavePort.isIdle() &&
+           cacheMemSlavePort.isIdle() &&
+           !nocReqFinishedEvent.scheduled();
+}
+
+DrainState
+BaseDtu::drain()
+{
+    return isIdle() ? DrainState::Drained : DrainState::Draining;
+}
+
+void
+BaseDtu::checkDrained()
+{
+    if (drainState() == DrainState::Draining && isIdle())
+    {
+        DPRINTF(Dtu, "Drained\n");
+        signalDrainDone();
+    }
+}
+
 bool
 BaseDtu::NocSlavePort::handleRequest(PacketPtr pkt,
                                      bool *busy,
@@ -455,6 +499,8 @@ void
 BaseDtu::nocRequestFinished()
 {
     nocSlavePort.requestFinished();
+
+    checkDrained();
 }
 
 void
@@ -141,10 +141,17 @@ class BaseDtu : public MemObject
 
         std::queue<ResponseEvent*> pendingResponses;
 
+        // the responses that are scheduled or queued, but not sent yet
+        size_t responses;
+
+        void responseSent();
+
       public:
 
         DtuSlavePort(const std::string& _name, BaseDtu& _dtu);
 
+        bool isIdle() const { return !busy && responses == 0; }
+
         virtual bool handleRequest(PacketPtr pkt,
                                    bool *busy,
                                    bool functional) = 0;
@@ -238,6 +245,15 @@ class BaseDtu : public MemObject
 
     void init() override;
 
+    DrainState drain() override;
+
+    /**
+     * Signals the end of the drain, if we're draining and have become idle.
+     * Has to be called whenever the DTU might have finished its last
+     * outstanding operation.
+     */
+    void checkDrained();
+
     BaseSlavePort& getSlavePort(const std::string &n, PortID idx) override;
 
     BaseMasterPort& getMasterPort(const std::string &n, PortID idx) override;
@@ -287,6 +303,12 @@ class BaseDtu : public MemObject
 
   protected:
 
+    /**
+     * @return true if there is no request or response in flight and no
+     *         event scheduled that would create one
+     */
+    virtual bool isIdle() const;
+
     void nocRequestFinished();
 
     void sendDummyResponse(DtuSlavePort &port, PacketPtr pkt, bool functional);
@@ -33,6 +33,7 @@
 
 #include "arch/x86/m3/system.hh"
 #include "arch/x86/interrupts.hh"
+#include "base/intmath.hh"
 #include "debug/Dtu.hh"
 #include "debug/DtuBuf.hh"
 #include "debug/DtuCmd.hh"
@@ -82,11 +83,24 @@ Dtu::Dtu(DtuParams* p)
     xferUnit(new XferUnit(*this, p->block_size, p->buf_count, p->buf_size)),
     ptUnit(p->tlb_entries > 0 ? new PtUnit(*this) : NULL),
     executeCommandEvent(*this),
+    bundlePkts(),
+    bundleStart(),
+    bundleEnd(),
+    bundleEvent(*this),
+    wcPkts(),
+    wcBase(),
+    wcBytes(),
+    wcEvent(*this),
     cmdInProgress(false),
+    cmdEvents(0),
+    memReqsInFlight(0),
+    nocReqsInFlight(0),
     tlb(p->tlb_entries > 0 ? new DtuTlb(p->tlb_entries) : NULL),
     memPe(),
     memOffset(),
     atomicMode(p->system->isAtomicMode()),
+    ppMemEpAccess(NULL),
+    ppMsgSlotAccess(NULL),
     numEndpoints(p->num_endpoints),
     maxNocPacketSize(p->max_noc_packet_size),
     numCmdEpidBits(p->num_cmd_epid_bits),
@@ -99,10 +113,18 @@ Dtu::Dtu(DtuParams* p)
     startMsgTransferDelay(p->start_msg_transfer_delay),
     transferToMemRequestLatency(p->transfer_to_mem_request_latency),
     transferToNocLatency(p->transfer_to_noc_latency),
-    nocToTransferLatency(p->noc_to_transfer_latency)
+    nocToTransferLatency(p->noc_to_transfer_latency),
+    cacheBundleCycles(p->cache_bundle_cycles),
+    wcBufferSize(p->wc_buffer_size),
+    wcTimeout(p->wc_timeout)
 {
     assert(p->buf_size >= maxNocPacketSize);
 
+    fatal_if(wcBufferSize > maxNocPacketSize,
+             "The write-combining buffer exceeds the max. NoC packet size");
+    fatal_if(wcBufferSize > 0 && !isPowerOf2(wcBufferSize),
+             "The write-combining buffer size has to be a power of 2");
+
     M3X86System *sys = dynamic_cast<M3X86System*>(system);
     if (sys)
     {
@@ -111,10 +133,12 @@ Dtu::Dtu(DtuParams* p)
         DPRINTF(Dtu, "Using memory range %p .. %p\n",
             memOffset, memOffset + sys->memSize);
 
-        regs().set(DtuReg::RW_BARRIER, rwBarrier);
         regs().set(DtuReg::ROOT_PT, sys->getRootPt().getAddr());
         regs().set(DtuReg::VPE_ID, INVALID_VPE_ID);
     }
+
+    // without a barrier, all writes of the core would be ignored
+    regs().set(DtuReg::RW_BARRIER, rwBarrier);
 }
 
 Dtu::~Dtu()
@@ -126,6 +150,147 @@ Dtu::~Dtu()
     delete msgUnit;
 }
 
+void
+Dtu::regStats()
+{
+    BaseDtu::regStats();
+
+    cacheMemBundles
+        .name(name() + ".cacheMemBundles")
+        .desc("Number of NoC requests that fetched multiple LLC lines");
+    cacheMemBundledLines
+        .name(name() + ".cacheMemBundledLines")
+        .desc("Number of LLC lines fetched as part of a bundle");
+    cacheMemLinesPerBundle
+        .name(name() + ".cacheMemLinesPerBundle")
+        .desc("Average number of LLC lines per bundle")
+        .precision(2);
+    cacheMemLinesPerBundle = cacheMemBundledLines / cacheMemBundles;
+
+    wcWritebacks
+        .name(name() + ".wcWritebacks")
+        .desc("Number of LLC writebacks that entered the write-combining "
+              "buffer");
+    wcNocPackets
+        .name(name() + ".wcNocPackets")
+        .desc("Number of NoC packets sent from the write-combining buffer");
+    wcCoalescingRatio
+        .name(name() + ".wcCoalescingRatio")
+        .desc("Average number of writebacks per NoC packet")
+        .precision(2);
+    wcCoalescingRatio = wcWritebacks / wcNocPackets;
+}
+
+void
+Dtu::regProbePoints()
+{
+    BaseDtu::regProbePoints();
+
+    ppMemEpAccess = new ProbePointArg<EpAccess>(getProbeManager(),
+                                                "MemEpAccess");
+    ppMsgSlotAccess = new ProbePointArg<EpAccess>(getProbeManager(),
+                                                  "MsgSlotAccess");
+}
+
+bool
+Dtu::isIdle() const
+{
+    // a command or local transfer might still wait for a pagefault to be
+    // resolved by software. as nothing happens until its reply arrives,
+    // that's fine. remote transfers are finished, see XferUnit::isIdle.
+    return BaseDtu::isIdle() &&
+           !executeCommandEvent.scheduled() &&
+           cmdEvents == 0 &&
+           memReqsInFlight == 0 &&
+           nocReqsInFlight == 0 &&
+           bundlePkts.empty() &&
+           wcPkts.empty() &&
+           memUnit->isIdle() &&
+           xferUnit->isIdle() &&
+           (!ptUnit || ptUnit->isIdle());
+}
+
+DrainState
+Dtu::drain()
+{
+    // don't wait for the timeouts of the LLC request buffers
+    if (!bundlePkts.empty())
+        sendCacheMemBundle();
+    if (!wcPkts.empty())
+        flushWriteCombining(false);
+
+    DrainState state = BaseDtu::drain();
+    DPRINTF(Dtu, "Draining: %s\n",
+            state == DrainState::Drained ? "idle" : "busy");
+    return state;
+}
+
+void
+Dtu::drainResume()
+{
+    BaseDtu::drainResume();
+
+    // the CPUs might have been switched in the meantime
+    bool atomic = system->isAtomicMode();
+    if (atomic != atomicMode)
+    {
+        DPRINTF(Dtu, "Switching to %s mode\n", atomic ? "atomic" : "timing");
+        atomicMode = atomic;
+    }
+}
+
+void
+Dtu::serialize(CheckpointOut &cp) const
+{
+    // a command or transfer might still wait for a pagefault to be resolved.
+    // everything else is finished after the drain
+    panic_if(!isIdle(), "Checkpointing %s, which is not drained", name());
+
+    SERIALIZE_SCALAR(cmdInProgress);
+
+    regFile.serializeSection(cp, "regFile");
+    msgUnit->serializeSection(cp, "msgUnit");
+    xferUnit->serializeSection(cp, "xferUnit");
+    if (tlb)
+        tlb->serializeSection(cp, "tlb");
+    if (ptUnit)
+        ptUnit->serializeSection(cp, "ptUnit");
+}
+
+void
+Dtu::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(cmdInProgress);
+
+    regFile.unserializeSection(cp, "regFile");
+    msgUnit->unserializeSection(cp, "msgUnit");
+    xferUnit->unserializeSection(cp, "xferUnit");
+    if (tlb)
+        tlb->unserializeSection(cp, "tlb");
+    if (ptUnit)
+        ptUnit->unserializeSection(cp, "ptUnit");
+
+    // the pin of the core is not checkpointed; don't let it sleep while
+    // there are still messages pending
+    updateSuspendablePin();
+
+    DPRINTF(Dtu, "Restored state (command %s)\n",
+            cmdInProgress ? "in progress" : "idle");
+}
+
+PtUnit::Translation *
+Dtu::unserializeTranslation(CheckpointIn &cp)
+{
+    std::string type;
+    UNSERIALIZE_SCALAR(type);
+
+    if (type == "xfer")
+        return xferUnit->unserializeTranslation(cp);
+    if (type == "msg")
+        return msgUnit->unserializeTranslation(cp);
+    panic("Unknown translation type '%s' in checkpoint", type);
+}
+
 PacketPtr
 Dtu::generateRequest(Addr paddr, Addr size, MemCmd cmd)
 {
@@ -184,7 +349,10 @@ Dtu::executeCommand()
 {
     Command cmd = getCommand();
     if (cmd.opcode == Command::IDLE)
+    {
+        checkDrained();
         return;
+    }
 
     assert(!cmdInProgress);
 
@@ -245,6 +413,8 @@ Dtu::finishCommand(Error error)
     regFile.set(CmdReg::COMMAND, error << bits);
 
     cmdInProgress = false;
+
+    checkDrained();
 }
 
 Dtu::ExternCommand
@@ -280,8 +450,13 @@ Dtu::executeExternCommand(PacketPtr pkt)
     case ExternCommand::INV_TLB:
         if (tlb)
             tlb->clear();
+        // the address space might have changed
+        flushPredecoded();
         break;
     case ExternCommand::INV_CACHE:
+        flushPredecoded();
+        if (!wcPkts.empty())
+            flushWriteCombining(false);
         delay = Cycles(0);
         if(l1Cache)
         {
@@ -319,6 +494,26 @@ Dtu::wakeupCore()
     }
 }
 
+void
+Dtu::flushPredecoded()
+{
+    if (system->threadContexts.size() == 0)
+        return;
+
+    system->threadContexts[0]->getCpuPtr()->flushPredecoded();
+}
+
+void
+Dtu::invalidatePredecoded(PacketPtr pkt)
+{
+    if (system->threadContexts.size() == 0)
+        return;
+
+    // the core might execute code that we overwrite
+    BaseCPU *cpu = system->threadContexts[0]->getCpuPtr();
+    cpu->invalidatePredecoded(pkt->getAddr(), pkt->getSize());
+}
+
 void
 Dtu::updateSuspendablePin()
 {
@@ -349,6 +544,15 @@ Dtu::injectIRQ(int vector)
     sendIRQRequest(pkt);
 }
 
+void
+Dtu::sendFunctionalMemRequest(PacketPtr pkt)
+{
+    if (pkt->isWrite())
+        invalidatePredecoded(pkt);
+
+    dcacheMasterPort.sendFunctional(pkt);
+}
+
 void
 Dtu::sendMemRequest(PacketPtr pkt,
                     Addr virt,
@@ -369,6 +573,11 @@ Dtu::sendMemRequest(PacketPtr pkt,
 
     pkt->pushSenderState(senderState);
 
+    memReqsInFlight++;
+
+    if (pkt->isWrite())
+        invalidatePredecoded(pkt);
+
     if (atomicMode)
     {
         sendAtomicMemRequest(pkt);
@@ -389,9 +598,14 @@ Dtu::sendNocRequest(NocPacketType type,
     auto senderState = new NocSenderState();
     senderState->packetType = type;
     senderState->result = NONE;
+    senderState->srcCore = coreId;
 
     pkt->pushSenderState(senderState);
 
+    // requests without response (e.g., writebacks) are done once sent
+    if (functional || atomicMode || pkt->needsResponse())
+        nocReqsInFlight++;
+
     if (functional)
     {
         sendFunctionalNocRequest(pkt);
@@ -482,22 +696,31 @@ Dtu::completeNocRequest(PacketPtr pkt)
             pkt->getSize(), phys.coreId, phys.offset,
             senderState->result);
 
-        if (dynamic_cast<InitSenderState*>(pkt->senderState))
+        auto bundle = dynamic_cast<BundleSenderState*>(pkt->senderState);
+        if (bundle)
         {
-            // undo the change from handleCacheMemRequest
-            pkt->setAddr(phys.offset - memOffset);
-            pkt->req->setPaddr(phys.offset - memOffset);
             pkt->popSenderState();
+            finishCacheMemBundle(pkt, bundle, senderState->result);
         }
-
-        if (senderState->result != NONE)
+        else
         {
-            uint access = DtuTlb::INTERN | DtuTlb::GONE;
-            VPEGoneTranslation *trans = new VPEGoneTranslation(*this, pkt);
-            ptUnit->startTranslate(pkt->getAddr(), access, trans, true);
+            if (dynamic_cast<InitSenderState*>(pkt->senderState))
+            {
+                // undo the change from handleCacheMemRequest
+                pkt->setAddr(phys.offset - memOffset);
+                pkt->req->setPaddr(phys.offset - memOffset);
+                pkt->popSenderState();
+            }
+
+            if (senderState->result != NONE)
+            {
+                uint access = DtuTlb::INTERN | DtuTlb::GONE;
+                auto trans = new VPEGoneTranslation(*this, pkt);
+                ptUnit->startTranslate(pkt->getAddr(), access, trans, true);
+            }
+            else
+                sendCacheMemResponse(pkt, true);
         }
-        else
-            sendCacheMemResponse(pkt, true);
     }
     else if (senderState->packetType == NocPacketType::PAGEFAULT)
     {
@@ -515,6 +738,10 @@ Dtu::completeNocRequest(PacketPtr pkt)
     }
 
     delete senderState;
+
+    assert(nocReqsInFlight > 0);
+    nocReqsInFlight--;
+    checkDrained();
 }
 
 void
@@ -551,6 +778,10 @@ Dtu::completeMemRequest(PacketPtr pkt)
 
     delete senderState;
     freeRequest(pkt);
+
+    assert(memReqsInFlight > 0);
+    memReqsInFlight--;
+    checkDrained();
 }
 
 void
@@ -650,6 +881,36 @@ Dtu::handleCacheMemRequest(PacketPtr pkt, bool functional)
 
     Addr old = pkt->getAddr();
     NocAddr phys(pkt->getAddr());
+
+    // while draining or in atomic mode, don't hold back any requests
+    bool buffer = !functional && !atomicMode &&
+                  drainState() == DrainState::Running;
+    bool combine = buffer && phys.valid && wcBufferSize > 0 &&
+                   pkt->cmd == MemCmd::Writeback;
+
+    if (!wcPkts.empty())
+    {
+        // functional accesses should see all writebacks
+        if (functional)
+            flushWriteCombining(true);
+        // other accesses must not overtake buffered writebacks
+        else if (!combine &&
+                 pkt->getAddr() < wcBase + wcBufferSize &&
+                 pkt->getAddr() + pkt->getSize() > wcBase)
+            flushWriteCombining(false);
+    }
+
+    if (combine)
+    {
+        combineWriteback(pkt);
+        return true;
+    }
+
+    // reads of the LLC can be fetched together with adjacent lines
+    if (buffer && phys.valid && cacheBundleCycles > 0 &&
+        pkt->isRead() && !pkt->isWrite() && bundleCacheMemRequest(pkt))
+        return true;
+
     // special case: we check whether this is actually a NocAddr. this does
     // only happen when loading a program at startup, TLB misses in the core
     // and pseudoInst
@@ -678,6 +939,248 @@ Dtu::handleCacheMemRequest(PacketPtr pkt, bool functional)
     return true;
 }
 
+bool
+Dtu::bundleCacheMemRequest(PacketPtr pkt)
+{
+    bool prefetch = pkt->req->taskId() == ContextSwitchTaskId::Prefetcher;
+    Addr addr = pkt->getAddr();
+    Addr size = pkt->getSize();
+
+    if (!bundlePkts.empty())
+    {
+        NocAddr start(bundleStart);
+        NocAddr phys(addr);
+        bool adjacent = addr == bundleEnd || addr + size == bundleStart;
+        if (adjacent && phys.coreId == start.coreId &&
+            phys.vpeId == start.vpeId &&
+            bundleEnd - bundleStart + size <= maxNocPacketSize)
+        {
+            DPRINTF(DtuMem, "Adding %s read of LLC for %u bytes @ %d:%#x "
+                            "to bundle\n",
+                    prefetch ? "prefetch" : "demand",
+                    size, phys.coreId, phys.offset);
+
+            if (addr == bundleEnd)
+            {
+                bundlePkts.push_back(pkt);
+                bundleEnd += size;
+            }
+            else
+            {
+                bundlePkts.insert(bundlePkts.begin(), pkt);
+                bundleStart = addr;
+            }
+
+            // a demand read should not wait; neither should a full bundle
+            if (!prefetch ||
+                bundleEnd - bundleStart + size > maxNocPacketSize)
+                sendCacheMemBundle();
+            return true;
+        }
+    }
+
+    // only prefetches start a new bundle
+    if (!prefetch)
+        return false;
+
+    if (!bundlePkts.empty())
+        sendCacheMemBundle();
+
+    bundlePkts.push_back(pkt);
+    bundleStart = addr;
+    bundleEnd = addr + size;
+    schedule(bundleEvent, clockEdge(cacheBundleCycles));
+    return true;
+}
+
+void
+Dtu::sendCacheMemBundle()
+{
+    assert(!bundlePkts.empty());
+
+    if (bundleEvent.scheduled())
+        deschedule(bundleEvent);
+
+    // nothing to combine; send the request as usual
+    if (bundlePkts.size() == 1)
+    {
+        PacketPtr pkt = bundlePkts.front();
+        bundlePkts.clear();
+        sendNocRequest(Dtu::NocPacketType::CACHE_MEM_REQ, pkt, Cycles(1));
+        return;
+    }
+
+    NocAddr phys(bundleStart);
+    DPRINTF(DtuMem, "Sending bundle of %u LLC reads for %u bytes @ %d:%#x\n",
+            bundlePkts.size(), bundleEnd - bundleStart,
+            phys.coreId, phys.offset);
+
+    cacheMemBundles++;
+    cacheMemBundledLines += bundlePkts.size();
+
+    PacketPtr pkt = generateRequest(bundleStart,
+                                    bundleEnd - bundleStart,
+                                    MemCmd::ReadReq);
+
+    auto bundle = new BundleSenderState;
+    bundle->pkts.swap(bundlePkts);
+    pkt->pushSenderState(bundle);
+
+    sendNocRequest(Dtu::NocPacketType::CACHE_MEM_REQ, pkt, Cycles(1));
+}
+
+void
+Dtu::finishCacheMemBundle(PacketPtr pkt,
+                          BundleSenderState *bundle,
+                          Error result)
+{
+    for (PacketPtr orig : bundle->pkts)
+    {
+        if (result != NONE)
+        {
+            // let every request go through the usual path again
+            uint access = DtuTlb::INTERN | DtuTlb::GONE;
+            auto trans = new VPEGoneTranslation(*this, orig);
+            ptUnit->startTranslate(orig->getAddr(), access, trans, true);
+            continue;
+        }
+
+        // writebacks do not get a response
+        if (!orig->needsResponse())
+        {
+            delete orig;
+            continue;
+        }
+
+        orig->makeResponse();
+        if (orig->isRead())
+        {
+            Addr off = orig->getAddr() - pkt->getAddr();
+            orig->setData(pkt->getConstPtr<uint8_t>() + off);
+        }
+        orig->headerDelay = pkt->headerDelay;
+        orig->payloadDelay = pkt->payloadDelay;
+        sendCacheMemResponse(orig, true);
+    }
+
+    delete bundle;
+    freeRequest(pkt);
+}
+
+void
+Dtu::combineWriteback(PacketPtr pkt)
+{
+    Addr addr = pkt->getAddr();
+    Addr base = addr & ~(wcBufferSize - 1);
+
+    if (!wcPkts.empty() && base != wcBase)
+        flushWriteCombining(false);
+
+    if (wcPkts.empty())
+    {
+        wcBase = base;
+        wcBytes = 0;
+        schedule(wcEvent, clockEdge(wcTimeout));
+    }
+
+    assert(addr + pkt->getSize() <= wcBase + wcBufferSize);
+
+    NocAddr phys(addr);
+    DPRINTF(DtuMem, "Buffering writeback of LLC for %u bytes @ %d:%#x\n",
+            pkt->getSize(), phys.coreId, phys.offset);
+
+    wcWritebacks++;
+
+    auto it = wcPkts.find(addr);
+    if (it != wcPkts.end())
+    {
+        // the new writeback supersedes the buffered one
+        assert(it->second->getSize() == pkt->getSize());
+        delete it->second;
+        it->second = pkt;
+    }
+    else
+    {
+        wcPkts[addr] = pkt;
+        wcBytes += pkt->getSize();
+    }
+
+    if (wcBytes == wcBufferSize)
+        flushWriteCombining(false);
+}
+
+void
+Dtu::flushWriteCombining(bool functional)
+{
+    if (wcEvent.scheduled())
+        deschedule(wcEvent);
+
+    DPRINTF(DtuMem, "Flushing %u writebacks in region %#x%s\n",
+            wcPkts.size(), wcBase, functional ? " (functional)" : "");
+
+    // send one NoC packet per contiguous run of writebacks
+    std::vector<PacketPtr> run;
+    for (auto &wb : wcPkts)
+    {
+        if (!run.empty() &&
+            run.back()->getAddr() + run.back()->getSize() != wb.first)
+            sendCombinedWritebacks(run, functional);
+        run.push_back(wb.second);
+    }
+    if (!run.empty())
+        sendCombinedWritebacks(run, functional);
+
+    wcPkts.clear();
+    wcBytes = 0;
+}
+
+void
+Dtu::sendCombinedWritebacks(std::vector<PacketPtr> &pkts, bool functional)
+{
+    wcNocPackets++;
+
+    if (functional)
+    {
+        // the order to other functional accesses is all that matters here
+        for (PacketPtr pkt : pkts)
+        {
+            sendNocRequest(Dtu::NocPacketType::CACHE_MEM_REQ_FUNC,
+                           pkt,
+                           Cycles(0),
+                           true);
+            delete pkt;
+        }
+        pkts.clear();
+        return;
+    }
+
+    if (pkts.size() == 1)
+    {
+        sendNocRequest(Dtu::NocPacketType::CACHE_MEM_REQ,
+                       pkts.front(),
+                       Cycles(1));
+        pkts.clear();
+        return;
+    }
+
+    Addr start = pkts.front()->getAddr();
+    Addr size = pkts.back()->getAddr() + pkts.back()->getSize() - start;
+    PacketPtr pkt = generateRequest(start, size, MemCmd::WriteReq);
+
+    for (PacketPtr wb : pkts)
+    {
+        memcpy(pkt->getPtr<uint8_t>() + (wb->getAddr() - start),
+               wb->getConstPtr<uint8_t>(),
+               wb->getSize());
+    }
+
+    auto bundle = new BundleSenderState;
+    bundle->pkts.swap(pkts);
+    pkt->pushSenderState(bundle);
+
+    sendNocRequest(Dtu::NocPacketType::CACHE_MEM_REQ, pkt, Cycles(1));
+}
+
 int
 Dtu::translate(PtUnit::Translation *trans,
                PacketPtr pkt,
@@ -799,7 +1302,10 @@ Dtu::forwardRequestToRegFile(PacketPtr pkt, bool isCpuRequest)
                 schedule(executeCommandEvent, when);
         }
         else
+        {
             schedule(new ExecExternCmdEvent(*this, pkt), when);
+            cmdEvents++;
+        }
     }
     else
     {
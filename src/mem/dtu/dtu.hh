@@ -31,11 +31,14 @@
 #ifndef __MEM_DTU_DTU_HH__
 #define __MEM_DTU_DTU_HH__
 
+#include <map>
+
 #include "mem/dtu/base.hh"
 #include "mem/dtu/regfile.hh"
 #include "mem/dtu/noc_addr.hh"
 #include "mem/dtu/pt_unit.hh"
 #include "params/Dtu.hh"
+#include "sim/probe/probe.hh"
 
 class MessageUnit;
 class MemoryUnit;
@@ -130,14 +133,23 @@ class Dtu : public BaseDtu
 
     struct NocSenderState : public Packet::SenderState
     {
+        static const unsigned UNKNOWN_CORE = static_cast<unsigned>(-1);
+
         Error result;
         NocPacketType packetType;
+        // the core that sent the request (for tracing)
+        unsigned srcCore;
     };
 
     struct InitSenderState : public Packet::SenderState
     {
     };
 
+    struct BundleSenderState : public Packet::SenderState
+    {
+        std::vector<PacketPtr> pkts;
+    };
+
     struct Command
     {
         enum Opcode
@@ -158,6 +170,18 @@ class Dtu : public BaseDtu
         unsigned epid;
     };
 
+    /**
+     * The argument of the probe points for endpoint accesses
+     */
+    struct EpAccess
+    {
+        unsigned epId;
+        // the NoC address for memory endpoints, the slot for messages
+        Addr addr;
+        Addr size;
+        bool write;
+    };
+
     struct ExternCommand
     {
         enum Opcode
@@ -190,21 +214,25 @@ class Dtu : public BaseDtu
 
     void wakeupCore();
 
+    void flushPredecoded();
+
+    void invalidatePredecoded(PacketPtr pkt);
+
     void updateSuspendablePin();
 
     void injectIRQ(int vector);
 
     void forwardRequestToRegFile(PacketPtr pkt, bool isCpuRequest);
 
-    void sendFunctionalMemRequest(PacketPtr pkt)
-    {
-        dcacheMasterPort.sendFunctional(pkt);
-    }
+    void sendFunctionalMemRequest(PacketPtr pkt);
 
     void scheduleFinishOp(Cycles delay, Error error = NONE)
     {
         if (cmdInProgress)
+        {
             schedule(new FinishCommandEvent(*this, error), clockEdge(delay));
+            cmdEvents++;
+        }
     }
 
     void scheduleCommand(Cycles delay)
@@ -239,14 +267,30 @@ class Dtu : public BaseDtu
                         PtUnit::Translation *trans,
                         bool pf);
 
+    PtUnit::Translation *unserializeTranslation(CheckpointIn &cp);
+
     void finishMsgReceive(unsigned epId, Addr msgAddr);
 
     void handlePFResp(PacketPtr pkt);
 
     void printPacket(PacketPtr pkt) const;
 
+    void regStats() override;
+
+    void regProbePoints() override;
+
+    DrainState drain() override;
+
+    void drainResume() override;
+
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
 
+    bool isIdle() const override;
+
     Command getCommand();
 
     void executeCommand();
@@ -271,6 +315,23 @@ class Dtu : public BaseDtu
 
     bool handleCacheMemRequest(PacketPtr pkt, bool functional) override;
 
+    bool bundleCacheMemRequest(PacketPtr pkt);
+
+    void sendCacheMemBundle();
+
+    void finishCacheMemBundle(PacketPtr pkt,
+                              BundleSenderState *bundle,
+                              Error result);
+
+    void combineWriteback(PacketPtr pkt);
+
+    void flushWriteCombining(bool functional);
+
+    void sendCombinedWritebacks(std::vector<PacketPtr> &pkts,
+                                bool functional);
+
+    void writeCombiningTimeout() { flushWriteCombining(false); }
+
     int translate(PtUnit::Translation *trans,
                   PacketPtr pkt,
                   bool icache,
@@ -294,6 +355,34 @@ class Dtu : public BaseDtu
 
     EventWrapper<Dtu, &Dtu::executeCommand> executeCommandEvent;
 
+    /**
+     * The LLC reads that are collected to be fetched with a single NoC
+     * request. They are contiguous and ordered by address.
+     */
+    std::vector<PacketPtr> bundlePkts;
+    Addr bundleStart;
+    Addr bundleEnd;
+
+    EventWrapper<Dtu, &Dtu::sendCacheMemBundle> bundleEvent;
+
+    /**
+     * The write-combining buffer for writebacks of the LLC. It holds the
+     * writebacks to one aligned region of wcBufferSize bytes, ordered by
+     * address, until the region is full or wcTimeout expired.
+     */
+    std::map<Addr, PacketPtr> wcPkts;
+    Addr wcBase;
+    Addr wcBytes;
+
+    EventWrapper<Dtu, &Dtu::writeCombiningTimeout> wcEvent;
+
+    Stats::Scalar cacheMemBundles;
+    Stats::Scalar cacheMemBundledLines;
+    Stats::Formula cacheMemLinesPerBundle;
+    Stats::Scalar wcWritebacks;
+    Stats::Scalar wcNocPackets;
+    Stats::Formula wcCoalescingRatio;
+
     struct ExecExternCmdEvent : public Event
     {
         Dtu& dtu;
@@ -306,8 +395,10 @@ class Dtu : public BaseDtu
 
         void process() override
         {
+            dtu.cmdEvents--;
             dtu.executeExternCommand(pkt);
             setFlags(AutoDelete);
+            dtu.checkDrained();
         }
 
         const char* description() const override { return "ExecExternCmdEvent"; }
@@ -327,6 +418,7 @@ class Dtu : public BaseDtu
 
         void process() override
         {
+            dtu.cmdEvents--;
             dtu.finishCommand(error);
             setFlags(AutoDelete);
         }
@@ -391,6 +483,13 @@ class Dtu : public BaseDtu
 
     bool cmdInProgress;
 
+    // the scheduled FinishCommandEvents and ExecExternCmdEvents
+    unsigned cmdEvents;
+
+    // the requests to the memory and the NoC we still expect a response for
+    unsigned memReqsInFlight;
+    unsigned nocReqsInFlight;
+
   public:
 
     DtuTlb *tlb;
@@ -398,7 +497,15 @@ class Dtu : public BaseDtu
     unsigned memPe;
     Addr memOffset;
 
-    const bool atomicMode;
+    // follows the memory mode of the system; may change after a drain
+    bool atomicMode;
+
+    // notified on every remote access via a memory endpoint
+    ProbePointArg<EpAccess> *ppMemEpAccess;
+
+    // notified on every message that is received into or fetched from a
+    // slot of a receive endpoint
+    ProbePointArg<EpAccess> *ppMsgSlotAccess;
 
     const unsigned numEndpoints;
 
@@ -421,6 +528,11 @@ class Dtu : public BaseDtu
     const Cycles transferToMemRequestLatency;
     const Cycles transferToNocLatency;
     const Cycles nocToTransferLatency;
+
+    const Cycles cacheBundleCycles;
+
+    const Addr wcBufferSize;
+    const Cycles wcTimeout;
 };
 
 #endif // __MEM_DTU_DTU_HH__
@@ -70,6 +70,7 @@ MemoryUnit::startRead(const Dtu::Command& cmd)
     Addr nocAddr = NocAddr(ep.targetCore,
                            ep.vpeId,
                            ep.remoteAddr + offset).getAddr();
+    dtu.ppMemEpAccess->notify({cmd.arg, nocAddr, requestSize, false});
     auto pkt = dtu.generateRequest(nocAddr,
                                    requestSize,
                                    MemCmd::ReadReq);
@@ -106,8 +107,11 @@ MemoryUnit::startWrite(const Dtu::Command& cmd)
     assert(requestSize + offset >= requestSize);
     assert(requestSize + offset <= ep.remoteSize);
 
+    NocAddr nocAddr(ep.targetCore, ep.vpeId, ep.remoteAddr + offset);
+    dtu.ppMemEpAccess->notify({cmd.arg, nocAddr.getAddr(), requestSize, true});
+
     dtu.startTransfer(Dtu::TransferType::LOCAL_READ,
-                      NocAddr(ep.targetCore, ep.vpeId, ep.remoteAddr + offset),
+                      nocAddr,
                       localAddr,
                       requestSize);
 }
@@ -66,6 +66,11 @@ class MemoryUnit
 
     MemoryUnit(Dtu &_dtu) : dtu(_dtu), continueEvent(*this) {}
 
+    /**
+     * @return true if no read or write is about to be continued
+     */
+    bool isIdle() const { return !continueEvent.scheduled(); }
+
     /**
      * Starts a read -> NoC request
      */
@@ -334,7 +334,9 @@ found:
 
     dtu.regs().setRecvEp(epid, ep);
 
-    return ep.bufAddr + i * ep.msgSize;
+    Addr msgAddr = ep.bufAddr + i * ep.msgSize;
+    dtu.ppMsgSlotAccess->notify({epid, msgAddr, ep.msgSize, false});
+    return msgAddr;
 }
 
 int
@@ -481,6 +483,8 @@ MessageUnit::recvFromNoc(PacketPtr pkt)
     if (addr.vpeId == vpeId &&
         msgidx != ep.size)
     {
+        dtu.ppMsgSlotAccess->notify({epId, localAddr, pkt->getSize(), true});
+
         Dtu::MessageHeader* header = pkt->getPtr<Dtu::MessageHeader>();
 
         // Note that replyEpId is the Id of *our* sending EP
@@ -542,3 +546,51 @@ MessageUnit::recvFromNoc(PacketPtr pkt)
 
     return res;
 }
+
+PtUnit::Translation *
+MessageUnit::unserializeTranslation(CheckpointIn &cp)
+{
+    Addr virt;
+    unsigned epId;
+    UNSERIALIZE_SCALAR(virt);
+    UNSERIALIZE_SCALAR(epId);
+    return new Translation(*this, virt, epId);
+}
+
+void
+MessageUnit::serialize(CheckpointOut &cp) const
+{
+    paramOut(cp, "info.ready", info.ready);
+    paramOut(cp, "info.unlimcred", info.unlimcred);
+    paramOut(cp, "info.flags", info.flags);
+    paramOut(cp, "info.targetCoreId", info.targetCoreId);
+    paramOut(cp, "info.targetVpeId", info.targetVpeId);
+    paramOut(cp, "info.targetEpId", info.targetEpId);
+    paramOut(cp, "info.replyEpId", info.replyEpId);
+    paramOut(cp, "info.label", info.label);
+    paramOut(cp, "info.replyLabel", info.replyLabel);
+
+    arrayParamOut(cp, "header",
+                  reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    SERIALIZE_SCALAR(flagsPhys);
+    SERIALIZE_SCALAR(offset);
+}
+
+void
+MessageUnit::unserialize(CheckpointIn &cp)
+{
+    paramIn(cp, "info.ready", info.ready);
+    paramIn(cp, "info.unlimcred", info.unlimcred);
+    paramIn(cp, "info.flags", info.flags);
+    paramIn(cp, "info.targetCoreId", info.targetCoreId);
+    paramIn(cp, "info.targetVpeId", info.targetVpeId);
+    paramIn(cp, "info.targetEpId", info.targetEpId);
+    paramIn(cp, "info.replyEpId", info.replyEpId);
+    paramIn(cp, "info.label", info.label);
+    paramIn(cp, "info.replyLabel", info.replyLabel);
+
+    arrayParamIn(cp, "header",
+                 reinterpret_cast<uint8_t*>(&header), sizeof(header));
+    UNSERIALIZE_SCALAR(flagsPhys);
+    UNSERIALIZE_SCALAR(offset);
+}
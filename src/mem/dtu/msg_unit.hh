@@ -33,7 +33,7 @@
 
 #include "mem/dtu/dtu.hh"
 
-class MessageUnit
+class MessageUnit : public Serializable
 {
   private:
 
@@ -68,6 +68,13 @@ class MessageUnit
 
             delete this;
         }
+
+        void serialize(CheckpointOut &cp) const override
+        {
+            paramOut(cp, "type", std::string("msg"));
+            SERIALIZE_SCALAR(virt);
+            SERIALIZE_SCALAR(epId);
+        }
     };
 
   public:
@@ -111,6 +118,15 @@ class MessageUnit
     void finishMsgReceive(unsigned epId,
                           Addr msgAddr);
 
+    /**
+     * Recreates a header translation that was pending at a checkpoint
+     */
+    PtUnit::Translation *unserializeTranslation(CheckpointIn &cp);
+
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
     int allocSlot(size_t msgSize, unsigned epid, RecvEp &ep);
 
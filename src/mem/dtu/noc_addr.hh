@@ -31,6 +31,7 @@
 #ifndef __MEM_DTU_NOC_ADDR_HH__
 #define __MEM_DTU_NOC_ADDR_HH__
 
+// VALID_SHIFT, CORE_BITS and CORE_SHIFT are mirrored by NOC_* in Dtu.py
 #define ID_BITS         64
 #define RESERVED_BITS   5
 #define VALID_BITS      1
@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include "mem/dtu/noc_bridge.hh"
+
+#include <cstring>
+
+#include "debug/NocBridge.hh"
+#include "dev/multi_iface.hh"
+#include "dev/tcp_iface.hh"
+#include "mem/dtu/dtu.hh"
+#include "mem/dtu/noc_addr.hh"
+#include "sim/byteswap.hh"
+
+NocBridge::NocBridgeSlavePort::NocBridgeSlavePort(const std::string &_name,
+                                                  NocBridge &_bridge)
+    : SlavePort(_name, &_bridge),
+      bridge(_bridge),
+      respQueue(),
+      retryPending(false)
+{}
+
+void
+NocBridge::NocBridgeSlavePort::schedTimingResp(PacketPtr pkt)
+{
+    respQueue.push_back(pkt);
+    trySend();
+}
+
+void
+NocBridge::NocBridgeSlavePort::trySend()
+{
+    while (!respQueue.empty() && !retryPending)
+    {
+        if (sendTimingResp(respQueue.front()))
+            respQueue.pop_front();
+        else
+            retryPending = true;
+    }
+
+    bridge.checkDrained();
+}
+
+void
+NocBridge::NocBridgeSlavePort::recvRespRetry()
+{
+    assert(retryPending);
+    retryPending = false;
+    trySend();
+}
+
+AddrRangeList
+NocBridge::NocBridgeSlavePort::getAddrRanges() const
+{
+    return bridge.ranges;
+}
+
+Tick
+NocBridge::NocBridgeSlavePort::recvAtomic(PacketPtr pkt)
+{
+    panic("%s: atomic accesses to remote PEs are not supported (%s @ %#x)",
+          name(), pkt->cmdString(), pkt->getAddr());
+}
+
+void
+NocBridge::NocBridgeSlavePort::recvFunctional(PacketPtr pkt)
+{
+    bridge.forwardFunctional(pkt);
+}
+
+bool
+NocBridge::NocBridgeSlavePort::recvTimingReq(PacketPtr pkt)
+{
+    bridge.forwardRequest(pkt);
+    return true;
+}
+
+NocBridge::NocBridgeMasterPort::NocBridgeMasterPort(const std::string &_name,
+                                                    NocBridge &_bridge)
+    : MasterPort(_name, &_bridge),
+      bridge(_bridge),
+      reqQueue(),
+      retryPending(false)
+{}
+
+void
+NocBridge::NocBridgeMasterPort::schedTimingReq(PacketPtr pkt)
+{
+    reqQueue.push_back(pkt);
+    trySend();
+}
+
+void
+NocBridge::NocBridgeMasterPort::trySend()
+{
+    while (!reqQueue.empty() && !retryPending)
+    {
+        if (sendTimingReq(reqQueue.front()))
+            reqQueue.pop_front();
+        else
+            retryPending = true;
+    }
+}
+
+void
+NocBridge::NocBridgeMasterPort::recvReqRetry()
+{
+    assert(retryPending);
+    retryPending = false;
+    trySend();
+}
+
+bool
+NocBridge::NocBridgeMasterPort::recvTimingResp(PacketPtr pkt)
+{
+    bridge.forwardResponse(pkt);
+    return true;
+}
+
+NocBridge::NocBridge(const Params *p)
+    : MemObject(p),
+      slavePort(name() + ".slave", *this),
+      masterPort(name() + ".master", *this),
+      recvEvent(this),
+      multiIface(),
+      ranges(p->ranges.begin(), p->ranges.end()),
+      coreRanks(p->core_ranks.begin(), p->core_ranks.end()),
+      rank(p->multi_rank),
+      delay(p->delay),
+      nextTag(),
+      outstanding(),
+      remote()
+{
+    // the NoC latency is our lookahead. a packet sent right after a sync
+    // has to arrive after the next one
+    Tick syncRepeat = p->sync_repeat ? p->sync_repeat : delay - 1;
+    if (delay == 0 || syncRepeat >= delay)
+    {
+        fatal("%s: the sync period (%llu) has to be smaller than the NoC "
+              "latency (%llu)", name(), syncRepeat, delay);
+    }
+
+    multiIface = new TCPIface(p->server_name, p->server_port, rank,
+                              p->sync_start, syncRepeat, this);
+    multiIface->spawnRecvThread(&recvEvent, delay);
+}
+
+NocBridge::~NocBridge()
+{
+    delete multiIface;
+}
+
+BaseMasterPort&
+NocBridge::getMasterPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "master")
+        return masterPort;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+BaseSlavePort&
+NocBridge::getSlavePort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "slave")
+        return slavePort;
+    else
+        return MemObject::getSlavePort(if_name, idx);
+}
+
+void
+NocBridge::init()
+{
+    MemObject::init();
+
+    if (!slavePort.isConnected() || !masterPort.isConnected())
+        fatal("Both ports of the NoC bridge must be connected.\n");
+
+    slavePort.sendRangeChange();
+
+    multiIface->initRandom();
+}
+
+void
+NocBridge::startup()
+{
+    multiIface->startPeriodicSync();
+}
+
+void
+NocBridge::memWriteback()
+{
+    multiIface->drainDone();
+}
+
+bool
+NocBridge::isIdle() const
+{
+    return outstanding.empty() && remote.empty() &&
+           slavePort.isIdle() && masterPort.isIdle();
+}
+
+void
+NocBridge::checkDrained()
+{
+    if (isIdle())
+        signalDrainDone();
+}
+
+DrainState
+NocBridge::drain()
+{
+    return isIdle() ? DrainState::Drained : DrainState::Draining;
+}
+
+void
+NocBridge::serialize(CheckpointOut &cp) const
+{
+    // all in-flight requests are completed during the drain
+    assert(isIdle());
+    multiIface->serialize("multiIface", cp);
+
+    // the packet is stored by the MultiIface, but we own the event
+    bool recvScheduled = recvEvent.scheduled();
+    SERIALIZE_SCALAR(recvScheduled);
+    if (recvScheduled)
+    {
+        Tick recvTime = recvEvent.when();
+        SERIALIZE_SCALAR(recvTime);
+    }
+}
+
+void
+NocBridge::unserialize(CheckpointIn &cp)
+{
+    multiIface->unserialize("multiIface", cp);
+
+    bool recvScheduled;
+    UNSERIALIZE_SCALAR(recvScheduled);
+    if (recvScheduled)
+    {
+        Tick recvTime;
+        UNSERIALIZE_SCALAR(recvTime);
+        schedule(recvEvent, recvTime);
+    }
+}
+
+unsigned
+NocBridge::rankOf(Addr addr) const
+{
+    NocAddr noc(addr);
+    if (!noc.valid || noc.coreId >= coreRanks.size())
+        panic("%s: no PE owns the address %#x", name(), addr);
+    return coreRanks[noc.coreId];
+}
+
+void
+NocBridge::setAddress(uint8_t *mac, unsigned _rank) const
+{
+    // a locally administered unicast address per process. the message
+    // server learns them from the frames and routes by them
+    mac[0] = 0x02;
+    mac[1] = mac[2] = mac[3] = 0;
+    mac[4] = _rank >> 8;
+    mac[5] = _rank & 0xFF;
+}
+
+void
+NocBridge::sendFrame(MsgType type,
+                     PacketPtr pkt,
+                     unsigned dstRank,
+                     uint64_t tag,
+                     uint8_t nocType,
+                     uint8_t result)
+{
+    bool withData;
+    if (type == RESPONSE)
+        withData = pkt->isRead() && !pkt->isError();
+    else
+        withData = pkt->isWrite();
+    size_t dataSize = withData ? pkt->getSize() : 0;
+
+    EthPacketPtr frame =
+        std::make_shared<EthPacketData>(sizeof(FrameHeader) + dataSize);
+    frame->length = sizeof(FrameHeader) + dataSize;
+
+    FrameHeader *hdr = reinterpret_cast<FrameHeader*>(frame->data);
+    setAddress(hdr->dst, dstRank);
+    setAddress(hdr->src, rank);
+    hdr->frameType = htobe(FRAME_TYPE);
+    hdr->msgType = type;
+    hdr->nocType = nocType;
+    hdr->result = result;
+    hdr->error = pkt->isError();
+    hdr->srcRank = rank;
+    hdr->size = pkt->getSize();
+    hdr->cmd = pkt->cmd.toInt();
+    hdr->masterId = pkt->req->masterId();
+    hdr->tag = tag;
+    hdr->addr = pkt->getAddr();
+    hdr->flags = pkt->req->getFlags();
+    hdr->headerDelay = pkt->headerDelay;
+    hdr->payloadDelay = pkt->payloadDelay;
+    if (withData)
+        memcpy(hdr + 1, pkt->getConstPtr<uint8_t>(), dataSize);
+
+    multiIface->packetOut(frame, 0);
+    sentBytes += frame->length;
+}
+
+uint8_t
+NocBridge::nocTypeOf(PacketPtr pkt)
+{
+    auto senderState = dynamic_cast<Dtu::NocSenderState*>(pkt->senderState);
+    if (senderState)
+        return static_cast<uint8_t>(senderState->packetType);
+    return NO_NOC_TYPE;
+}
+
+void
+NocBridge::forwardRequest(PacketPtr pkt)
+{
+    unsigned dstRank = rankOf(pkt->getAddr());
+    uint64_t tag = nextTag++;
+
+    DPRINTF(NocBridge, "Forwarding %s request @ %#x (%u bytes) to rank %u "
+                       "[tag=%llu]\n",
+            pkt->cmdString(), pkt->getAddr(), pkt->getSize(), dstRank, tag);
+
+    bool needsResponse = pkt->needsResponse();
+    if (needsResponse)
+        outstanding[tag] = LocalRequest { pkt, curTick() };
+
+    // the delays of our NoC are passed on to the receiver
+    sendFrame(REQUEST, pkt, dstRank, tag, nocTypeOf(pkt), Dtu::NONE);
+
+    sentRequests++;
+
+    // we are responsible for packets that do not need a response
+    if (!needsResponse)
+    {
+        delete pkt->req;
+        delete pkt;
+    }
+}
+
+void
+NocBridge::forwardFunctional(PacketPtr pkt)
+{
+    // functional accesses can't wait for a peer. writes are posted, which is
+    // sufficient to load the boot modules into remote memory PEs
+    if (!pkt->isWrite())
+    {
+        panic("%s: functional reads of remote PEs are not supported (@ %#x)",
+              name(), pkt->getAddr());
+    }
+
+    unsigned dstRank = rankOf(pkt->getAddr());
+
+    DPRINTF(NocBridge, "Posting functional write @ %#x (%u bytes) "
+                       "to rank %u\n",
+            pkt->getAddr(), pkt->getSize(), dstRank);
+
+    sendFrame(FUNCTIONAL, pkt, dstRank, 0, nocTypeOf(pkt), Dtu::NONE);
+    pkt->makeResponse();
+}
+
+void
+NocBridge::forwardResponse(PacketPtr pkt)
+{
+    auto it = remote.find(pkt);
+    assert(it != remote.end());
+    RemoteRequest req = it->second;
+    remote.erase(it);
+
+    uint8_t nocType = NO_NOC_TYPE;
+    uint8_t result = Dtu::NONE;
+    auto senderState = dynamic_cast<Dtu::NocSenderState*>(pkt->senderState);
+    if (senderState)
+    {
+        nocType = static_cast<uint8_t>(senderState->packetType);
+        result = senderState->result;
+        pkt->popSenderState();
+        delete senderState;
+    }
+
+    DPRINTF(NocBridge, "Returning %s response @ %#x (%u bytes) to rank %u "
+                       "[tag=%llu, result=%u]\n",
+            pkt->cmdString(), pkt->getAddr(), pkt->getSize(), req.rank,
+            req.tag, result);
+
+    sendFrame(RESPONSE, pkt, req.rank, req.tag, nocType, result);
+
+    delete pkt->req;
+    delete pkt;
+
+    checkDrained();
+}
+
+void
+NocBridge::recvFrame()
+{
+    EthPacketPtr frame = multiIface->packetIn();
+
+    const FrameHeader *hdr =
+        reinterpret_cast<const FrameHeader*>(frame->data);
+    assert(frame->length >= sizeof(FrameHeader));
+
+    // the message server broadcasts frames to unknown destinations
+    uint8_t ourAddr[6];
+    setAddress(ourAddr, rank);
+    if (memcmp(hdr->dst, ourAddr, sizeof(ourAddr)) != 0 ||
+        betoh(hdr->frameType) != FRAME_TYPE)
+        return;
+
+    recvBytes += frame->length;
+
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(hdr + 1);
+    if (hdr->msgType == RESPONSE)
+        handleResponse(*hdr, data);
+    else
+        handleRequest(*hdr, data);
+}
+
+void
+NocBridge::handleRequest(const FrameHeader &hdr, const uint8_t *data)
+{
+    Request::Flags flags = hdr.flags;
+    auto req = new Request(hdr.addr, hdr.size, flags, hdr.masterId);
+    auto pkt = new Packet(req, MemCmd(static_cast<int>(hdr.cmd)));
+    pkt->allocate();
+    if (pkt->isWrite())
+        pkt->setData(data);
+    pkt->headerDelay = hdr.headerDelay;
+    pkt->payloadDelay = hdr.payloadDelay;
+
+    Dtu::NocSenderState *senderState = NULL;
+    if (hdr.nocType != NO_NOC_TYPE)
+    {
+        senderState = new Dtu::NocSenderState();
+        senderState->packetType =
+            static_cast<Dtu::NocPacketType>(hdr.nocType);
+        senderState->result = Dtu::NONE;
+        senderState->srcCore = Dtu::NocSenderState::UNKNOWN_CORE;
+        pkt->pushSenderState(senderState);
+    }
+
+    if (hdr.msgType == FUNCTIONAL)
+    {
+        DPRINTF(NocBridge, "Applying functional write @ %#x (%u bytes) "
+                           "from rank %u\n",
+                hdr.addr, hdr.size, hdr.srcRank);
+
+        masterPort.sendFunctional(pkt);
+        if (senderState)
+            pkt->popSenderState();
+        delete senderState;
+        delete req;
+        delete pkt;
+        return;
+    }
+
+    DPRINTF(NocBridge, "Received %s request @ %#x (%u bytes) from rank %u "
+                       "[tag=%llu]\n",
+            pkt->cmdString(), hdr.addr, hdr.size, hdr.srcRank, hdr.tag);
+
+    if (pkt->needsResponse())
+        remote[pkt] = RemoteRequest { hdr.tag, hdr.srcRank };
+
+    recvRequests++;
+    masterPort.schedTimingReq(pkt);
+}
+
+void
+NocBridge::handleResponse(const FrameHeader &hdr, const uint8_t *data)
+{
+    auto it = outstanding.find(hdr.tag);
+    if (it == outstanding.end())
+        panic("%s: response for unknown request (tag=%llu)", name(), hdr.tag);
+    PacketPtr pkt = it->second.pkt;
+    roundTrip.sample(curTick() - it->second.sendTick);
+    outstanding.erase(it);
+
+    DPRINTF(NocBridge, "Received %s response @ %#x (%u bytes) from rank %u "
+                       "[tag=%llu, result=%u]\n",
+            pkt->cmdString(), pkt->getAddr(), pkt->getSize(), hdr.srcRank,
+            hdr.tag, hdr.result);
+
+    auto senderState = dynamic_cast<Dtu::NocSenderState*>(pkt->senderState);
+    if (senderState)
+        senderState->result = static_cast<Dtu::Error>(hdr.result);
+
+    pkt->makeResponse();
+    if (hdr.error)
+        pkt->setBadAddress();
+    else if (pkt->isRead())
+        pkt->setData(data);
+
+    // the receiver might have changed the address (see MemoryUnit)
+    pkt->setAddr(hdr.addr);
+    pkt->headerDelay = hdr.headerDelay;
+    pkt->payloadDelay = hdr.payloadDelay;
+
+    slavePort.schedTimingResp(pkt);
+}
+
+void
+NocBridge::regStats()
+{
+    MemObject::regStats();
+
+    sentRequests
+        .name(name() + ".sentRequests")
+        .desc("Number of requests forwarded to peers");
+    recvRequests
+        .name(name() + ".recvRequests")
+        .desc("Number of requests received from peers");
+    sentBytes
+        .name(name() + ".sentBytes")
+        .desc("Number of bytes sent to peers");
+    recvBytes
+        .name(name() + ".recvBytes")
+        .desc("Number of bytes received from peers");
+    roundTrip
+        .init(16)
+        .name(name() + ".roundTrip")
+        .desc("Round-trip time of forwarded requests (in ticks)")
+        .flags(Stats::nozero);
+}
+
+NocBridge*
+NocBridgeParams::create()
+{
+    return new NocBridge(this);
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/* @file
+ * Bridge that connects the NoC of this gem5 process with the NoCs of its
+ * peer processes in a multi gem5 run.
+ *
+ * See comments in dev/multi_iface.hh for a generic description of multi
+ * gem5 simulations. Each process simulates a subset of the PEs. The bridge
+ * claims the NoC address ranges of all PEs that are simulated elsewhere and
+ * forwards the requests for them to the process that owns the addressed core
+ * (determined by NocAddr::coreId). The responses are sent back the same way.
+ * Packets are transferred as frames over the existing MultiIface, so that
+ * the message server and the synchronisation are shared with the Ethernet
+ * links. The simulated latency between the NoCs is used as the lookahead of
+ * the periodic synchronisation, i.e., the sync period has to be smaller than
+ * the latency.
+ */
+
+#ifndef __MEM_DTU_NOC_BRIDGE_HH__
+#define __MEM_DTU_NOC_BRIDGE_HH__
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "dev/etherpkt.hh"
+#include "mem/mem_object.hh"
+#include "params/NocBridge.hh"
+
+class MultiIface;
+
+class NocBridge : public MemObject
+{
+  protected:
+
+    enum MsgType : uint8_t
+    {
+        REQUEST,
+        RESPONSE,
+        FUNCTIONAL,
+    };
+
+    static const uint16_t FRAME_TYPE        = 0x88b5;
+    static const uint8_t NO_NOC_TYPE        = 0xFF;
+
+    /**
+     * The header that precedes each packet on the wire. The first part
+     * mimics an Ethernet header, because the message server routes the
+     * frames by their MAC addresses.
+     */
+    struct FrameHeader
+    {
+        uint8_t dst[6];
+        uint8_t src[6];
+        uint16_t frameType;
+
+        uint8_t msgType;
+        // the Dtu::NocPacketType or NO_NOC_TYPE for non-DTU packets
+        uint8_t nocType;
+        // the Dtu::Error of the receiving DTU (responses only)
+        uint8_t result;
+        uint8_t error;
+        uint32_t srcRank;
+        uint32_t size;
+        uint32_t cmd;
+        uint16_t masterId;
+        uint64_t tag;
+        uint64_t addr;
+        uint64_t flags;
+        uint64_t headerDelay;
+        uint64_t payloadDelay;
+    } M5_ATTR_PACKED;
+
+    class NocBridgeSlavePort : public SlavePort
+    {
+      private:
+
+        NocBridge &bridge;
+
+        std::deque<PacketPtr> respQueue;
+
+        bool retryPending;
+
+      public:
+
+        NocBridgeSlavePort(const std::string &_name, NocBridge &_bridge);
+
+        void schedTimingResp(PacketPtr pkt);
+
+        bool isIdle() const { return respQueue.empty(); }
+
+      protected:
+
+        void trySend();
+
+        AddrRangeList getAddrRanges() const M5_ATTR_OVERRIDE;
+
+        Tick recvAtomic(PacketPtr pkt) M5_ATTR_OVERRIDE;
+
+        void recvFunctional(PacketPtr pkt) M5_ATTR_OVERRIDE;
+
+        bool recvTimingReq(PacketPtr pkt) M5_ATTR_OVERRIDE;
+
+        void recvRespRetry() M5_ATTR_OVERRIDE;
+    };
+
+    class NocBridgeMasterPort : public MasterPort
+    {
+      private:
+
+        NocBridge &bridge;
+
+        std::deque<PacketPtr> reqQueue;
+
+        bool retryPending;
+
+      public:
+
+        NocBridgeMasterPort(const std::string &_name, NocBridge &_bridge);
+
+        void schedTimingReq(PacketPtr pkt);
+
+        bool isIdle() const { return reqQueue.empty(); }
+
+      protected:
+
+        void trySend();
+
+        bool recvTimingResp(PacketPtr pkt) M5_ATTR_OVERRIDE;
+
+        void recvReqRetry() M5_ATTR_OVERRIDE;
+
+        void recvRangeChange() M5_ATTR_OVERRIDE { }
+    };
+
+    /**
+     * A request of our PEs that waits for the response from a peer.
+     */
+    struct LocalRequest
+    {
+        PacketPtr pkt;
+        Tick sendTick;
+    };
+
+    /**
+     * A request that we received from a peer and forwarded into our NoC.
+     */
+    struct RemoteRequest
+    {
+        uint64_t tag;
+        unsigned rank;
+    };
+
+  public:
+
+    typedef NocBridgeParams Params;
+
+    NocBridge(const Params *p);
+
+    ~NocBridge();
+
+    BaseMasterPort& getMasterPort(const std::string &if_name,
+                                  PortID idx = InvalidPortID) M5_ATTR_OVERRIDE;
+
+    BaseSlavePort& getSlavePort(const std::string &if_name,
+                                PortID idx = InvalidPortID) M5_ATTR_OVERRIDE;
+
+    void init() M5_ATTR_OVERRIDE;
+
+    Tick linkLatency() const M5_ATTR_OVERRIDE { return delay; }
+
+    void startup() M5_ATTR_OVERRIDE;
+
+    void memWriteback() M5_ATTR_OVERRIDE;
+
+    DrainState drain() M5_ATTR_OVERRIDE;
+
+    void serialize(CheckpointOut &cp) const M5_ATTR_OVERRIDE;
+
+    void unserialize(CheckpointIn &cp) M5_ATTR_OVERRIDE;
+
+    void regStats() M5_ATTR_OVERRIDE;
+
+  private:
+
+    static uint8_t nocTypeOf(PacketPtr pkt);
+
+    unsigned rankOf(Addr addr) const;
+
+    void setAddress(uint8_t *mac, unsigned rank) const;
+
+    void sendFrame(MsgType type, PacketPtr pkt, unsigned rank, uint64_t tag,
+                   uint8_t nocType, uint8_t result);
+
+    void forwardRequest(PacketPtr pkt);
+
+    void forwardFunctional(PacketPtr pkt);
+
+    void forwardResponse(PacketPtr pkt);
+
+    void recvFrame();
+
+    void handleRequest(const FrameHeader &hdr, const uint8_t *data);
+
+    void handleResponse(const FrameHeader &hdr, const uint8_t *data);
+
+    bool isIdle() const;
+
+    void checkDrained();
+
+    typedef EventWrapper<NocBridge, &NocBridge::recvFrame> RecvEvent;
+    friend void RecvEvent::process();
+
+    NocBridgeSlavePort slavePort;
+
+    NocBridgeMasterPort masterPort;
+
+    RecvEvent recvEvent;
+
+    MultiIface *multiIface;
+
+    const AddrRangeList ranges;
+
+    const std::vector<unsigned> coreRanks;
+
+    const unsigned rank;
+
+    const Tick delay;
+
+    uint64_t nextTag;
+
+    std::unordered_map<uint64_t, LocalRequest> outstanding;
+
+    std::unordered_map<PacketPtr, RemoteRequest> remote;
+
+    Stats::Scalar sentRequests;
+    Stats::Scalar recvRequests;
+    Stats::Scalar sentBytes;
+    Stats::Scalar recvBytes;
+    Stats::Histogram roundTrip;
+};
+
+#endif // __MEM_DTU_NOC_BRIDGE_HH__
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include "base/callback.hh"
+#include "base/output.hh"
+#include "debug/NocTrace.hh"
+#include "mem/dtu/dtu.hh"
+#include "mem/dtu/noc_addr.hh"
+#include "mem/dtu/noc_trace_probe.hh"
+#include "proto/noc.pb.h"
+#include "sim/probe/mem.hh"
+#include "sim/sim_exit.hh"
+
+NocTraceProbe::NocTraceProbe(const NocTraceProbeParams *p)
+    : ProbeListenerObject(p),
+      traceStream(),
+      nextId(1),
+      sources(),
+      inFlight()
+{
+    std::string filename = simout.resolve(p->trace_file);
+    traceStream = new ProtoOutputStream(filename);
+
+    ProtoMessage::NocHeader header_msg;
+    header_msg.set_obj_id(name());
+    header_msg.set_tick_freq(SimClock::Frequency);
+    traceStream->write(header_msg);
+
+    // the destructor is not called, so flush the stream on exit
+    registerExitCallback(
+        new MakeCallback<NocTraceProbe, &NocTraceProbe::closeStreams>(this));
+}
+
+void
+NocTraceProbe::closeStreams()
+{
+    delete traceStream;
+    traceStream = NULL;
+}
+
+void
+NocTraceProbe::regProbeListeners()
+{
+    typedef ProbeListenerArg<NocTraceProbe, PacketPtr> PacketListener;
+
+    listeners.push_back(new PacketListener(this, "PktRequestCPU",
+                                           &NocTraceProbe::handleRequest));
+    listeners.push_back(new PacketListener(this, "PktResponseCPU",
+                                           &NocTraceProbe::handleResponse));
+}
+
+void
+NocTraceProbe::handleRequest(const PacketPtr &pkt)
+{
+    // ignore everything that has not been sent by a DTU (e.g., the UART)
+    auto senderState = pkt->findNextSenderState<Dtu::NocSenderState>();
+    if (!senderState ||
+        senderState->srcCore == Dtu::NocSenderState::UNKNOWN_CORE)
+        return;
+
+    unsigned src = senderState->srcCore;
+    uint64_t id = nextId++;
+
+    ProtoMessage::NocPacket pkt_msg;
+    pkt_msg.set_id(id);
+    pkt_msg.set_tick(curTick());
+    pkt_msg.set_src(src);
+    pkt_msg.set_dst(NocAddr(pkt->getAddr()).coreId);
+    pkt_msg.set_type(static_cast<uint32_t>(senderState->packetType));
+    pkt_msg.set_cmd(pkt->cmdToIndex());
+    pkt_msg.set_addr(pkt->getAddr());
+    pkt_msg.set_size(pkt->getSize());
+
+    auto it = sources.find(src);
+    if (it != sources.end())
+    {
+        Source &s = it->second;
+        pkt_msg.set_dep(s.lastId);
+        pkt_msg.set_dep_resp(s.respArrived);
+        pkt_msg.set_delay(curTick() - (s.respArrived ? s.respTick
+                                                     : s.lastSend));
+    }
+
+    DPRINTF(NocTrace, "%u -> %u: id=%llu cmd=%s addr=%#x size=%u dep=%llu\n",
+            src, pkt_msg.dst(), id, pkt->cmdString(), pkt->getAddr(),
+            pkt->getSize(), pkt_msg.dep());
+
+    traceStream->write(pkt_msg);
+
+    Source &s = sources[src];
+    s.lastId = id;
+    s.lastSend = curTick();
+    s.respArrived = false;
+    s.respTick = 0;
+
+    inFlight[pkt] = InFlight{id, src};
+}
+
+void
+NocTraceProbe::handleResponse(const PacketPtr &pkt)
+{
+    auto it = inFlight.find(pkt);
+    if (it == inFlight.end())
+        return;
+
+    // only the response to the last packet of a source is a dependency
+    Source &s = sources[it->second.src];
+    if (s.lastId == it->second.id)
+    {
+        s.respArrived = true;
+        s.respTick = curTick();
+    }
+
+    inFlight.erase(it);
+}
+
+NocTraceProbe*
+NocTraceProbeParams::create()
+{
+    return new NocTraceProbe(this);
+}
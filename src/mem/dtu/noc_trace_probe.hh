@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __MEM_DTU_NOC_TRACE_PROBE_HH__
+#define __MEM_DTU_NOC_TRACE_PROBE_HH__
+
+#include <unordered_map>
+
+#include "mem/packet.hh"
+#include "params/NocTraceProbe.hh"
+#include "proto/protoio.hh"
+#include "sim/probe/probe.hh"
+
+/**
+ * Records the requests that DTUs send over the NoC into a protobuf trace
+ * (see proto/noc.proto). It is attached to the root NoC and listens to the
+ * accepted requests and the outgoing responses. Each packet is recorded
+ * with its source and destination core, the NoC packet type and its
+ * dependency on the previous packet of the same source. That allows to
+ * replay the trace on a different NoC model with NocTraceReplay while
+ * preserving the order and the think times of each source.
+ */
+class NocTraceProbe : public ProbeListenerObject
+{
+  public:
+    NocTraceProbe(const NocTraceProbeParams *p);
+
+    void regProbeListeners() override;
+
+  private:
+    void handleRequest(const PacketPtr &pkt);
+
+    void handleResponse(const PacketPtr &pkt);
+
+    void closeStreams();
+
+    struct Source
+    {
+        // the last packet sent by this source
+        uint64_t lastId;
+        Tick lastSend;
+        // whether and when its response arrived
+        bool respArrived;
+        Tick respTick;
+    };
+
+    struct InFlight
+    {
+        uint64_t id;
+        unsigned src;
+    };
+
+    ProtoOutputStream *traceStream;
+
+    uint64_t nextId;
+
+    std::unordered_map<unsigned, Source> sources;
+
+    std::unordered_map<PacketPtr, InFlight> inFlight;
+};
+
+#endif // __MEM_DTU_NOC_TRACE_PROBE_HH__
@@ -58,9 +58,12 @@ PtUnit::TranslateEvent::requestPTE()
 void
 PtUnit::TranslateEvent::process()
 {
+    unit.scheduled--;
+
     if (pf)
     {
         requestPTE();
+        unit.dtu.checkDrained();
         return;
     }
 
@@ -78,6 +81,8 @@ PtUnit::TranslateEvent::process()
     }
     else
         requestPTE();
+
+    unit.dtu.checkDrained();
 }
 
 void
@@ -228,7 +233,7 @@ PtUnit::sendPagefaultMsg(TranslateEvent *ev, Addr virt, uint access)
     header.label = ep.label;
     header.senderEpId = pfep;
     header.senderCoreId = dtu.coreId;
-    header.replyLabel = reinterpret_cast<uint64_t>(ev);
+    header.replyLabel = ev->id;
     // not used
     header.replyEpId = 0;
 
@@ -267,7 +272,7 @@ void
 PtUnit::sendingPfFailed(PacketPtr pkt, int error)
 {
     Dtu::MessageHeader* header = pkt->getPtr<Dtu::MessageHeader>();
-    TranslateEvent *ev = reinterpret_cast<TranslateEvent*>(header->replyLabel);
+    TranslateEvent *ev = sentPagefault(header->replyLabel);
 
     DPRINTFS(DtuPf, (&dtu),
         "Sending Pagefault (%s @ %p) failed (%d); notifying kernel\n",
@@ -277,7 +282,7 @@ PtUnit::sendingPfFailed(PacketPtr pkt, int error)
     {
         ev->pf = true;
         ev->toKernel = true;
-        dtu.schedule(ev, dtu.clockEdge(Cycles(1)));
+        schedule(ev, Cycles(1));
     }
     else
     {
@@ -296,7 +301,7 @@ PtUnit::finishPagefault(PacketPtr pkt)
     size_t expSize = sizeof(Dtu::MessageHeader) + sizeof(uint64_t);
     int error = pkt->getSize() == expSize ? *errorPtr : -1;
 
-    TranslateEvent *ev = reinterpret_cast<TranslateEvent*>(header->label);
+    TranslateEvent *ev = sentPagefault(header->label);
 
     DPRINTFS(Dtu, (&dtu),
         "\e[1m[rv <- %u]\e[0m %lu bytes for Pagefault (%s @ %p)\n",
@@ -351,7 +356,16 @@ PtUnit::finishPagefault(PacketPtr pkt)
     // retry the translation
     ev->pf = false;
     ev->toKernel = false;
-    dtu.schedule(ev, dtu.clockEdge(Cycles(1)));
+    schedule(ev, Cycles(1));
+}
+
+PtUnit::TranslateEvent *
+PtUnit::sentPagefault(uint64_t id)
+{
+    // only the first pagefault in the queue has been sent
+    panic_if(pfqueue.empty() || pfqueue.front()->id != id,
+             "Unexpected pagefault reply (label %#lx)", id);
+    return pfqueue.front();
 }
 
 void PtUnit::mkTlbEntry(Addr virt, NocAddr phys, uint flags)
@@ -374,10 +388,17 @@ PtUnit::nextPagefault(TranslateEvent *ev, Cycles delay)
     if (!pfqueue.empty())
     {
         TranslateEvent *ev = pfqueue.front();
-        dtu.schedule(ev, dtu.clockEdge(delay));
+        schedule(ev, delay);
     }
 }
 
+void
+PtUnit::schedule(TranslateEvent *ev, Cycles delay)
+{
+    dtu.schedule(ev, dtu.clockEdge(delay));
+    scheduled++;
+}
+
 PacketPtr
 PtUnit::createPacket(Addr virt, Addr ptAddr, int level)
 {
@@ -449,6 +470,7 @@ void
 PtUnit::startTranslate(Addr virt, uint access, Translation *trans, bool pf)
 {
     TranslateEvent *event = new TranslateEvent(*this);
+    event->id = nextId++;
     event->level = DtuTlb::LEVEL_CNT - 1;
     event->virt = virt;
     event->access = access;
@@ -457,5 +479,81 @@ PtUnit::startTranslate(Addr virt, uint access, Translation *trans, bool pf)
     event->pf = pf;
     event->toKernel = false;
 
-    dtu.schedule(event, dtu.clockEdge(Cycles(1)));
+    schedule(event, Cycles(1));
+}
+
+void
+PtUnit::serialize(CheckpointOut &cp) const
+{
+    // all translations that are not waiting for a pagefault are finished
+    // or in progress, which is prevented by the drain
+    assert(isIdle());
+
+    SERIALIZE_SCALAR(lastPfAddr);
+    SERIALIZE_SCALAR(lastPfCnt);
+    SERIALIZE_SCALAR(nextId);
+
+    size_t pfcount = pfqueue.size();
+    SERIALIZE_SCALAR(pfcount);
+
+    size_t i = 0;
+    for (auto ev = pfqueue.begin(); ev != pfqueue.end(); ++ev, ++i)
+    {
+        ScopedCheckpointSection sec(cp, csprintf("pf%lu", i));
+
+        paramOut(cp, "id", (*ev)->id);
+        paramOut(cp, "level", (*ev)->level);
+        paramOut(cp, "virt", (*ev)->virt);
+        paramOut(cp, "ptAddr", (*ev)->ptAddr);
+        paramOut(cp, "access", (*ev)->access);
+        paramOut(cp, "toKernel", (*ev)->toKernel);
+        paramOut(cp, "pf", (*ev)->pf);
+
+        size_t transcount = (*ev)->trans.size();
+        SERIALIZE_SCALAR(transcount);
+        for (size_t t = 0; t < transcount; ++t)
+        {
+            ScopedCheckpointSection sec(cp, csprintf("trans%lu", t));
+            (*ev)->trans[t]->serialize(cp);
+        }
+    }
+}
+
+void
+PtUnit::unserialize(CheckpointIn &cp)
+{
+    assert(pfqueue.empty());
+
+    UNSERIALIZE_SCALAR(lastPfAddr);
+    UNSERIALIZE_SCALAR(lastPfCnt);
+    UNSERIALIZE_SCALAR(nextId);
+
+    size_t pfcount;
+    UNSERIALIZE_SCALAR(pfcount);
+
+    // the first one waits for the reply of the pagefault handler, the others
+    // are sent afterwards, as usual
+    for (size_t i = 0; i < pfcount; ++i)
+    {
+        ScopedCheckpointSection sec(cp, csprintf("pf%lu", i));
+
+        TranslateEvent *ev = new TranslateEvent(*this);
+        paramIn(cp, "id", ev->id);
+        paramIn(cp, "level", ev->level);
+        paramIn(cp, "virt", ev->virt);
+        paramIn(cp, "ptAddr", ev->ptAddr);
+        paramIn(cp, "access", ev->access);
+        paramIn(cp, "toKernel", ev->toKernel);
+        paramIn(cp, "pf", ev->pf);
+
+        size_t transcount;
+        UNSERIALIZE_SCALAR(transcount);
+        for (size_t t = 0; t < transcount; ++t)
+        {
+            ScopedCheckpointSection sec(cp, csprintf("trans%lu", t));
+            ev->trans.push_back(dtu.unserializeTranslation(cp));
+        }
+
+        pfqueue.push_back(ev);
+    }
 }
@@ -36,12 +36,13 @@
 #include "mem/packet.hh"
 #include "mem/dtu/noc_addr.hh"
 #include "mem/dtu/tlb.hh"
+#include "sim/serialize.hh"
 
 #include <list>
 
 class Dtu;
 
-class PtUnit
+class PtUnit : public Serializable
 {
   public:
 
@@ -53,6 +54,16 @@ class PtUnit
         {}
 
         virtual void finished(bool success, const NocAddr &phys) = 0;
+
+        /**
+         * Stores what is needed to recreate the translation with
+         * Dtu::unserializeTranslation. Translations on behalf of other
+         * components can't be pending in a drained system.
+         */
+        virtual void serialize(CheckpointOut &cp) const
+        {
+            panic("Pending translation can't be checkpointed");
+        }
     };
 
     BitUnion64(PageTableEntry)
@@ -83,6 +94,9 @@ class PtUnit
     {
         PtUnit& unit;
 
+        // used as the label of the pagefault message
+        uint64_t id;
+
         int level;
         Addr virt;
         Addr ptAddr;
@@ -92,8 +106,8 @@ class PtUnit
         bool pf;
 
         TranslateEvent(PtUnit& _unit)
-            : unit(_unit), level(), virt(), ptAddr(), access(), trans(),
-              toKernel(), pf()
+            : unit(_unit), id(), level(), virt(), ptAddr(), access(),
+              trans(), toKernel(), pf()
         {}
 
         void process() override;
@@ -121,9 +135,17 @@ class PtUnit
 
   public:
 
-    PtUnit(Dtu& _dtu) : dtu(_dtu), lastPfAddr(-1), lastPfCnt(0), pfqueue()
+    PtUnit(Dtu& _dtu)
+        : dtu(_dtu), lastPfAddr(-1), lastPfCnt(0), pfqueue(), nextId(1),
+          scheduled(0)
     {}
 
+    /**
+     * @return true if no translation is about to continue. Translations
+     *         might still wait for memory or a pagefault reply
+     */
+    bool isIdle() const { return scheduled == 0; }
+
     bool translateFunctional(Addr virt, uint access, NocAddr *phys);
 
     void startTranslate(Addr virt, uint access, Translation *trans, bool pf);
@@ -138,14 +160,22 @@ class PtUnit
 
     void finishPagefault(PacketPtr pkt);
 
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
 
+    TranslateEvent *sentPagefault(uint64_t id);
+
     const char *describeAccess(uint access);
 
     void mkTlbEntry(Addr virt, NocAddr phys, uint flags);
 
     void nextPagefault(TranslateEvent *ev, Cycles delay = Cycles(1));
 
+    void schedule(TranslateEvent *ev, Cycles delay);
+
     PacketPtr createPacket(Addr virt, Addr ptAddr, int level);
 
     bool sendPagefaultMsg(TranslateEvent *ev, Addr virt, uint access);
@@ -166,6 +196,11 @@ class PtUnit
 
     std::list<TranslateEvent*> pfqueue;
 
+    uint64_t nextId;
+
+    // the number of scheduled TranslateEvents
+    size_t scheduled;
+
 };
 
 #endif
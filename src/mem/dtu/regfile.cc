@@ -508,3 +508,29 @@ RegFile::getSize() const
 
     return size;
 }
+
+void
+RegFile::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_CONTAINER(dtuRegs);
+    SERIALIZE_CONTAINER(cmdRegs);
+
+    for (unsigned epid = 0; epid < numEndpoints; epid++)
+        arrayParamOut(cp, csprintf("epRegs%u", epid), epRegs[epid]);
+}
+
+void
+RegFile::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_CONTAINER(dtuRegs);
+    UNSERIALIZE_CONTAINER(cmdRegs);
+    fatal_if(dtuRegs.size() != numDtuRegs || cmdRegs.size() != numCmdRegs,
+             "%s: checkpoint has a different register layout", name());
+
+    for (unsigned epid = 0; epid < numEndpoints; epid++)
+    {
+        arrayParamIn(cp, csprintf("epRegs%u", epid), epRegs[epid]);
+        fatal_if(epRegs[epid].size() != numEpRegs,
+                 "%s: checkpoint has a different register layout", name());
+    }
+}
@@ -41,6 +41,7 @@
 
 #include "base/types.hh"
 #include "mem/packet.hh"
+#include "sim/serialize.hh"
 
 // global and readonly for SW
 enum class DtuReg : Addr
@@ -195,7 +196,7 @@ struct MemEp
     uint8_t flags;
 };
 
-class RegFile
+class RegFile : public Serializable
 {
   public:
 
@@ -237,6 +238,10 @@ class RegFile
 
     Addr getSize() const;
 
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
 
     reg_t get(unsigned epId, size_t idx) const;
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include "base/intmath.hh"
+#include "mem/dtu/stack_dist_probe.hh"
+
+static unsigned
+endpointsOf(SimObject *manager)
+{
+    Dtu *dtu = dynamic_cast<Dtu*>(manager);
+    fatal_if(!dtu, "DtuStackDistProbe needs to be attached to a Dtu");
+    return dtu->numEndpoints;
+}
+
+DtuStackDistProbe::DtuStackDistProbe(const DtuStackDistProbeParams *p)
+    : ProbeListenerObject(p),
+      numEndpoints(endpointsOf(p->manager)),
+      lineSize(p->line_size),
+      histBins(p->hist_bins),
+      memCalcs(),
+      msgCalcs(),
+      memTotalCalc(p->verify),
+      memHists(new Stats::Histogram[numEndpoints]),
+      msgHists(new Stats::Histogram[numEndpoints])
+{
+    fatal_if(!isPowerOf2(lineSize), "The line size has to be a power of 2");
+
+    memCalcs.reserve(numEndpoints);
+    msgCalcs.reserve(numEndpoints);
+    for (unsigned i = 0; i < numEndpoints; ++i)
+    {
+        memCalcs.emplace_back(p->verify);
+        msgCalcs.emplace_back(p->verify);
+    }
+}
+
+DtuStackDistProbe::~DtuStackDistProbe()
+{
+    delete[] memHists;
+    delete[] msgHists;
+}
+
+void
+DtuStackDistProbe::regProbeListeners()
+{
+    typedef ProbeListenerArg<DtuStackDistProbe, Dtu::EpAccess> EpListener;
+
+    listeners.push_back(new EpListener(this, "MemEpAccess",
+                                       &DtuStackDistProbe::memEpAccess));
+    listeners.push_back(new EpListener(this, "MsgSlotAccess",
+                                       &DtuStackDistProbe::msgSlotAccess));
+}
+
+void
+DtuStackDistProbe::regStats()
+{
+    ProbeListenerObject::regStats();
+
+    using namespace Stats;
+
+    for (unsigned i = 0; i < numEndpoints; ++i)
+    {
+        memHists[i]
+            .init(histBins)
+            .name(csprintf("%s.ep%u.memStackDist", name(), i))
+            .desc("Stack distances of lines accessed via the memory EP")
+            .flags(nozero | pdf);
+
+        msgHists[i]
+            .init(histBins)
+            .name(csprintf("%s.ep%u.msgStackDist", name(), i))
+            .desc("Stack distances of message slots of the receive EP")
+            .flags(nozero | pdf);
+    }
+
+    memTotalHist
+        .init(histBins)
+        .name(name() + ".memStackDist")
+        .desc("Stack distances of lines accessed via all memory EPs")
+        .flags(nozero | pdf);
+
+    memInfinite
+        .init(numEndpoints)
+        .name(name() + ".memInfinity")
+        .desc("Number of first line accesses per memory EP")
+        .flags(nozero);
+
+    msgInfinite
+        .init(numEndpoints)
+        .name(name() + ".msgInfinity")
+        .desc("Number of first message slot accesses per receive EP")
+        .flags(nozero);
+
+    for (unsigned i = 0; i < numEndpoints; ++i)
+    {
+        memInfinite.subname(i, csprintf("ep%u", i));
+        msgInfinite.subname(i, csprintf("ep%u", i));
+    }
+
+    memTotalInfinite
+        .name(name() + ".memTotalInfinity")
+        .desc("Number of first line accesses via all memory EPs")
+        .flags(nozero);
+}
+
+void
+DtuStackDistProbe::sample(StackDistCalc &calc,
+                          Addr addr,
+                          Stats::Histogram &hist,
+                          Stats::Vector &infinite,
+                          unsigned epId)
+{
+    uint64_t sd = calc.calcStackDistAndUpdate(addr).first;
+    if (sd == StackDistCalc::Infinity)
+        infinite[epId]++;
+    else
+        hist.sample(sd);
+}
+
+void
+DtuStackDistProbe::memEpAccess(const Dtu::EpAccess &acc)
+{
+    assert(acc.epId < numEndpoints);
+
+    // every line of the transfer is an access of its own
+    Addr end = acc.addr + acc.size;
+    for (Addr line = roundDown(acc.addr, lineSize); line < end;
+         line += lineSize)
+    {
+        sample(memCalcs[acc.epId], line, memHists[acc.epId], memInfinite,
+               acc.epId);
+
+        uint64_t sd = memTotalCalc.calcStackDistAndUpdate(line).first;
+        if (sd == StackDistCalc::Infinity)
+            memTotalInfinite++;
+        else
+            memTotalHist.sample(sd);
+    }
+}
+
+void
+DtuStackDistProbe::msgSlotAccess(const Dtu::EpAccess &acc)
+{
+    assert(acc.epId < numEndpoints);
+
+    // slots are reused as a whole
+    sample(msgCalcs[acc.epId], acc.addr, msgHists[acc.epId], msgInfinite,
+           acc.epId);
+}
+
+DtuStackDistProbe *
+DtuStackDistProbeParams::create()
+{
+    return new DtuStackDistProbe(this);
+}
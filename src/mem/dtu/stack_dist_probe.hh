@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __MEM_DTU_STACK_DIST_PROBE_HH__
+#define __MEM_DTU_STACK_DIST_PROBE_HH__
+
+#include <vector>
+
+#include "mem/dtu/dtu.hh"
+#include "mem/stack_dist_calc.hh"
+#include "params/DtuStackDistProbe.hh"
+#include "sim/probe/probe.hh"
+#include "sim/stats.hh"
+
+/**
+ * Computes the stack distances of the remote accesses via memory endpoints
+ * and of the message slots of receive endpoints. The distances are
+ * collected per endpoint and, for memory endpoints, also across all of
+ * them. This shows how large an SPM would need to be to hold the data that
+ * is reused, and how well the receive buffers are sized.
+ */
+class DtuStackDistProbe : public ProbeListenerObject
+{
+  public:
+    DtuStackDistProbe(const DtuStackDistProbeParams *p);
+
+    ~DtuStackDistProbe();
+
+    void regProbeListeners() override;
+
+    void regStats() override;
+
+  private:
+    void memEpAccess(const Dtu::EpAccess &acc);
+
+    void msgSlotAccess(const Dtu::EpAccess &acc);
+
+    void sample(StackDistCalc &calc,
+                Addr addr,
+                Stats::Histogram &hist,
+                Stats::Vector &infinite,
+                unsigned epId);
+
+  private:
+    const unsigned numEndpoints;
+
+    const unsigned lineSize;
+
+    const unsigned histBins;
+
+    // one stack per endpoint and one for all memory endpoints
+    std::vector<StackDistCalc> memCalcs;
+    std::vector<StackDistCalc> msgCalcs;
+    StackDistCalc memTotalCalc;
+
+    Stats::Histogram *memHists;
+    Stats::Histogram *msgHists;
+    Stats::Histogram memTotalHist;
+    Stats::Vector memInfinite;
+    Stats::Vector msgInfinite;
+    Stats::Scalar memTotalInfinite;
+};
+
+#endif // __MEM_DTU_STACK_DIST_PROBE_HH__
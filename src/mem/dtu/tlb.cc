@@ -139,3 +139,57 @@ DtuTlb::clear()
         }
     }
 }
+
+void
+DtuTlb::serialize(CheckpointOut &cp) const
+{
+    // the trie is rebuilt from the valid entries on unserialize
+    std::vector<Addr> virts;
+    std::vector<Addr> physs;
+    std::vector<uint> flagss;
+    std::vector<uint> seqs;
+    for (const Entry &e : entries)
+    {
+        if (e.handle)
+        {
+            virts.push_back(e.virt);
+            physs.push_back(e.phys.getAddr());
+            flagss.push_back(e.flags);
+            seqs.push_back(e.lru_seq);
+        }
+    }
+
+    SERIALIZE_SCALAR(lru_seq);
+    arrayParamOut(cp, "virt", virts);
+    arrayParamOut(cp, "phys", physs);
+    arrayParamOut(cp, "flags", flagss);
+    arrayParamOut(cp, "lru_seq_entries", seqs);
+}
+
+void
+DtuTlb::unserialize(CheckpointIn &cp)
+{
+    std::vector<Addr> virts;
+    std::vector<Addr> physs;
+    std::vector<uint> flagss;
+    std::vector<uint> seqs;
+
+    UNSERIALIZE_SCALAR(lru_seq);
+    arrayParamIn(cp, "virt", virts);
+    arrayParamIn(cp, "phys", physs);
+    arrayParamIn(cp, "flags", flagss);
+    arrayParamIn(cp, "lru_seq_entries", seqs);
+
+    fatal_if(virts.size() > num,
+             "TLB checkpoint has %lu entries, but the TLB only %lu",
+             virts.size(), num);
+    assert(physs.size() == virts.size() && flagss.size() == virts.size() &&
+           seqs.size() == virts.size());
+
+    clear();
+    for (size_t i = 0; i < virts.size(); ++i)
+    {
+        insert(virts[i], NocAddr(physs[i]), flagss[i]);
+        trie.lookup(virts[i])->lru_seq = seqs[i];
+    }
+}
@@ -33,9 +33,10 @@
 #include "base/types.hh"
 #include "base/trie.hh"
 #include "mem/dtu/noc_addr.hh"
+#include "sim/serialize.hh"
 #include <vector>
 
-class DtuTlb
+class DtuTlb : public Serializable
 {
   private:
 
@@ -117,6 +118,10 @@ class DtuTlb
 
     void clear();
 
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
 
     void evict();
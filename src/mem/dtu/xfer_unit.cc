@@ -45,7 +45,8 @@ XferUnit::XferUnit(Dtu &_dtu,
       blockSize(_blockSize),
       bufCount(_bufCount),
       bufSize(_bufSize),
-      bufs(new Buffer*[bufCount])
+      bufs(new Buffer*[bufCount]),
+      pendingStarts(0)
 {
     for (size_t i = 0; i < bufCount; ++i)
         bufs[i] = new Buffer(*this, i, bufSize);
@@ -171,6 +172,7 @@ XferUnit::startTransfer(Dtu::TransferType type,
                                     flags);
 
         dtu.schedule(event, dtu.clockEdge(Cycles(delay + 1)));
+        pendingStarts++;
 
         return false;
     }
@@ -215,10 +217,11 @@ XferUnit::startTransfer(Dtu::TransferType type,
 
     dtu.schedule(buf->event, dtu.clockEdge(Cycles(delay + 1)));
 
-    // finish the noc request now to make the port unbusy
+    // finish the noc request now to make the port unbusy (atomic requests
+    // don't make it busy)
     bool remote = type == Dtu::TransferType::REMOTE_READ ||
                   type == Dtu::TransferType::REMOTE_WRITE;
-    if (remote)
+    if (remote && !dtu.atomicMode)
         dtu.schedNocRequestFinished(dtu.clockEdge(Cycles(1)));
 
     return true;
@@ -330,6 +333,124 @@ XferUnit::recvMemResponse(size_t bufId,
         buf->event.process();
 }
 
+bool
+XferUnit::isIdle() const
+{
+    if (pendingStarts > 0)
+        return false;
+
+    for (size_t i = 0; i < bufCount; ++i)
+    {
+        if (bufs[i]->event.scheduled())
+            return false;
+
+        // the requester waits for the response and can't be checkpointed
+        // before it got it. thus, finish these transfers, even if they
+        // wait for a pagefault to be resolved
+        const PacketPtr pkt = bufs[i]->event.pkt;
+        if (!bufs[i]->free && pkt && pkt->needsResponse())
+            return false;
+    }
+    return true;
+}
+
+PtUnit::Translation *
+XferUnit::unserializeTranslation(CheckpointIn &cp)
+{
+    int buf;
+    UNSERIALIZE_SCALAR(buf);
+    fatal_if(buf < 0 || static_cast<size_t>(buf) >= bufCount,
+             "Invalid transfer buffer %d in checkpoint", buf);
+    return new Translation(bufs[buf]->event);
+}
+
+void
+XferUnit::serialize(CheckpointOut &cp) const
+{
+    assert(isIdle());
+
+    for (size_t i = 0; i < bufCount; ++i)
+    {
+        const Buffer *buf = bufs[i];
+        ScopedCheckpointSection sec(cp, csprintf("buf%lu", i));
+
+        paramOut(cp, "free", buf->free);
+        if (buf->free)
+            continue;
+
+        // the transfer waits for a translation; the PtUnit stores that
+        const TransferEvent &ev = buf->event;
+        paramOut(cp, "offset", buf->offset);
+        arrayParamOut(cp, "bytes", buf->bytes, bufSize);
+        paramOut(cp, "type", static_cast<int>(ev.type));
+        paramOut(cp, "localAddr", ev.localAddr);
+        paramOut(cp, "remoteAddr", ev.remoteAddr.getAddr());
+        paramOut(cp, "size", ev.size);
+        paramOut(cp, "flags", ev.flags);
+
+        // the drain finishes all transfers for requests with responses
+        panic_if(ev.pkt && ev.pkt->needsResponse(),
+                 "buf%d: transfer for pending NoC request", buf->id);
+
+        bool hasPkt = ev.pkt != NULL;
+        paramOut(cp, "hasPkt", hasPkt);
+        if (hasPkt)
+        {
+            paramOut(cp, "pktAddr", ev.pkt->getAddr());
+            paramOut(cp, "pktSize", ev.pkt->getSize());
+            paramOut(cp, "pktCmd", ev.pkt->cmd.toInt());
+        }
+    }
+}
+
+void
+XferUnit::unserialize(CheckpointIn &cp)
+{
+    for (size_t i = 0; i < bufCount; ++i)
+    {
+        Buffer *buf = bufs[i];
+        ScopedCheckpointSection sec(cp, csprintf("buf%lu", i));
+
+        paramIn(cp, "free", buf->free);
+        if (buf->free)
+            continue;
+
+        TransferEvent &ev = buf->event;
+        int type;
+        Addr remoteAddr;
+        paramIn(cp, "offset", buf->offset);
+        arrayParamIn(cp, "bytes", buf->bytes, bufSize);
+        paramIn(cp, "type", type);
+        paramIn(cp, "localAddr", ev.localAddr);
+        paramIn(cp, "remoteAddr", remoteAddr);
+        paramIn(cp, "size", ev.size);
+        paramIn(cp, "flags", ev.flags);
+        ev.type = static_cast<Dtu::TransferType>(type);
+        ev.remoteAddr = NocAddr(remoteAddr);
+
+        bool hasPkt;
+        paramIn(cp, "hasPkt", hasPkt);
+        if (hasPkt)
+        {
+            Addr pktAddr;
+            unsigned pktSize;
+            int pktCmd;
+            paramIn(cp, "pktAddr", pktAddr);
+            paramIn(cp, "pktSize", pktSize);
+            paramIn(cp, "pktCmd", pktCmd);
+
+            // the data is already in the buffer
+            ev.pkt = dtu.generateRequest(pktAddr, pktSize, MemCmd(pktCmd));
+        }
+        else
+            ev.pkt = NULL;
+
+        DPRINTFS(DtuXfers, (&dtu),
+            "buf%d: Restored transfer of %lu bytes @ %p\n",
+            buf->id, ev.size, ev.localAddr);
+    }
+}
+
 XferUnit::Buffer*
 XferUnit::allocateBuf(bool recvmsg)
 {
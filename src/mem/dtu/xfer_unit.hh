@@ -34,7 +34,7 @@
 #include "mem/dtu/dtu.hh"
 #include "mem/dtu/noc_addr.hh"
 
-class XferUnit
+class XferUnit : public Serializable
 {
   public:
 
@@ -96,6 +96,12 @@ class XferUnit
 
             delete this;
         }
+
+        void serialize(CheckpointOut &cp) const override
+        {
+            paramOut(cp, "type", std::string("xfer"));
+            paramOut(cp, "buf", event.buf->id);
+        }
     };
 
     struct Buffer
@@ -154,18 +160,20 @@ class XferUnit
 
         void process() override
         {
-            // the delay was already paid earlier
-            if (xfer.startTransfer(type,
-                                   remoteAddr,
-                                   localAddr,
-                                   size,
-                                   pkt,
-                                   header,
-                                   Cycles(0),
-                                   flags))
-            {
-                setFlags(AutoDelete);
-            }
+            xfer.pendingStarts--;
+
+            // the delay was already paid earlier. if there is still no free
+            // buffer, startTransfer creates a new event
+            xfer.startTransfer(type,
+                               remoteAddr,
+                               localAddr,
+                               size,
+                               pkt,
+                               header,
+                               Cycles(0),
+                               flags);
+
+            setFlags(AutoDelete);
         }
 
         const char* description() const override { return "StartXferEvent"; }
@@ -194,6 +202,22 @@ class XferUnit
                          Tick headerDelay,
                          Tick payloadDelay);
 
+    /**
+     * @return true if no transfer is waiting to start or to continue. A
+     *         transfer might still wait for a translation or memory response
+     */
+    bool isIdle() const;
+
+    /**
+     * Recreates the translation of a transfer that was pending at a
+     * checkpoint
+     */
+    PtUnit::Translation *unserializeTranslation(CheckpointIn &cp);
+
+    void serialize(CheckpointOut &cp) const override;
+
+    void unserialize(CheckpointIn &cp) override;
+
   private:
 
     Buffer* allocateBuf(bool recvmsg);
@@ -207,6 +231,9 @@ class XferUnit
     size_t bufCount;
     size_t bufSize;
     Buffer **bufs;
+
+    // the StartEvents that wait for a free buffer
+    size_t pendingStarts;
 };
 
 #endif
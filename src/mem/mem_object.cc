@@ -41,8 +41,14 @@
  *          Andreas Hansson
  */
 
+#include <algorithm>
+
+#include "base/misc.hh"
 #include "mem/mem_object.hh"
 
+std::vector<std::pair<const MemObject*, const MemObject*>>
+    MemObject::crossQueueLinks;
+
 MemObject::MemObject(const Params *params)
     : ClockedObject(params)
 {
@@ -59,3 +65,32 @@ MemObject::getSlavePort(const std::string& if_name, PortID idx)
 {
     fatal("%s does not have any slave port named %s\n", name(), if_name);
 }
+
+void
+MemObject::addCrossQueueLink(const MemObject& master, const MemObject& slave)
+{
+    crossQueueLinks.emplace_back(&master, &slave);
+}
+
+Tick
+MemObject::crossQueueLookahead()
+{
+    if (crossQueueLinks.empty())
+        return 0;
+
+    Tick lookahead = MaxTick;
+    for (const auto &link : crossQueueLinks) {
+        // requests get the latency of the slave, but responses only the
+        // one of the master, so that the lower one limits the quantum
+        Tick lat = std::min(link.first->linkLatency(),
+                            link.second->linkLatency());
+        if (lat == 0) {
+            warn("Link between %s and %s crosses event queues without "
+                 "latency; cannot derive a quantum\n",
+                 link.first->name(), link.second->name());
+            return 0;
+        }
+        lookahead = std::min(lookahead, lat);
+    }
+    return lookahead;
+}
@@ -49,6 +49,9 @@
 #ifndef __MEM_MEM_OBJECT_HH__
 #define __MEM_MEM_OBJECT_HH__
 
+#include <utility>
+#include <vector>
+
 #include "mem/port.hh"
 #include "params/MemObject.hh"
 #include "sim/clocked_object.hh"
@@ -91,6 +94,44 @@ class MemObject : public ClockedObject
      */
     virtual BaseSlavePort& getSlavePort(const std::string& if_name,
                                         PortID idx = InvalidPortID);
+
+    /**
+     * Get the minimum latency a packet experiences when passing
+     * through this object. If the object connects two event queues,
+     * this is the lookahead it provides for parallel simulation.
+     * Objects that do not delay packets return 0.
+     *
+     * @return The minimum latency in ticks
+     */
+    virtual Tick linkLatency() const { return 0; }
+
+    /**
+     * Record that a master port of one object has been bound to a
+     * slave port of an object that runs in a different event queue.
+     *
+     * @param master The owner of the master port
+     * @param slave The owner of the slave port
+     */
+    static void addCrossQueueLink(const MemObject& master,
+                                  const MemObject& slave);
+
+    /**
+     * Get the largest simulation quantum that is safe for all links
+     * between event queues. A request crossing a link is delayed by the
+     * latency of the slave and a response by the one of the master, so
+     * that the quantum may not exceed the minimum of all these
+     * latencies.
+     *
+     * @return The safe quantum or 0 if there are no such links or a
+     *         link without latency
+     */
+    static Tick crossQueueLookahead();
+
+  private:
+
+    /** The links between objects in different event queues */
+    static std::vector<std::pair<const MemObject*, const MemObject*>>
+        crossQueueLinks;
 };
 
 #endif //__MEM_MEM_OBJECT_HH__
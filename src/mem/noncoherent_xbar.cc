@@ -99,6 +99,15 @@ NoncoherentXBar::~NoncoherentXBar()
         delete l;
 }
 
+void
+NoncoherentXBar::regProbePoints()
+{
+    ppPktReqCpu.reset(new ProbePoints::Packet(getProbeManager(),
+                                              "PktRequestCPU"));
+    ppPktRespCpu.reset(new ProbePoints::Packet(getProbeManager(),
+                                               "PktResponseCPU"));
+}
+
 bool
 NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
 {
@@ -143,6 +152,7 @@ NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
     // remember if we are expecting a response
     const bool expect_response = pkt->needsResponse() &&
         !pkt->memInhibitAsserted();
+    const MemCmd orig_cmd = pkt->cmd;
 
     // since it is a normal request, attempt to send the packet
     bool success = masterPorts[master_port_id]->sendTimingReq(pkt);
@@ -172,6 +182,16 @@ NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
 
     reqLayers[master_port_id]->succeededTiming(packetFinishTime);
 
+    // the receiver might have turned the packet into a response already,
+    // so show the probe the original command. Note that a packet without
+    // response might already be gone at this point.
+    if (expect_response) {
+        const MemCmd resp_cmd = pkt->cmd;
+        pkt->cmd = orig_cmd;
+        ppPktReqCpu->notify(pkt);
+        pkt->cmd = resp_cmd;
+    }
+
     // stats updates
     pktCount[slave_port_id][master_port_id]++;
     pktSize[slave_port_id][master_port_id] += pkt_size;
@@ -218,6 +238,8 @@ NoncoherentXBar::recvTimingResp(PacketPtr pkt, PortID master_port_id)
     // determine how long to be crossbar layer is busy
     Tick packetFinishTime = clockEdge(Cycles(1)) + pkt->payloadDelay;
 
+    ppPktRespCpu->notify(pkt);
+
     // send the packet through the destination slave port, and pay for
     // any outstanding latency
     Tick latency = pkt->headerDelay;
@@ -264,11 +286,15 @@ NoncoherentXBar::recvAtomic(PacketPtr pkt, PortID slave_port_id)
     pktSize[slave_port_id][master_port_id] += pkt_size;
     transDist[pkt_cmd]++;
 
+    ppPktReqCpu->notify(pkt);
+
     // forward the request to the appropriate destination
     Tick response_latency = masterPorts[master_port_id]->sendAtomic(pkt);
 
     // add the response data
     if (pkt->isResponse()) {
+        ppPktRespCpu->notify(pkt);
+
         pkt_size = pkt->hasData() ? pkt->getSize() : 0;
         pkt_cmd = pkt->cmdToIndex();
 
@@ -53,6 +53,7 @@
 
 #include "mem/xbar.hh"
 #include "params/NoncoherentXBar.hh"
+#include "sim/probe/mem.hh"
 
 /**
  * A non-coherent crossbar connects a number of non-snooping masters
@@ -189,12 +190,20 @@ class NoncoherentXBar : public BaseXBar
         transaction.*/
     void recvFunctional(PacketPtr pkt, PortID slave_port_id);
 
+    /** Accepted request on the slave side */
+    ProbePoints::PacketUPtr ppPktReqCpu;
+
+    /** Outgoing response on the slave side */
+    ProbePoints::PacketUPtr ppPktRespCpu;
+
   public:
 
     NoncoherentXBar(const NoncoherentXBarParams *p);
 
     virtual ~NoncoherentXBar();
 
+    void regProbePoints() M5_ATTR_OVERRIDE;
+
     /**
      * stats
      */
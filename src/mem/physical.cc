@@ -38,18 +38,22 @@
  */
 
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#include "base/memops.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -74,7 +78,8 @@ PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve) :
     _name(_name), rangeCache(addrMap.end()), size(0),
-    mmapUsingNoReserve(mmap_using_noreserve)
+    mmapUsingNoReserve(mmap_using_noreserve), _sharedPages(0),
+    _privatePages(0)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -201,6 +206,177 @@ PhysicalMemory::~PhysicalMemory()
         munmap((char*)s.second, s.first.size());
 }
 
+namespace {
+
+/**
+ * A resident page of a backing store, identified by a hash of its
+ * contents.
+ */
+struct SharedPage
+{
+    uint64_t hash;
+    uint8_t *addr;
+    PhysicalMemory *mem;
+    // the page that holds the shared copy or null if there is none
+    SharedPage *copy;
+    // offset of the shared copy in the shared memory file
+    off_t offset;
+};
+
+uint64_t
+hashPage(const uint8_t *page, size_t page_size)
+{
+    // FNV-1a on 64-bit words; the pages are compared anyway
+    const uint64_t *words = reinterpret_cast<const uint64_t*>(page);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < page_size / sizeof(uint64_t); ++i)
+        hash = (hash ^ words[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+int
+createSharedFile()
+{
+#if defined(__linux__) && defined(SYS_memfd_create)
+    return syscall(SYS_memfd_create, "gem5-shared-pages", 0);
+#else
+    return -1;
+#endif
+}
+
+} // anonymous namespace
+
+void
+PhysicalMemory::shareIdenticalPages(const vector<PhysicalMemory*>& mems)
+{
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+
+    // collect the resident pages of all backing stores
+    vector<SharedPage> pages;
+    vector<unsigned char> resident;
+    for (auto m : mems) {
+        for (const auto& s : m->backingStore) {
+            size_t npages = s.first.size() / page_size;
+            resident.resize(npages);
+            if (mincore(s.second, npages * page_size, resident.data())) {
+                perror("mincore");
+                warn("Could not determine resident pages of %s\n",
+                     m->name());
+                continue;
+            }
+
+            for (size_t i = 0; i < npages; ++i) {
+                if (resident[i] & 1) {
+                    uint8_t *addr = s.second + i * page_size;
+                    pages.push_back({hashPage(addr, page_size), addr, m,
+                                     nullptr, 0});
+                }
+            }
+        }
+    }
+
+    int fd = createSharedFile();
+    if (fd == -1) {
+        warn("Could not create shared memory file; not sharing pages\n");
+        return;
+    }
+
+    // group the pages by their hash. the sort is stable to keep the
+    // order of the backing stores within a group, so that the first
+    // page of each group comes first in the stores as well.
+    vector<SharedPage*> sorted;
+    sorted.reserve(pages.size());
+    for (auto& p : pages)
+        sorted.push_back(&p);
+    stable_sort(sorted.begin(), sorted.end(),
+                [](const SharedPage *a, const SharedPage *b) {
+                    return a->hash < b->hash;
+                });
+
+    for (size_t i = 0; i < sorted.size(); ) {
+        size_t end = i + 1;
+        while (end < sorted.size() && sorted[end]->hash == sorted[i]->hash)
+            end++;
+
+        // find the pages with the same contents as the first one. hash
+        // collisions are rare, so we simply repeat for the pages that
+        // differ from it.
+        for (size_t first = i; first < end; ++first) {
+            SharedPage *p = sorted[first];
+            if (p->copy)
+                continue;
+
+            for (size_t j = first + 1; j < end; ++j) {
+                SharedPage *q = sorted[j];
+                if (!q->copy && MemOps::equal(p->addr, q->addr, page_size)) {
+                    p->copy = p;
+                    q->copy = p;
+                }
+            }
+        }
+
+        i = end;
+    }
+
+    // place the shared copies in the order of the backing stores into
+    // the file. thus, identical images in different stores end up in
+    // contiguous regions of the file and can be mapped at once.
+    off_t file_size = 0;
+    for (auto& p : pages) {
+        if (p.copy == &p) {
+            p.offset = file_size;
+            if (pwrite(fd, p.addr, page_size, p.offset) !=
+                (ssize_t)page_size) {
+                perror("pwrite");
+                fatal("Could not write to shared memory file\n");
+            }
+            file_size += page_size;
+        } else if (p.copy) {
+            p.offset = p.copy->offset;
+        }
+    }
+
+    // the pages are still in the order of the backing stores; map runs
+    // of pages that are contiguous in both the store and the file
+    size_t runs = 0;
+    size_t shared = 0;
+    for (size_t i = 0; i < pages.size(); ) {
+        SharedPage& p = pages[i];
+        if (!p.copy) {
+            p.mem->_privatePages++;
+            i++;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < pages.size() && pages[end].mem == p.mem &&
+               pages[end].copy &&
+               pages[end].addr == p.addr + (end - i) * page_size &&
+               pages[end].offset == p.offset + (off_t)((end - i) * page_size))
+            end++;
+
+        size_t len = (end - i) * page_size;
+        void *res = mmap(p.addr, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, fd, p.offset);
+        if (res == MAP_FAILED) {
+            perror("mmap");
+            fatal("Could not map %d shared bytes for %s!\n", len,
+                  p.mem->name());
+        }
+
+        p.mem->_sharedPages += end - i;
+        shared += end - i;
+        runs++;
+        i = end;
+    }
+
+    // the mappings keep the file alive
+    close(fd);
+
+    inform("Shared %d of %d resident pages via %d host pages in %d "
+           "mappings\n", shared, pages.size(), file_size / page_size, runs);
+}
+
 bool
 PhysicalMemory::isMemAddr(Addr addr) const
 {
@@ -420,9 +596,9 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    const uint32_t page_size = sysconf(_SC_PAGESIZE);
     uint64_t curr_size = 0;
-    long* temp_page = new long[chunk_size];
-    long* pmem_current;
+    uint8_t* temp_page = new uint8_t[chunk_size];
     uint32_t bytes_read;
     while (curr_size < range.size()) {
         bytes_read = gzread(compressed_mem, temp_page, chunk_size);
@@ -431,13 +607,12 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
 
         assert(bytes_read % sizeof(long) == 0);
 
-        for (uint32_t x = 0; x < bytes_read / sizeof(long); x++) {
-            // Only copy bytes that are non-zero, so we don't give
+        for (uint32_t x = 0; x < bytes_read; x += page_size) {
+            // Only copy pages that are non-zero, so we don't give
             // the VM system hell
-            if (*(temp_page + x) != 0) {
-                pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
-                *pmem_current = *(temp_page + x);
-            }
+            uint32_t len = min(page_size, bytes_read - x);
+            if (!MemOps::isZero(temp_page + x, len))
+                MemOps::copyBlock(pmem + curr_size + x, temp_page + x, len);
         }
         curr_size += bytes_read;
     }
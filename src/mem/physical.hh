@@ -92,6 +92,11 @@ class PhysicalMemory : public Serializable
     // system
     std::vector<std::pair<AddrRange, uint8_t*>> backingStore;
 
+    // Number of pages mapped to the shared store and number of
+    // resident pages that stayed private when sharing the pages
+    uint64_t _sharedPages;
+    uint64_t _privatePages;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -170,6 +175,33 @@ class PhysicalMemory : public Serializable
     std::vector<std::pair<AddrRange, uint8_t*>> getBackingStore() const
     { return backingStore; }
 
+    /**
+     * Share the pages with identical contents across the backing
+     * stores of the given physical memories. Every set of resident
+     * pages with the same contents is replaced by a private mapping
+     * of a single copy in a shared memory file, so that the host only
+     * duplicates a page once it is written. Pages that have not been
+     * touched yet are left alone, as they do not occupy host memory
+     * anyway. This is meant to be called once after all memories
+     * have been initialized, e.g., when many systems have loaded the
+     * same binary.
+     *
+     * @param mems The physical memories to share the pages of
+     */
+    static void shareIdenticalPages(const std::vector<PhysicalMemory*>& mems);
+
+    /**
+     * Get the number of pages that have been mapped to the shared
+     * store by shareIdenticalPages().
+     */
+    uint64_t sharedPages() const { return _sharedPages; }
+
+    /**
+     * Get the number of resident pages that have not been shared by
+     * shareIdenticalPages().
+     */
+    uint64_t privatePages() const { return _privatePages; }
+
     /**
      * Perform an untimed memory access and update all the state
      * (e.g. locked addresses) and statistics accordingly. The packet
@@ -138,6 +138,9 @@ MasterPort::bind(BaseSlavePort& slave_port)
         _slavePort = cast_slave_port;
         // slave port also keeps track of master port
         _slavePort->bind(*this);
+        // parallel simulation needs the lookahead of these links
+        if (owner.eventQueue() != slave_port.getOwner().eventQueue())
+            MemObject::addCrossQueueLink(owner, slave_port.getOwner());
     } else {
         fatal("Master port %s cannot bind to %s\n", name(),
               slave_port.name());
@@ -101,6 +101,9 @@ class Port
     /** Get the port id. */
     PortID getId() const { return id; }
 
+    /** Get the MemObject that owns this port. */
+    MemObject& getOwner() const { return owner; }
+
 };
 
 /** Forward declaration */
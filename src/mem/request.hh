@@ -57,6 +57,7 @@
 
 #include "base/flags.hh"
 #include "base/misc.hh"
+#include "base/pool_alloc.hh"
 #include "base/types.hh"
 #include "sim/core.hh"
 
@@ -83,7 +84,7 @@ class Request;
 typedef Request* RequestPtr;
 typedef uint16_t MasterID;
 
-class Request
+class Request : public PoolAlloc
 {
   public:
     typedef uint32_t FlagsType;
@@ -29,6 +29,7 @@
 #include <cassert>
 
 #include "base/cprintf.hh"
+#include "base/intmath.hh"
 #include "base/misc.hh"
 #include "base/random.hh"
 #include "base/stl_helpers.hh"
@@ -54,7 +55,6 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_not_avail_count = 0;
     m_priority_rank = 0;
 
-    m_stall_msg_map.clear();
     m_input_link_id = 0;
     m_vnet_id = 0;
 }
@@ -261,28 +261,44 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::reanalyzeList(MsgPtr msg, unsigned count, Tick schdTick)
 {
-    while(!lt.empty()) {
+    if (count == 0)
+        return;
+
+    size_t old_size = m_prio_heap.size();
+    m_prio_heap.reserve(old_size + count);
+    while (msg) {
         m_msg_counter++;
-        MsgPtr m = lt.front();
-        m->setLastEnqueueTime(schdTick);
-        m->setMsgCounter(m_msg_counter);
+        msg->setLastEnqueueTime(schdTick);
+        msg->setMsgCounter(m_msg_counter);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+        MsgPtr next = msg->getStallNext();
+        msg->setStallNext(nullptr);
+        m_prio_heap.push_back(msg);
+        msg = next;
+    }
 
-        m_consumer->scheduleEventAbsolute(schdTick);
-        lt.pop_front();
+    // rebuilding the heap at once is cheaper than pushing each message,
+    // if many messages are woken up
+    size_t size = m_prio_heap.size();
+    if (count > 1 && count * floorLog2(size) > 3 * size) {
+        make_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    } else {
+        for (size_t i = old_size + 1; i <= size; ++i) {
+            push_heap(m_prio_heap.begin(), m_prio_heap.begin() + i,
+                      greater<MsgPtr>());
+        }
     }
+
+    m_consumer->scheduleEventAbsolute(schdTick);
 }
 
 void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    assert(m_stall_msg_map.contains(addr));
 
     //
     // Put all stalled messages associated with this address back on the
@@ -290,8 +306,9 @@ MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    unsigned count;
+    MsgPtr msgs = m_stall_msg_map.remove(addr, count);
+    reanalyzeList(msgs, count, current_time);
 }
 
 void
@@ -305,11 +322,9 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle.
     //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end(); ++map_iter) {
-        reanalyzeList(map_iter->second, current_time);
-    }
-    m_stall_msg_map.clear();
+    unsigned count;
+    MsgPtr msgs = m_stall_msg_map.removeAll(count);
+    reanalyzeList(msgs, count, current_time);
 }
 
 void
@@ -327,7 +342,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    m_stall_msg_map.stall(addr, message);
 }
 
 void
@@ -362,18 +377,9 @@ MessageBuffer::functionalRead(Packet *pkt)
 
     // Read the messages in the stall queue that correspond
     // to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalRead(pkt)) return true;
-        }
-    }
-    return false;
+    return m_stall_msg_map.any([pkt] (Message *msg) {
+        return msg->functionalRead(pkt);
+    });
 }
 
 uint32_t
@@ -392,19 +398,11 @@ MessageBuffer::functionalWrite(Packet *pkt)
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalWrite(pkt)) {
-                num_functional_writes++;
-            }
-        }
-    }
+    m_stall_msg_map.any([pkt, &num_functional_writes] (Message *msg) {
+        if (msg->functionalWrite(pkt))
+            num_functional_writes++;
+        return false;
+    });
 
     return num_functional_writes;
 }
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "mem/ruby/network/StallTable.hh"
+
+using namespace std;
+
+// has to be a power of two
+static const unsigned INIT_SIZE = 16;
+
+StallTable::StallTable()
+    : m_entries(INIT_SIZE), m_mask(INIT_SIZE - 1), m_used(0)
+{
+}
+
+unsigned
+StallTable::index(Addr addr) const
+{
+    // the low bits are always zero; the multiplication mixes the others
+    // into the upper half
+    uint64_t hash = addr * 0x9e3779b97f4a7c15ULL;
+    return (hash >> 32) & m_mask;
+}
+
+int
+StallTable::find(Addr addr) const
+{
+    for (unsigned i = index(addr); m_entries[i].used; i = (i + 1) & m_mask) {
+        if (m_entries[i].addr == addr)
+            return i;
+    }
+    return -1;
+}
+
+void
+StallTable::stall(Addr addr, const MsgPtr &msg)
+{
+    assert(!msg->getStallNext());
+
+    int idx = find(addr);
+    if (idx == -1) {
+        // keep the load factor below 1/2 to keep the probe sequences short
+        if ((m_used + 1) * 2 > m_entries.size())
+            grow();
+
+        unsigned i = index(addr);
+        while (m_entries[i].used)
+            i = (i + 1) & m_mask;
+
+        Entry &e = m_entries[i];
+        e.used = true;
+        e.addr = addr;
+        e.head = msg;
+        e.tail = msg.get();
+        e.count = 1;
+        m_used++;
+        return;
+    }
+
+    Entry &e = m_entries[idx];
+    e.tail->setStallNext(msg);
+    e.tail = msg.get();
+    e.count++;
+}
+
+MsgPtr
+StallTable::remove(Addr addr, unsigned &count)
+{
+    int idx = find(addr);
+    assert(idx != -1);
+
+    MsgPtr head = move(m_entries[idx].head);
+    count = m_entries[idx].count;
+    erase(idx);
+    return head;
+}
+
+MsgPtr
+StallTable::removeAll(unsigned &count)
+{
+    // use a well-defined order, independent of the hash function
+    vector<Addr> addrs;
+    addrs.reserve(m_used);
+    for (const Entry &e : m_entries) {
+        if (e.used)
+            addrs.push_back(e.addr);
+    }
+    sort(addrs.begin(), addrs.end());
+
+    MsgPtr head;
+    Message *tail = NULL;
+    count = 0;
+    for (Addr addr : addrs) {
+        Entry &e = m_entries[find(addr)];
+        if (tail)
+            tail->setStallNext(e.head);
+        else
+            head = e.head;
+        tail = e.tail;
+        count += e.count;
+    }
+
+    clear();
+    return head;
+}
+
+bool
+StallTable::contains(Addr addr) const
+{
+    return find(addr) != -1;
+}
+
+void
+StallTable::clear()
+{
+    for (Entry &e : m_entries)
+        e = Entry();
+    m_used = 0;
+}
+
+void
+StallTable::erase(unsigned idx)
+{
+    m_entries[idx] = Entry();
+    m_used--;
+
+    // shift the following entries of the probe sequence backwards, so
+    // that lookups do not need tombstones
+    unsigned hole = idx;
+    for (unsigned i = (idx + 1) & m_mask; m_entries[i].used;
+         i = (i + 1) & m_mask) {
+        unsigned home = index(m_entries[i].addr);
+        // can the entry be moved into the hole (cyclically)?
+        bool movable = hole <= i ? (home <= hole || home > i)
+                                 : (home <= hole && home > i);
+        if (movable) {
+            m_entries[hole] = move(m_entries[i]);
+            m_entries[i] = Entry();
+            hole = i;
+        }
+    }
+}
+
+void
+StallTable::grow()
+{
+    vector<Entry> old;
+    old.swap(m_entries);
+
+    m_entries.resize(old.size() * 2);
+    m_mask = m_entries.size() - 1;
+
+    for (Entry &e : old) {
+        if (!e.used)
+            continue;
+        unsigned i = index(e.addr);
+        while (m_entries[i].used)
+            i = (i + 1) & m_mask;
+        m_entries[i] = move(e);
+    }
+}
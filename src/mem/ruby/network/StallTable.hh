@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_STALLTABLE_HH__
+#define __MEM_RUBY_NETWORK_STALLTABLE_HH__
+
+#include <vector>
+
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/*
+ * Table of the messages a MessageBuffer has stalled, indexed by the address
+ * they wait for. The table uses open addressing with linear probing in a
+ * flat array, so that stalling a message does not allocate a map and list
+ * node. The messages of one address are chained through their stall link
+ * in the order in which they have been stalled.
+ */
+class StallTable
+{
+  public:
+    StallTable();
+
+    //! Appends the message to the messages stalled for addr.
+    void stall(Addr addr, const MsgPtr &msg);
+
+    //! Removes all messages stalled for addr and returns the oldest one,
+    //! which is chained to the others. count is set to their number.
+    MsgPtr remove(Addr addr, unsigned &count);
+
+    //! Removes all messages in the order of their addresses, chained as
+    //! for remove().
+    MsgPtr removeAll(unsigned &count);
+
+    bool contains(Addr addr) const;
+
+    //! The number of addresses with stalled messages.
+    unsigned size() const { return m_used; }
+    bool empty() const { return m_used == 0; }
+
+    void clear();
+
+    //! Calls func for every stalled message until it returns true.
+    template <typename F>
+    bool
+    any(F func) const
+    {
+        for (const Entry &e : m_entries) {
+            if (!e.used)
+                continue;
+            for (Message *m = e.head.get(); m; m = m->getStallNext().get()) {
+                if (func(m))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    struct Entry
+    {
+        Entry() : addr(0), head(), tail(NULL), count(0), used(false) {}
+
+        Addr addr;
+        MsgPtr head;
+        Message *tail;
+        unsigned count;
+        bool used;
+    };
+
+    unsigned index(Addr addr) const;
+    int find(Addr addr) const;
+    void erase(unsigned idx);
+    void grow();
+
+    std::vector<Entry> m_entries;
+    unsigned m_mask;
+    unsigned m_used;
+};
+
+#endif // __MEM_RUBY_NETWORK_STALLTABLE_HH__
@@ -103,6 +103,10 @@ class Message
     int getVnet() const { return vnet; }
     void setVnet(int net) { vnet = net; }
 
+    //! The next message stalled for the same address (see StallTable).
+    const MsgPtr &getStallNext() const { return m_stall_next; }
+    void setStallNext(const MsgPtr &next) { m_stall_next = next; }
+
   private:
     const Tick m_time;
     Tick m_LastEnqueueTime; // my last enqueue time
@@ -112,6 +116,8 @@ class Message
     // Variables for required network traversal
     int incoming_link;
     int vnet;
+
+    MsgPtr m_stall_next;
 };
 
 inline bool
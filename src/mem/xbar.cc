@@ -47,6 +47,8 @@
  * Definition of a crossbar object.
  */
 
+#include <algorithm>
+
 #include "base/misc.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
@@ -63,8 +65,19 @@ BaseXBar::BaseXBar(const BaseXBarParams *p)
       gotAddrRanges(p->port_default_connection_count +
                           p->port_master_connection_count, false),
       gotAllAddrRanges(false), defaultPortID(InvalidPortID),
-      useDefaultRange(p->use_default_range)
-{}
+      useDefaultRange(p->use_default_range),
+      decodeShift(p->decode_shift),
+      decodeBits(p->decode_bits)
+{
+    if (decodeBits > 0) {
+        if (decodeBits > 20 || decodeShift + decodeBits > 64)
+            fatal("%s: invalid decode bit field [%u, %u)\n", name(),
+                  decodeShift, decodeShift + decodeBits);
+        decodeTable.resize(1 << decodeBits);
+        for (auto &e : decodeTable)
+            e.valid = false;
+    }
+}
 
 BaseXBar::~BaseXBar()
 {
@@ -80,6 +93,16 @@ BaseXBar::init()
 {
 }
 
+Tick
+BaseXBar::linkLatency() const
+{
+    // a request passes the frontend and the forwarding stage, whereas a
+    // response only pays the response latency
+    return clockPeriod() * std::min<uint64_t>(frontendLatency +
+                                              forwardLatency,
+                                              responseLatency);
+}
+
 BaseMasterPort &
 BaseXBar::getMasterPort(const std::string &if_name, PortID idx)
 {
@@ -326,8 +349,13 @@ BaseXBar::findPort(Addr addr)
     // ranges of all connected slave modules
     assert(gotAllAddrRanges);
 
+    // Check the direct-mapped table
+    PortID dest_id = checkDecodeTable(addr);
+    if (dest_id != InvalidPortID)
+        return dest_id;
+
     // Check the cache
-    PortID dest_id = checkPortCache(addr);
+    dest_id = checkPortCache(addr);
     if (dest_id != InvalidPortID)
         return dest_id;
 
@@ -515,11 +543,45 @@ BaseXBar::recvRangeChange(PortID master_port_id)
         // ranges have changed
         for (const auto& s: slavePorts)
             s->sendRangeChange();
+
+        updateDecodeTable();
     }
 
     clearPortCache();
 }
 
+void
+BaseXBar::updateDecodeTable()
+{
+    if (decodeBits == 0)
+        return;
+
+    for (auto &e : decodeTable)
+        e.valid = false;
+
+    size_t direct = 0;
+    for (const auto& r: portMap) {
+        // the range has to be within the addresses of a single entry
+        if (r.first.interleaved() ||
+            (r.first.start() >> decodeShift) != (r.first.end() >> decodeShift))
+            continue;
+
+        // if multiple ranges map to the same entry, keep the first one
+        size_t idx = (r.first.start() >> decodeShift) &
+                     (decodeTable.size() - 1);
+        if (decodeTable[idx].valid)
+            continue;
+
+        decodeTable[idx].valid = true;
+        decodeTable[idx].id = r.second;
+        decodeTable[idx].range = r.first;
+        direct++;
+    }
+
+    DPRINTF(AddrRanges, "Decoding %lu of %lu ranges directly\n",
+            direct, portMap.size());
+}
+
 AddrRangeList
 BaseXBar::getAddrRanges() const
 {
@@ -397,6 +397,31 @@ class BaseXBar : public MemObject
         portCache[0].valid = false;
     }
 
+    /**
+     * Direct-mapped port decoding: the bits [decodeShift, decodeShift +
+     * decodeBits) of the address index the decodeTable. An entry is only
+     * valid if a single port's range lies completely within the addresses
+     * that map to it, and the lookup still checks the range. Hence,
+     * everything else falls back to the port cache and the port map.
+     */
+    const unsigned decodeShift;
+    const unsigned decodeBits;
+    std::vector<PortCache> decodeTable;
+
+    inline PortID checkDecodeTable(Addr addr) const {
+        if (decodeBits == 0)
+            return InvalidPortID;
+
+        const PortCache &e =
+            decodeTable[(addr >> decodeShift) & (decodeTable.size() - 1)];
+        if (e.valid && e.range.contains(addr))
+            return e.id;
+        return InvalidPortID;
+    }
+
+    /** Rebuilds the decodeTable from the portMap */
+    void updateDecodeTable();
+
     /**
      * Return the address ranges the crossbar is responsible for.
      *
@@ -466,6 +491,8 @@ class BaseXBar : public MemObject
 
     virtual void regStats();
 
+    Tick linkLatency() const M5_ATTR_OVERRIDE;
+
 };
 
 #endif //__MEM_XBAR_HH__
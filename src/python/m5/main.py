@@ -106,6 +106,8 @@ def parse_options():
         help="Start debug output at TIME (must be in ticks)")
     option("--debug-file", metavar="FILE", default="cout",
         help="Sets the output file for debug [Default: %default]")
+    option("--debug-async", action="store_true", default=False,
+        help="Format and write the debug output in a background thread")
     option("--debug-ignore", metavar="EXPR", action='append', split=':',
         help="Ignore EXPR sim objects")
     option("--remote-gdb-port", type='int', default=7000,
@@ -349,6 +351,8 @@ def main(*args):
         trace.enable()
 
     trace.output(options.debug_file)
+    if options.debug_async:
+        trace.output_async()
 
     for ignore in options.debug_ignore:
         check_tracing()
@@ -68,9 +68,9 @@ _memory_modes = {
 
 _drain_manager = internal.drain.DrainManager.instance()
 
-# The final hook to generate .ini files.  Called from the user script
-# once the config is built.
-def instantiate(ckpt_dir=None):
+# Finish the configuration and write the .ini/.json/.dot files, but don't
+# create any C++ objects.
+def _finalizeConfig():
     from m5 import options
 
     root = objects.Root.getInstance()
@@ -108,6 +108,26 @@ def instantiate(ckpt_dir=None):
     if options.create_dot:
         do_dot(root, options.outdir, options.dot_config)
 
+    return root
+
+# Only generate the .ini file (--dump-config) for the configuration built by
+# the user script.  The file can be instantiated without Python, e.g., by
+# util/cxx_config, which avoids the per-object Python overhead for large
+# configurations.
+def dumpConfig():
+    from m5 import options
+
+    if not options.dump_config:
+        fatal("dumpConfig() requires --dump-config")
+
+    _finalizeConfig()
+    return os.path.join(options.outdir, options.dump_config)
+
+# The final hook to generate .ini files.  Called from the user script
+# once the config is built.
+def instantiate(ckpt_dir=None):
+    root = _finalizeConfig()
+
     # Initialize the global statistics
     stats.initSimStats()
 
@@ -241,7 +261,8 @@ def switchCpus(system, cpuList, verbose=True):
     system.
 
     Arguments:
-      system -- Simulated system.
+      system -- Simulated system or a list of systems that are switched
+                together (e.g., one per PE)
       cpuList -- (old_cpu, new_cpu) tuples
     """
 
@@ -294,17 +315,19 @@ def switchCpus(system, cpuList, verbose=True):
     for old_cpu, new_cpu in cpuList:
         old_cpu.switchOut()
 
-    # Change the memory mode if required. We check if this is needed
-    # to avoid printing a warning if no switch was performed.
-    if system.getMemoryMode() != memory_mode:
-        # Flush the memory system if we are switching to a memory mode
-        # that disables caches. This typically happens when switching to a
-        # hardware virtualized CPU.
-        if memory_mode == objects.params.atomic_noncaching:
-            memWriteback(system)
-            memInvalidate(system)
-
-        _changeMemoryMode(system, memory_mode)
+    systems = system if isinstance(system, list) else [system]
+    for system in systems:
+        # Change the memory mode if required. We check if this is needed
+        # to avoid printing a warning if no switch was performed.
+        if system.getMemoryMode() != memory_mode:
+            # Flush the memory system if we are switching to a memory mode
+            # that disables caches. This typically happens when switching
+            # to a hardware virtualized CPU.
+            if memory_mode == objects.params.atomic_noncaching:
+                memWriteback(system)
+                memInvalidate(system)
+
+            _changeMemoryMode(system, memory_mode)
 
     for old_cpu, new_cpu in cpuList:
         new_cpu.takeOverFrom(old_cpu)
@@ -46,6 +46,12 @@ output(const char *filename)
     Trace::setDebugLogger(new Trace::OstreamLogger(*file_stream));
 }
 
+inline void
+output_async()
+{
+    Trace::setDebugLogger(new Trace::AsyncLogger(Trace::getDebugLogger()));
+}
+
 inline void
 ignore(const char *expr)
 {
@@ -58,5 +64,6 @@ using Trace::enabled;
 %}
 
 extern void output(const char *string);
+extern void output_async();
 extern void ignore(const char *expr);
 extern bool enabled;
@@ -66,8 +66,14 @@ class Root(SimObject):
     eventq_index = 0
 
     # Simulation Quantum for multiple main event queue simulation.
-    # Needs to be set explicitly for a multi-eventq simulation.
-    sim_quantum = Param.Tick(0, "simulation quantum")
+    # If not set, the minimum latency of the links between objects in
+    # different event queues is used, which is the largest safe value.
+    sim_quantum = Param.Tick(0, "simulation quantum (0 = derive from links)")
+    # The quantum can grow up to this value while the event queues do not
+    # communicate. Events that arrive too late are delayed to the current
+    # tick of their event queue and counted in the late_events stat.
+    sim_quantum_max = Param.Tick(0,
+        "upper bound for an adaptive quantum (0 = fixed quantum)")
 
     full_system = Param.Bool("if this is a full system simulation")
 
@@ -66,6 +66,13 @@ class System(MemObject):
     mmap_using_noreserve = Param.Bool(False, "mmap the backing store " \
                                           "without reserving swap")
 
+    # When many systems load the same binaries, most of their memory
+    # contents are identical after initialization. By enabling this
+    # flag, the identical pages of all systems that enable it are
+    # mapped copy-on-write to a single copy on the host at startup.
+    share_identical_pages = Param.Bool(False, "share identical pages of " \
+                                       "the backing store copy-on-write")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
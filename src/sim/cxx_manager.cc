@@ -37,8 +37,12 @@
  * Authors: Andrew Bardsley
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <exception>
 #include <sstream>
+#include <thread>
 
 #include "base/str.hh"
 #include "debug/CxxConfig.hh"
@@ -48,7 +52,7 @@
 
 CxxConfigManager::CxxConfigManager(CxxConfigFileBase &configFile_) :
     configFile(configFile_), flags(configFile_.getFlags()),
-    simObjectResolver(*this)
+    numThreads(1), simObjectResolver(*this)
 {
 }
 
@@ -268,6 +272,17 @@ CxxConfigManager::findObjectParams(const std::string &object_name)
     if (objectParamsByName.find(instance_name) != objectParamsByName.end())
         return objectParamsByName[instance_name];
 
+    CxxConfigParams *object_params = makeObjectParams(object_name);
+    objectParamsByName[instance_name] = object_params;
+
+    return object_params;
+}
+
+CxxConfigParams *
+CxxConfigManager::makeObjectParams(const std::string &object_name)
+{
+    std::string instance_name = rename(object_name);
+
     std::string object_type;
     const CxxConfigDirectoryEntry &entry =
         findObjectType(object_name, object_type);
@@ -402,11 +417,78 @@ CxxConfigManager::findObjectParams(const std::string &object_name)
         throw;
     }
 
-    objectParamsByName[instance_name] = object_params;
-
     return object_params;
 }
 
+void
+CxxConfigManager::findAllObjectParams(
+    const std::vector<std::string> &object_names)
+{
+    std::vector<std::string> todo;
+
+    for (auto i = object_names.begin(); i != object_names.end(); ++i) {
+        if (objectParamsByName.find(rename(*i)) == objectParamsByName.end())
+            todo.push_back(*i);
+    }
+
+    std::vector<CxxConfigParams *> made(todo.size(), NULL);
+
+    try {
+        parallelFor(todo.size(), [&](std::size_t i) {
+            made[i] = makeObjectParams(todo[i]);
+        });
+    } catch (Exception &) {
+        /* Keep the ones that were made to free them with the others */
+        for (std::size_t i = 0; i < todo.size(); ++i) {
+            if (made[i])
+                objectParamsByName[rename(todo[i])] = made[i];
+        }
+        throw;
+    }
+
+    for (std::size_t i = 0; i < todo.size(); ++i)
+        objectParamsByName[rename(todo[i])] = made[i];
+}
+
+void
+CxxConfigManager::parallelFor(std::size_t count,
+    const std::function<void(std::size_t)> &func)
+{
+    unsigned int threads = std::min<std::size_t>(numThreads, count);
+
+    /* The trace isn't thread safe and would be out of order anyway */
+    if (threads <= 1 || DTRACE(CxxConfig)) {
+        for (std::size_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::vector<std::exception_ptr> errors(count);
+
+    auto work = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            try {
+                func(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads; ++t)
+        workers.emplace_back(work);
+    work();
+    for (auto w = workers.begin(); w != workers.end(); ++w)
+        w->join();
+
+    for (auto e = errors.begin(); e != errors.end(); ++e) {
+        if (*e)
+            std::rethrow_exception(*e);
+    }
+}
+
 void
 CxxConfigManager::findAllObjects()
 {
@@ -417,6 +499,12 @@ CxxConfigManager::findAllObjects()
      *  even with config file reorganisation */
     std::sort(objects.begin(), objects.end());
 
+    /* Parsing the parameter values is most of the work and is independent
+     *  between objects, so do that for all objects up front.  The
+     *  SimObjects are then constructed in order as their constructors
+     *  register themselves in global structures */
+    findAllObjectParams(objects);
+
     for (auto i = objects.begin(); i != objects.end(); ++i)
         findObject(*i);
 
@@ -445,8 +533,22 @@ CxxConfigManager::findTraversalOrder(const std::string &object_name)
 void
 CxxConfigManager::bindAllPorts()
 {
-    for (auto i = objectsInOrder.begin(); i != objectsInOrder.end(); ++i)
-        bindObjectPorts(*i);
+    std::vector<SimObject *> objects(objectsInOrder.begin(),
+        objectsInOrder.end());
+    std::vector<std::vector<PortBinding>> bindings(objects.size());
+
+    /* Look up the peers in parallel, but bind in order, because
+     *  getMasterPort/getSlavePort may create the ports on demand */
+    parallelFor(objects.size(), [&](std::size_t i) {
+        resolveObjectPorts(objects[i], bindings[i]);
+    });
+
+    for (auto o = bindings.begin(); o != bindings.end(); ++o) {
+        for (auto b = o->begin(); b != o->end(); ++b) {
+            bindPort(b->masterObject, b->masterPort, b->masterPortIndex,
+                b->slaveObject, b->slavePort, b->slavePortIndex);
+        }
+    }
 }
 
 void
@@ -505,6 +607,21 @@ void
 CxxConfigManager::bindMasterPort(SimObject *object,
     const CxxConfigDirectoryEntry::PortDesc &port,
     const std::vector<std::string> &peers)
+{
+    std::vector<PortBinding> bindings;
+    resolveMasterPort(object, port, peers, bindings);
+
+    for (auto b = bindings.begin(); b != bindings.end(); ++b) {
+        bindPort(b->masterObject, b->masterPort, b->masterPortIndex,
+            b->slaveObject, b->slavePort, b->slavePortIndex);
+    }
+}
+
+void
+CxxConfigManager::resolveMasterPort(SimObject *object,
+    const CxxConfigDirectoryEntry::PortDesc &port,
+    const std::vector<std::string> &peers,
+    std::vector<PortBinding> &bindings)
 {
     unsigned int master_port_index = 0;
 
@@ -521,15 +638,16 @@ CxxConfigManager::bindMasterPort(SimObject *object,
 
         std::string slave_instance_name = rename(slave_object_name);
 
-        if (objectsByName.find(slave_instance_name) == objectsByName.end()) {
+        auto slave = objectsByName.find(slave_instance_name);
+        if (slave == objectsByName.end()) {
             throw Exception(object->name(), csprintf(
                 "Can't find slave port object: %s", slave_instance_name));
         }
 
-        SimObject *slave_object = objectsByName[slave_instance_name];
-
-        bindPort(object, port.name, master_port_index,
-            slave_object, slave_port_name, slave_port_index);
+        PortBinding binding = { object, port.name,
+            (PortID)master_port_index, slave->second, slave_port_name,
+            (PortID)slave_port_index };
+        bindings.push_back(binding);
 
         master_port_index++;
     }
@@ -537,6 +655,19 @@ CxxConfigManager::bindMasterPort(SimObject *object,
 
 void
 CxxConfigManager::bindObjectPorts(SimObject *object)
+{
+    std::vector<PortBinding> bindings;
+    resolveObjectPorts(object, bindings);
+
+    for (auto b = bindings.begin(); b != bindings.end(); ++b) {
+        bindPort(b->masterObject, b->masterPort, b->masterPortIndex,
+            b->slaveObject, b->slavePort, b->slavePortIndex);
+    }
+}
+
+void
+CxxConfigManager::resolveObjectPorts(SimObject *object,
+    std::vector<PortBinding> &bindings)
 {
     /* We may want to separate object->name() from the name in configuration
      *  later to allow (for example) repetition of fragments of configs */
@@ -569,7 +700,7 @@ CxxConfigManager::bindObjectPorts(SimObject *object)
                     port->name, peers.size()));
             }
 
-            bindMasterPort(object, *port, peers);
+            resolveMasterPort(object, *port, peers, bindings);
         }
     }
 }
@@ -733,3 +864,9 @@ void CxxConfigManager::addRenaming(const Renaming &renaming)
 {
     renamings.push_back(renaming);
 }
+
+void
+CxxConfigManager::setNumThreads(unsigned int num_threads)
+{
+    numThreads = std::max(num_threads, 1U);
+}
@@ -52,6 +52,7 @@
 #ifndef __SIM_CXX_MANAGER_HH__
 #define __SIM_CXX_MANAGER_HH__
 
+#include <functional>
 #include <list>
 #include <map>
 #include <set>
@@ -74,6 +75,11 @@ class CxxConfigManager
     /** Flags to pass to affect param setting */
     CxxConfigParams::Flags flags;
 
+    /** Number of host threads used to fill in the ...Params objects and to
+     *  resolve port peers.  Object construction itself is always done
+     *  by the calling thread */
+    unsigned int numThreads;
+
   public:
     /** Exception for instantiate/post-instantiate errors */
     class Exception : public std::exception
@@ -127,6 +133,18 @@ class CxxConfigManager
     /** All the renamings applicable when instantiating objects */
     std::list<Renaming> renamings;
 
+    /** A single connection between two objects' ports, resolved from the
+     *  config file but not yet bound */
+    struct PortBinding
+    {
+        SimObject *masterObject;
+        std::string masterPort;
+        PortID masterPortIndex;
+        SimObject *slaveObject;
+        std::string slavePort;
+        PortID slavePortIndex;
+    };
+
     /** Bind a single connection between two objects' ports */
     void bindPort(SimObject *masterObject, const std::string &masterPort,
         PortID masterPortIndex, SimObject *slaveObject,
@@ -139,6 +157,34 @@ class CxxConfigManager
         const CxxConfigDirectoryEntry::PortDesc &port,
         const std::vector<std::string> &peers);
 
+    /** Resolve the peers of a master port as bindMasterPort does, but
+     *  only append the connections to bindings.  This doesn't modify
+     *  the manager and so can be called from several threads */
+    void resolveMasterPort(SimObject *object,
+        const CxxConfigDirectoryEntry::PortDesc &port,
+        const std::vector<std::string> &peers,
+        std::vector<PortBinding> &bindings);
+
+    /** Resolve all master port connections of a single SimObject into
+     *  bindings.  Thread safe like resolveMasterPort */
+    void resolveObjectPorts(SimObject *object,
+        std::vector<PortBinding> &bindings);
+
+    /** Make and fill in the ...Params object for the named object without
+     *  adding it to objectParamsByName.  Thread safe as long as the
+     *  configuration file isn't modified */
+    CxxConfigParams *makeObjectParams(const std::string &object_name);
+
+    /** Make the ...Params objects of all the given objects that don't
+     *  have one yet, using numThreads threads */
+    void findAllObjectParams(const std::vector<std::string> &object_names);
+
+    /** Call func for all indices in [0, count), distributed over
+     *  numThreads threads.  If any of the calls throws, the exception of
+     *  the lowest index is rethrown after all calls have been made */
+    void parallelFor(std::size_t count,
+        const std::function<void(std::size_t)> &func);
+
     /** Apply the first matching renaming in renamings to the given name */
     std::string rename(const std::string &from_name);
 
@@ -185,6 +231,12 @@ class CxxConfigManager
      *  applied while processing instantiations */
     void addRenaming(const Renaming &renaming);
 
+    /** Set the number of host threads used by findAllObjects and
+     *  instantiate to parse the parameters and port connections of the
+     *  objects.  With CxxConfig tracing enabled, everything is done by
+     *  the calling thread to keep the trace in order */
+    void setNumThreads(unsigned int num_threads);
+
   public:
     /** Bind the ports of a single SimObject */
     void bindObjectPorts(SimObject *object);
@@ -258,7 +310,8 @@ class CxxConfigManager
     void forEachObject(void (SimObject::*mem_func)());
 
     /** Find all objects by iterating over the object names in the config
-     *  file with findObject.  Also populate the traversal order */
+     *  file with findObject.  Also populate the traversal order.  The
+     *  ...Params objects of all objects are filled in in parallel first */
     void findAllObjects();
 
     /** Parse a port string of the form 'path(.path)*.port[index]' into
@@ -48,6 +48,7 @@
 using namespace std;
 
 Tick simQuantum = 0;
+Tick simQuantumMax = 0;
 
 //
 // Main Event Queues
@@ -225,6 +226,7 @@ EventQueue::serviceOne()
         // forward current cycle to the time when this event occurs.
         setCurTick(event->when());
 
+        _numProcessed++;
         event->process();
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::AutoDelete) ||
@@ -415,28 +417,42 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), _numProcessed(0), _numLate(0),
+      _barrierWait(0), _numRemote(0)
 {
 }
 
+uint64_t
+EventQueue::numRemote() const
+{
+    return _numRemote.load(std::memory_order_relaxed);
+}
+
 void
 EventQueue::asyncInsert(Event *event)
 {
-    async_queue_mutex.lock();
-    async_queue.push_back(event);
-    async_queue_mutex.unlock();
+    async_queue.push(event);
 }
 
 void
 EventQueue::handleAsyncInsertions()
 {
     assert(this == curEventQueue());
-    async_queue_mutex.lock();
 
-    while (!async_queue.empty()) {
-        insert(async_queue.front());
-        async_queue.pop_front();
+    // take all events at once; insert() overwrites the link
+    Event *event = async_queue.popAll();
+    while (event) {
+        Event *next = event->nextBin;
+        // with an adaptive quantum, we might be past the event already
+        if (event->when() < getCurTick()) {
+            panic_if(!adaptiveQuantum(),
+                     "%s: event %s arrived at %d, after its time %d; "
+                     "the quantum is too large\n", name(),
+                     event->name(), getCurTick(), event->when());
+            event->setWhen(getCurTick(), this);
+            _numLate++;
+        }
+        insert(event);
+        event = next;
     }
-
-    async_queue_mutex.unlock();
 }
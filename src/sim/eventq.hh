@@ -39,6 +39,7 @@
 #define __SIM_EVENTQ_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <iosfwd>
@@ -48,6 +49,7 @@
 
 #include "base/flags.hh"
 #include "base/misc.hh"
+#include "base/mpsc_queue.hh"
 #include "base/types.hh"
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
@@ -62,6 +64,19 @@ class BaseGlobalEvent;
 //! Queue B should be at least simQuantum ticks away in future.
 extern Tick simQuantum;
 
+//! Upper bound for the adaptive quantum. If it is larger than
+//! simQuantum, the quantum grows while no events are exchanged between
+//! the queues. Events that arrive too late are moved to the current
+//! tick of the receiving queue. 0 disables the adaptation.
+extern Tick simQuantumMax;
+
+//! Whether the quantum adapts itself and events might arrive too late.
+inline bool
+adaptiveQuantum()
+{
+    return simQuantumMax > simQuantum;
+}
+
 //! Current number of allocated main event queues.
 extern uint32_t numMainEventQueues;
 
@@ -449,11 +464,24 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
-    //! Mutex to protect async queue.
-    std::mutex async_queue_mutex;
+    //! Number of events that have been processed by this queue.
+    uint64_t _numProcessed;
+
+    //! Number of events that arrived after their time.
+    uint64_t _numLate;
 
-    //! List of events added by other threads to this event queue.
-    std::list<Event*> async_queue;
+    //! Host seconds spent waiting on global barriers.
+    double _barrierWait;
+
+#ifndef SWIG
+    //! Number of events scheduled on this queue by other queues.
+    std::atomic<uint64_t> _numRemote;
+
+    //! Events added by other threads to this event queue. The queue is
+    //! lock-free and links the events through their nextBin pointer,
+    //! which is unused until the event is inserted into this queue.
+    MpscQueue<Event, &Event::nextBin> async_queue;
+#endif
 
     /**
      * Lock protecting event handling.
@@ -572,6 +600,18 @@ class EventQueue
     Tick nextTick() const { return head->when(); }
     void setCurTick(Tick newVal) { _curTick = newVal; }
     Tick getCurTick() const { return _curTick; }
+
+    //! Number of events that have been processed so far.
+    uint64_t numProcessed() const { return _numProcessed; }
+
+    //! Number of events that have been scheduled by other queues.
+    uint64_t numRemote() const;
+    //! Number of events that arrived from other queues too late.
+    uint64_t numLate() const { return _numLate; }
+
+    //! Host seconds this queue has waited on global barriers.
+    double barrierWait() const { return _barrierWait; }
+    void addBarrierWait(double secs) { _barrierWait += secs; }
     Event *getHead() const { return head; }
 
     Event *serviceOne();
@@ -41,7 +41,10 @@
 inline void
 EventQueue::schedule(Event *event, Tick when, bool global)
 {
-    assert(when >= getCurTick());
+    // other queues might be ahead of us, if the quantum is adaptive
+    assert(when >= getCurTick() ||
+           (inParallelMode && this != curEventQueue() &&
+            adaptiveQuantum()));
     assert(!event->scheduled());
     assert(event->initialized());
 
@@ -54,6 +57,8 @@ EventQueue::schedule(Event *event, Tick when, bool global)
     //    a total order amongst the global events. See global_event.{cc,hh}
     //    for more explanation.
     if (inParallelMode && (this != curEventQueue() || global)) {
+        if (!global)
+            _numRemote.fetch_add(1, std::memory_order_relaxed);
         asyncInsert(event);
     } else {
         insert(event);
@@ -31,6 +31,8 @@
 
 #include "sim/global_event.hh"
 
+#include <algorithm>
+
 std::mutex BaseGlobalEvent::globalQMutex;
 
 BaseGlobalEvent::BaseGlobalEvent(Priority p, Flags f)
@@ -151,9 +153,28 @@ GlobalSyncEvent::BarrierEvent::process()
     curEventQueue()->handleAsyncInsertions();
 }
 
+uint64_t
+GlobalSyncEvent::remoteEvents()
+{
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        count += mainEventQueue[i]->numRemote();
+    return count;
+}
+
 void
 GlobalSyncEvent::process()
 {
+    if (maxRepeat > minRepeat) {
+        // all threads wait on the barrier, so nobody schedules events
+        uint64_t remote = remoteEvents();
+        if (remote == lastRemote)
+            repeat = std::min(repeat * 2, maxRepeat);
+        else
+            repeat = minRepeat;
+        lastRemote = remote;
+    }
+
     if (repeat) {
         schedule(curTick() + repeat);
     }
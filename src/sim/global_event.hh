@@ -32,6 +32,7 @@
 #ifndef __SIM_GLOBAL_EVENT_HH__
 #define __SIM_GLOBAL_EVENT_HH__
 
+#include <chrono>
 #include <mutex>
 #include <vector>
 
@@ -99,8 +100,18 @@ class BaseGlobalEvent : public EventBase
             // locked when entering this method. We need to unlock it
             // while waiting on the barrier to prevent deadlocks if
             // another thread wants to lock the event queue.
-            EventQueue::ScopedRelease release(curEventQueue());
-            return _globalEvent->barrier.wait();
+            EventQueue *queue = curEventQueue();
+            EventQueue::ScopedRelease release(queue);
+            // with a single event queue, there is nobody to wait for
+            if (numMainEventQueues == 1)
+                return _globalEvent->barrier.wait();
+
+            auto start = std::chrono::steady_clock::now();
+            bool last = _globalEvent->barrier.wait();
+            std::chrono::duration<double> waited =
+                std::chrono::steady_clock::now() - start;
+            queue->addBarrierWait(waited.count());
+            return last;
         }
 
       public:
@@ -203,6 +214,11 @@ class GlobalEvent : public BaseGlobalEventTemplate<GlobalEvent>
  * A special global event that synchronizes all threads and forces
  * them to process asynchronously enqueued events.  Useful for
  * separating quanta in a quantum-based parallel simulation.
+ *
+ * If maxRepeat is larger than repeat, the period is adaptive: it is
+ * doubled up to maxRepeat whenever no events have been exchanged
+ * between the queues during the last period and falls back to the
+ * initial period as soon as they communicate again.
  */
 class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
 {
@@ -219,11 +235,14 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
     };
 
     GlobalSyncEvent(Priority p, Flags f)
-        : Base(p, f)
+        : Base(p, f), repeat(0), minRepeat(0), maxRepeat(0),
+          lastRemote(0)
     { }
 
-    GlobalSyncEvent(Tick when, Tick _repeat, Priority p, Flags f)
-        : Base(p, f), repeat(_repeat)
+    GlobalSyncEvent(Tick when, Tick _repeat, Priority p, Flags f,
+                    Tick _max_repeat = 0)
+        : Base(p, f), repeat(_repeat), minRepeat(_repeat),
+          maxRepeat(_max_repeat), lastRemote(remoteEvents())
     {
         schedule(when);
     }
@@ -233,6 +252,13 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
     const char *description() const;
 
     Tick repeat;
+    const Tick minRepeat;
+    const Tick maxRepeat;
+
+  private:
+    static uint64_t remoteEvents();
+
+    uint64_t lastRemote;
 };
 
 
@@ -28,6 +28,7 @@
  */
 
 #include "sim/mem_system.hh"
+#include "base/memops.hh"
 #include "mem/port_proxy.hh"
 #include "params/MemSystem.hh"
 
@@ -54,7 +55,18 @@ MemSystem::initState()
         fseek(f, 0L, SEEK_END);
         size_t sz = ftell(f);
 
+        // if all replicas fit into one backing store, we write them
+        // directly instead of going through the port in cache lines
+        uint8_t *host = nullptr;
+        AddrRange image(0, sz * replicas - 1);
+        for (auto &store : physmem.getBackingStore())
+        {
+            if (image.isSubset(store.first))
+                host = store.second - store.first.start();
+        }
+
         const size_t BUF_SIZE = 1024 * 1024;
+        const size_t PAGE_SIZE = 4096;
         auto data = new uint8_t[BUF_SIZE];
         unsigned iteration = 0;
         size_t off = 0;
@@ -67,7 +79,20 @@ MemSystem::initState()
                 size_t amount = std::min(rem, BUF_SIZE);
                 if(fread(data, 1, amount, f) != amount)
                     panic("Unable to read '%s'", memFile.c_str());
-                physProxy.writeBlob(off, data, amount);
+
+                if (host)
+                {
+                    // the backing store is still zero. thus, skip the
+                    // zero pages of the image to not make them resident
+                    for (size_t p = 0; p < amount; p += PAGE_SIZE)
+                    {
+                        size_t len = std::min(PAGE_SIZE, amount - p);
+                        if (!MemOps::isZero(data + p, len))
+                            MemOps::copyBlock(host + off + p, data + p, len);
+                    }
+                }
+                else
+                    physProxy.writeBlob(off, data, amount);
 
                 off += amount;
                 rem -= amount;
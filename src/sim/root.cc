@@ -31,6 +31,7 @@
  *          Gabe Black
  */
 
+#include "base/callback.hh"
 #include "base/misc.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
@@ -114,6 +115,7 @@ Root::Root(RootParams *p) : SimObject(p), _enabled(false),
     lastTime.setTimer();
 
     simQuantum = p->sim_quantum;
+    simQuantumMax = p->sim_quantum_max;
 }
 
 void
@@ -122,6 +124,61 @@ Root::initState()
     timeSyncEnable(params()->time_sync_enable);
 }
 
+void
+Root::regStats()
+{
+    SimObject::regStats();
+
+    // the waiting time is host time and would make the stats of
+    // single-threaded simulations nondeterministic. Unnamed stats are
+    // not printed.
+    barrierWait.init(numMainEventQueues);
+    if (numMainEventQueues > 1) {
+        barrierWait
+            .name(name() + ".barrier_wait")
+            .desc("Host seconds spent waiting on global barriers per eventq")
+            .prereq(barrierWait)
+            ;
+    }
+
+    remoteEvents
+        .init(numMainEventQueues)
+        .name(name() + ".remote_events")
+        .desc("Events scheduled by other event queues per eventq")
+        .prereq(remoteEvents)
+        ;
+
+    lateEvents
+        .init(numMainEventQueues)
+        .name(name() + ".late_events")
+        .desc("Events from other event queues that arrived too late")
+        .prereq(lateEvents)
+        ;
+
+    lastBarrierWait.resize(numMainEventQueues, 0);
+    lastRemoteEvents.resize(numMainEventQueues, 0);
+    lastLateEvents.resize(numMainEventQueues, 0);
+
+    Stats::registerDumpCallback(
+        new MakeCallback<Root, &Root::updateQueueStats>(this));
+}
+
+void
+Root::updateQueueStats()
+{
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        EventQueue *q = mainEventQueue[i];
+
+        barrierWait[i] += q->barrierWait() - lastBarrierWait[i];
+        remoteEvents[i] += q->numRemote() - lastRemoteEvents[i];
+        lateEvents[i] += q->numLate() - lastLateEvents[i];
+
+        lastBarrierWait[i] = q->barrierWait();
+        lastRemoteEvents[i] = q->numRemote();
+        lastLateEvents[i] = q->numLate();
+    }
+}
+
 void
 Root::loadState(CheckpointIn &cp)
 {
@@ -41,6 +41,9 @@
 #ifndef __SIM_ROOT_HH__
 #define __SIM_ROOT_HH__
 
+#include <vector>
+
+#include "base/statistics.hh"
 #include "base/time.hh"
 #include "params/Root.hh"
 #include "sim/eventq.hh"
@@ -63,6 +66,24 @@ class Root : public SimObject
     EventWrapper<Root, &Root::timeSync> syncEvent;
     friend class EventWrapper<Root, &Root::timeSync>;
 
+    /**
+     * Host seconds each event queue waited on global barriers (only
+     * reported with multiple event queues)
+     */
+    Stats::Vector barrierWait;
+    /** Events each event queue received from other queues */
+    Stats::Vector remoteEvents;
+    /** Events from other queues that arrived too late */
+    Stats::Vector lateEvents;
+
+    /** The values of the event queue counters at the last dump */
+    std::vector<double> lastBarrierWait;
+    std::vector<uint64_t> lastRemoteEvents;
+    std::vector<uint64_t> lastLateEvents;
+
+    /** Add the counter increments since the last dump to the stats */
+    void updateQueueStats();
+
   public:
     /**
      * Use this function to get a pointer to the single Root object in the
@@ -112,6 +133,8 @@ class Root : public SimObject
      */
     void initState();
 
+    void regStats() M5_ATTR_OVERRIDE;
+
     void serialize(CheckpointOut &cp) const M5_ATTR_OVERRIDE;
     void unserialize(CheckpointIn &cp) M5_ATTR_OVERRIDE;
 };
@@ -37,6 +37,7 @@
 #include "base/misc.hh"
 #include "base/pollevent.hh"
 #include "base/types.hh"
+#include "mem/mem_object.hh"
 #include "sim/async.hh"
 #include "sim/eventq_impl.hh"
 #include "sim/sim_events.hh"
@@ -114,12 +115,21 @@ simulate(Tick num_cycles)
 
     GlobalSyncEvent *quantum_event = NULL;
     if (numMainEventQueues > 1) {
+        // the links between the queues determine the safe quantum
+        static Tick lookahead = MemObject::crossQueueLookahead();
         if (simQuantum == 0) {
-            fatal("Quantum for multi-eventq simulation not specified");
+            fatal_if(lookahead == 0, "Quantum for multi-eventq simulation "
+                     "not specified and not derivable from the links\n");
+            simQuantum = lookahead;
+            inform("Using the minimum link latency of %d ticks as quantum\n",
+                   simQuantum);
+        } else if (lookahead != 0 && simQuantum > lookahead) {
+            warn("Quantum of %d ticks exceeds the minimum link latency "
+                 "of %d ticks\n", simQuantum, lookahead);
         }
 
         quantum_event = new GlobalSyncEvent(curTick() + simQuantum, simQuantum,
-                            EventBase::Progress_Event_Pri, 0);
+                            EventBase::Progress_Event_Pri, 0, simQuantumMax);
 
         inParallelMode = true;
     }
@@ -103,6 +103,15 @@ statFinalTick()
     return curTick();
 }
 
+Counter
+statProcessedEvents()
+{
+    Counter total = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        total += mainEventQueue[i]->numProcessed();
+    return total;
+}
+
 SimTicksReset simTicksReset;
 
 struct Global
@@ -112,6 +121,7 @@ struct Global
     Stats::Formula hostTickRate;
     Stats::Value hostMemory;
     Stats::Value hostSeconds;
+    Stats::Value hostEvents;
 
     Stats::Value simInsts;
     Stats::Value simOps;
@@ -189,6 +199,13 @@ Global::Global()
         .precision(2)
         ;
 
+    hostEvents
+        .functor(statProcessedEvents)
+        .name("host_events")
+        .desc("Number of events processed on the host")
+        .precision(0)
+        ;
+
     hostTickRate
         .name("host_tick_rate")
         .desc("Simulator tick rate (ticks/s)")
@@ -74,6 +74,7 @@ using namespace std;
 using namespace TheISA;
 
 vector<System *> System::systemList;
+bool System::pagesShared = false;
 
 int System::numSystemsRunning = 0;
 
@@ -291,6 +292,25 @@ System::initState()
     }
 }
 
+void
+System::startup()
+{
+    MemObject::startup();
+
+    // all memories have been initialized (or restored) by now
+    if (!pagesShared) {
+        pagesShared = true;
+
+        vector<PhysicalMemory*> mems;
+        for (auto sys : systemList) {
+            if (sys->params()->share_identical_pages)
+                mems.push_back(&sys->physmem);
+        }
+        if (!mems.empty())
+            PhysicalMemory::shareIdenticalPages(mems);
+    }
+}
+
 void
 System::replaceThreadContext(ThreadContext *tc, ContextID context_id)
 {
@@ -390,6 +410,18 @@ System::regStats()
                          .desc("Run time stat for" + namestr.str())
                          .prereq(*workItemStats[j]);
     }
+
+    sharedPages
+        .method(&physmem, &PhysicalMemory::sharedPages)
+        .name(name() + ".sharedPages")
+        .desc("Number of host pages shared with other systems at startup")
+        ;
+
+    privatePages
+        .method(&physmem, &PhysicalMemory::privatePages)
+        .name(name() + ".privatePages")
+        .desc("Number of private resident host pages at startup")
+        ;
 }
 
 void
@@ -492,6 +492,12 @@ class System : public MemObject
 
     void initState();
 
+    /**
+     * The first system to start up shares the identical pages of the
+     * backing stores of all systems that ask for it.
+     */
+    void startup() M5_ATTR_OVERRIDE;
+
     const Params *params() const { return (const Params *)_params; }
 
   public:
@@ -535,6 +541,9 @@ class System : public MemObject
     std::map<std::pair<uint32_t,uint32_t>, Tick>  lastWorkItemStarted;
     std::map<uint32_t, Stats::Histogram*> workItemStats;
 
+    Stats::Value sharedPages;
+    Stats::Value privatePages;
+
     ////////////////////////////////////////////
     //
     // STATIC GLOBAL SYSTEM LIST
@@ -544,6 +553,9 @@ class System : public MemObject
     static std::vector<System *> systemList;
     static int numSystemsRunning;
 
+    // whether the identical pages of the systems have been shared
+    static bool pagesShared;
+
     static void printSystems();
 
     // For futex system call
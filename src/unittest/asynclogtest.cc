@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/spsc_ring.hh"
+#include "base/trace.hh"
+#include "unittest/unittest.hh"
+
+enum Color { RED, GREEN };
+
+struct Point
+{
+    int x, y;
+};
+
+std::ostream &
+operator<<(std::ostream &os, const Point &p)
+{
+    return os << "(" << p.x << "," << p.y << ")";
+}
+
+// writes the same messages to the given logger
+static void
+logMessages(Trace::Logger *logger, unsigned count)
+{
+    std::string dynFmt = "dynamic %d\n";
+    for (unsigned i = 0; i < count; ++i) {
+        std::string obj = "system.pe" + std::to_string(i % 5) + ".dtu";
+        std::string tmp = "tmp" + std::to_string(i);
+        Point p = {(int)i, -(int)i};
+
+        logger->dprintf(i, obj, "int %d hex %#x float %.3f\n", i, i * 16,
+                        i / 3.0);
+        logger->dprintf(i, obj, "str %s cstr %s lit %s\n", tmp,
+                        tmp.c_str(), "literal");
+        logger->dprintf(i, obj, "enum %d bool %s char %c\n", GREEN,
+                        i & 1 ? true : false, 'a' + (char)(i % 26));
+        // not captured raw: a user-defined type and a dynamic format
+        logger->dprintf(i, obj, "point %s\n", p);
+        logger->dprintf(i, obj, dynFmt.c_str(), i);
+        logger->dprintf((Tick)-1, std::string(), "raw %u\n", i);
+        logger->dump(i, obj, tmp.c_str(), tmp.size());
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    UnitTest::setCase("SpscRing wrap-around");
+    {
+        SpscRing ring(256);
+        unsigned next = 0, expected = 0;
+        for (unsigned round = 0; round < 1000; ++round) {
+            // add records of different sizes until the ring is full
+            size_t size = 4 + (round * 7) % 60;
+            while (void *p = ring.alloc(size)) {
+                *static_cast<unsigned*>(p) = next++;
+                ring.push();
+            }
+            // take half of them out again
+            for (unsigned i = 0; i < 2 && !ring.empty(); ++i) {
+                void *p = ring.front();
+                EXPECT_EQ(*static_cast<unsigned*>(p), expected++);
+                ring.pop();
+            }
+        }
+        while (void *p = ring.front()) {
+            EXPECT_EQ(*static_cast<unsigned*>(p), expected++);
+            ring.pop();
+        }
+        EXPECT_EQ(expected, next);
+        EXPECT_TRUE(ring.empty());
+    }
+
+    UnitTest::setCase("SpscRing with two threads");
+    {
+        SpscRing ring(1024);
+        const unsigned count = 100000;
+        std::thread producer([&] {
+            for (unsigned i = 0; i < count; ++i) {
+                void *p;
+                while (!(p = ring.alloc(4 + i % 100)))
+                    std::this_thread::yield();
+                *static_cast<unsigned*>(p) = i;
+                ring.push();
+            }
+        });
+
+        unsigned expected = 0;
+        bool ordered = true;
+        while (expected < count) {
+            void *p = ring.front();
+            if (!p)
+                continue;
+            ordered &= *static_cast<unsigned*>(p) == expected++;
+            ring.pop();
+        }
+        producer.join();
+        EXPECT_TRUE(ordered);
+        EXPECT_TRUE(ring.empty());
+    }
+
+    UnitTest::setCase("AsyncLogger output");
+    {
+        std::ostringstream syncOut;
+        Trace::OstreamLogger syncLogger(syncOut);
+        logMessages(&syncLogger, 500);
+
+        // a small buffer to make the producer wait for the writer
+        std::ostringstream asyncOut;
+        Trace::AsyncLogger asyncLogger(new Trace::OstreamLogger(asyncOut),
+                                       4096);
+        logMessages(&asyncLogger, 500);
+        asyncLogger.sync();
+
+        EXPECT_EQ(asyncOut.str(), syncOut.str());
+
+        // after stopping, messages are written directly
+        asyncLogger.stop();
+        asyncLogger.dprintf(1, "late", "%s\n", "message");
+        EXPECT_EQ(asyncOut.str().substr(syncOut.str().size()),
+                  "      1: late: message\n");
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Measures the cost of injecting events into the event queue of another
+ * thread, comparing the former mutex-protected list with the lock-free
+ * MpscQueue. The producer threads insert a number of events per simulation
+ * quantum concurrently; at the end of each quantum, all threads meet at a
+ * barrier (as with sim_quantum) and the owning thread drains its queue in
+ * one batch.
+ *
+ * Usage: asyncqueuetime [producers] [events per quantum] [quanta]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/barrier.hh"
+#include "base/cprintf.hh"
+#include "base/mpsc_queue.hh"
+
+struct Item
+{
+    Item *next;
+};
+
+class LockedQueue
+{
+  public:
+    void push(Item *item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(item);
+    }
+
+    unsigned drain()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned count = items.size();
+        items.clear();
+        return count;
+    }
+
+  private:
+    std::mutex mutex;
+    std::list<Item*> items;
+};
+
+class LockFreeQueue
+{
+  public:
+    void push(Item *item)
+    {
+        queue.push(item);
+    }
+
+    unsigned drain()
+    {
+        unsigned count = 0;
+        for (Item *i = queue.popAll(); i; i = i->next)
+            count++;
+        return count;
+    }
+
+  private:
+    MpscQueue<Item, &Item::next> queue;
+};
+
+template <class Q>
+static double
+run(unsigned producers, unsigned perQuantum, unsigned quanta)
+{
+    Q queue;
+    Barrier barrier(producers + 1);
+    std::vector<Item> items(producers * perQuantum);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (unsigned q = 0; q < quanta; ++q) {
+                for (unsigned i = 0; i < perQuantum; ++i)
+                    queue.push(&items[p * perQuantum + i]);
+                // end of the quantum
+                barrier.wait();
+                // wait until the owner has drained its queue
+                barrier.wait();
+            }
+        });
+    }
+
+    unsigned long total = 0;
+    for (unsigned q = 0; q < quanta; ++q) {
+        barrier.wait();
+        total += queue.drain();
+        barrier.wait();
+    }
+
+    for (auto &t : threads)
+        t.join();
+
+    auto end = std::chrono::steady_clock::now();
+    if (total != (unsigned long)producers * perQuantum * quanta)
+        ccprintf(std::cerr, "lost events: %lu\n", total);
+
+    std::chrono::duration<double, std::nano> dur = end - start;
+    return dur.count() / total;
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned producers = argc > 1 ? atoi(argv[1]) : 4;
+    unsigned perQuantum = argc > 2 ? atoi(argv[2]) : 1000;
+    unsigned quanta = argc > 3 ? atoi(argv[3]) : 1000;
+
+    ccprintf(std::cout, "%u producers, %u events per quantum, %u quanta\n",
+             producers, perQuantum, quanta);
+
+    double locked = run<LockedQueue>(producers, perQuantum, quanta);
+    ccprintf(std::cout, "mutex + list: %8.2f ns/event\n", locked);
+
+    double lockfree = run<LockFreeQueue>(producers, perQuantum, quanta);
+    ccprintf(std::cout, "MpscQueue:    %8.2f ns/event\n", lockfree);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/memops.hh"
+#include "unittest/unittest.hh"
+
+static const size_t sizes[] = {
+    0, 1, 7, 8, 15, 16, 31, 33, 63, 64, 65, 127, 128, 129, 255, 4095, 4096,
+    4097, 8192 + 77
+};
+
+// UnitTest only keeps a pointer to the name of the case
+static std::string caseName;
+
+static void
+setCase(MemOps::Impl impl, const char *op)
+{
+    caseName = csprintf("%s: %s", MemOps::implName(impl), op);
+    UnitTest::setCase(caseName.c_str());
+}
+
+static void
+testImpl(MemOps::Impl impl)
+{
+    MemOps::setImpl(impl);
+
+    // some guard space behind and an offset to get misaligned blocks
+    std::vector<uint8_t> a(16384), b(16384);
+
+    setCase(impl, "isZero");
+    for (size_t size : sizes) {
+        for (size_t off = 0; off < 32; off += 5) {
+            std::fill(a.begin(), a.end(), 0);
+            // non-zero bytes around the block must not matter
+            if (off > 0)
+                a[off - 1] = 1;
+            a[off + size] = 1;
+            EXPECT_TRUE(MemOps::isZero(&a[off], size));
+
+            // a single non-zero byte anywhere in the block
+            for (size_t i = 0; i < size; i += size / 13 + 1) {
+                a[off + i] = 0x80;
+                EXPECT_FALSE(MemOps::isZero(&a[off], size));
+                a[off + i] = 0;
+            }
+            if (size > 0) {
+                a[off + size - 1] = 1;
+                EXPECT_FALSE(MemOps::isZero(&a[off], size));
+            }
+        }
+    }
+
+    setCase(impl, "equal");
+    for (size_t size : sizes) {
+        for (size_t off = 0; off < 32; off += 7) {
+            for (size_t i = 0; i < a.size(); ++i)
+                a[i] = b[i] = i * 7 + 3;
+            // differences around the block must not matter
+            if (off > 0)
+                b[off - 1] ^= 1;
+            b[off + size] ^= 1;
+            EXPECT_TRUE(MemOps::equal(&a[off], &b[off], size));
+
+            for (size_t i = 0; i < size; i += size / 13 + 1) {
+                b[off + i] ^= 0x40;
+                EXPECT_FALSE(MemOps::equal(&a[off], &b[off], size));
+                b[off + i] ^= 0x40;
+            }
+        }
+    }
+
+    setCase(impl, "copyBlock");
+    for (size_t size : sizes) {
+        for (size_t off = 0; off < 32; off += 3) {
+            for (size_t i = 0; i < a.size(); ++i) {
+                a[i] = i * 13 + 1;
+                b[i] = 0xff;
+            }
+            // copy from a different alignment than the destination
+            MemOps::copyBlock(&b[off], &a[1], size);
+            EXPECT_EQ(memcmp(&b[off], &a[1], size), 0);
+            // nothing is written outside of the block
+            if (off > 0)
+                EXPECT_EQ(b[off - 1], 0xff);
+            EXPECT_EQ(b[off + size], 0xff);
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    for (int i = 0; i <= MemOps::bestImpl(); ++i)
+        testImpl(static_cast<MemOps::Impl>(i));
+
+    return UnitTest::printResults();
+}
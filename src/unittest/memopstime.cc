@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+/**
+ * @file
+ * Measures the throughput of the MemOps functions for all implementations
+ * the host supports, compared to the byte loops they replace: the word by
+ * word zero check of the checkpoint restore, memcmp and memcpy. Each
+ * operation runs over a buffer of the given size (larger than the host
+ * caches by default), page by page as the callers do.
+ *
+ * Usage: memopstime [buffer size in MiB] [iterations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/memops.hh"
+
+static const size_t PAGE_SIZE = 4096;
+
+static bool
+isZeroLoop(const void *p, size_t size)
+{
+    // the loop PhysicalMemory::unserializeStore used before
+    const long *words = static_cast<const long*>(p);
+    for (size_t i = 0; i < size / sizeof(long); ++i) {
+        if (words[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+template <class F>
+static void
+measure(const char *name, size_t size, unsigned iterations, F func)
+{
+    // warm up
+    func();
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i)
+        func();
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> dur = end - start;
+    double gbs = (double)size * iterations / dur.count() / (1 << 30);
+    ccprintf(std::cout, "  %-20s %8.2f GiB/s\n", name, gbs);
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t size = (argc > 1 ? atoi(argv[1]) : 256) * (size_t)1024 * 1024;
+    unsigned iterations = argc > 2 ? atoi(argv[2]) : 10;
+
+    std::vector<uint8_t> src(size), dst(size);
+    // a zero buffer with a non-zero byte at its end; the zero check has to
+    // look at all bytes
+    src[size - 1] = 1;
+
+    // prevent the compiler from optimizing the calls away
+    volatile unsigned sink = 0;
+    auto perPage = [&](bool (*f)(const void*, size_t)) {
+        unsigned zero = 0;
+        for (size_t off = 0; off < size; off += PAGE_SIZE)
+            zero += f(&src[off], PAGE_SIZE);
+        sink = zero;
+    };
+
+    ccprintf(std::cout, "%lu MiB, %u iterations\n", size >> 20, iterations);
+
+    ccprintf(std::cout, "baseline:\n");
+    measure("zero (long loop)", size, iterations,
+            [&] { perPage(isZeroLoop); });
+    measure("memcmp", size, iterations, [&] {
+        sink = memcmp(&src[0], &dst[0], size);
+    });
+    measure("memcpy", size, iterations, [&] {
+        memcpy(&dst[0], &src[0], size);
+    });
+
+    for (int i = 0; i <= MemOps::bestImpl(); ++i) {
+        MemOps::Impl impl = static_cast<MemOps::Impl>(i);
+        MemOps::setImpl(impl);
+
+        ccprintf(std::cout, "%s:\n", MemOps::implName(impl));
+        measure("isZero", size, iterations,
+                [&] { perPage(MemOps::isZero); });
+        measure("equal", size, iterations, [&] {
+            sink = MemOps::equal(&src[0], &dst[0], size);
+        });
+        measure("copyBlock", size, iterations, [&] {
+            MemOps::copyBlock(&dst[0], &src[0], size);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "base/mpsc_queue.hh"
+#include "unittest/unittest.hh"
+
+struct Item
+{
+    Item(unsigned _producer = 0, unsigned _seq = 0)
+        : producer(_producer), seq(_seq), next(nullptr)
+    {}
+
+    unsigned producer;
+    unsigned seq;
+    Item *next;
+};
+
+typedef MpscQueue<Item, &Item::next> ItemQueue;
+
+int
+main(int argc, char *argv[])
+{
+    UnitTest::setCase("Empty queue");
+    {
+        ItemQueue q;
+        EXPECT_TRUE(q.empty());
+        EXPECT_EQ(q.popAll(), (Item*)nullptr);
+    }
+
+    UnitTest::setCase("FIFO order");
+    {
+        ItemQueue q;
+        Item items[4];
+        for (unsigned i = 0; i < 4; ++i) {
+            items[i].seq = i;
+            q.push(&items[i]);
+        }
+        EXPECT_FALSE(q.empty());
+
+        unsigned seq = 0;
+        for (Item *i = q.popAll(); i; i = i->next)
+            EXPECT_EQ(i->seq, seq++);
+        EXPECT_EQ(seq, 4);
+        EXPECT_TRUE(q.empty());
+
+        // the queue is usable again afterwards
+        q.push(&items[2]);
+        Item *i = q.popAll();
+        EXPECT_EQ(i, &items[2]);
+        EXPECT_EQ(i->next, (Item*)nullptr);
+    }
+
+    UnitTest::setCase("Concurrent producers");
+    {
+        const unsigned producers = 4;
+        const unsigned count = 100000;
+
+        ItemQueue q;
+        std::vector<Item> items(producers * count);
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < producers; ++p) {
+            threads.emplace_back([&q, &items, p, count] {
+                for (unsigned i = 0; i < count; ++i) {
+                    Item &it = items[p * count + i];
+                    it.producer = p;
+                    it.seq = i;
+                    q.push(&it);
+                }
+            });
+        }
+
+        // drain while the producers are still running
+        std::vector<unsigned> next(producers, 0);
+        unsigned received = 0;
+        bool ordered = true;
+        while (received < producers * count) {
+            for (Item *i = q.popAll(); i; i = i->next) {
+                ordered &= i->seq == next[i->producer];
+                next[i->producer] = i->seq + 1;
+                received++;
+            }
+        }
+
+        for (auto &t : threads)
+            t.join();
+
+        EXPECT_TRUE(ordered);
+        EXPECT_EQ(received, producers * count);
+        EXPECT_TRUE(q.empty());
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <cstring>
+#include <list>
+#include <set>
+
+#include "base/pool_alloc.hh"
+#include "unittest/unittest.hh"
+
+struct Small : public PoolAlloc
+{
+    uint64_t a;
+};
+
+struct Large : public PoolAlloc
+{
+    uint8_t data[PoolAlloc::MaxObjSize + 1];
+};
+
+struct Base : public PoolAlloc
+{
+    virtual ~Base() {}
+    uint32_t x;
+};
+
+struct Derived : public Base
+{
+    uint8_t more[100];
+};
+
+struct Huge
+{
+    static void *operator new(size_t) { return ObjectPool<Huge>::allocate(); }
+    static void operator delete(void *p) { ObjectPool<Huge>::deallocate(p); }
+
+    uint8_t data[4000];
+};
+
+int
+main(int argc, char *argv[])
+{
+    UnitTest::setCase("Object reuse");
+    {
+        Small *s1 = new Small;
+        s1->a = 1;
+        delete s1;
+        Small *s2 = new Small;
+#if POOL_ALLOC
+        // the last freed chunk is handed out first
+        EXPECT_EQ(s1, s2);
+#endif
+        delete s2;
+    }
+
+    UnitTest::setCase("Distinct objects");
+    {
+        std::set<Small*> objs;
+        // more than fit into one slab
+        for (size_t i = 0; i < PoolAlloc::SlabSize / 16 + 10; ++i)
+        {
+            Small *s = new Small;
+            s->a = i;
+            EXPECT_TRUE(objs.insert(s).second);
+        }
+
+        // nothing has been overwritten
+        uint64_t sum = 0;
+        for (auto s : objs)
+            sum += s->a;
+        EXPECT_EQ(sum, (objs.size() - 1) * objs.size() / 2);
+
+        for (auto s : objs)
+            delete s;
+    }
+
+    UnitTest::setCase("Large objects");
+    {
+        Large *l = new Large;
+        memset(l->data, 0xFF, sizeof(l->data));
+        delete l;
+    }
+
+    UnitTest::setCase("Polymorphic objects");
+    {
+        Base *b = new Derived;
+        b->x = 42;
+        delete b;
+
+        // the Derived chunk is not used for a Base object
+        Base *b2 = new Base;
+        Derived *d = new Derived;
+#if POOL_ALLOC
+        EXPECT_TRUE(b2 != b);
+        EXPECT_EQ(static_cast<Base*>(d), b);
+#endif
+        delete d;
+        delete b2;
+    }
+
+    UnitTest::setCase("Buffers");
+    {
+        uint8_t *b1 = PoolAlloc::allocateBuffer(1);
+        uint8_t *b2 = PoolAlloc::allocateBuffer(64);
+        uint8_t *b3 = PoolAlloc::allocateBuffer(4096);
+        uint8_t *b4 = PoolAlloc::allocateBuffer(1 << 20);
+        EXPECT_TRUE(b1 != b2 && b2 != b3 && b3 != b4);
+
+        memset(b1, 1, 1);
+        memset(b2, 2, 64);
+        memset(b3, 3, 4096);
+        memset(b4, 4, 1 << 20);
+        EXPECT_EQ(b1[0], 1);
+        EXPECT_EQ(b2[63], 2);
+        EXPECT_EQ(b3[4095], 3);
+        EXPECT_EQ(b4[(1 << 20) - 1], 4);
+
+        PoolAlloc::deallocateBuffer(b3);
+        // same size class
+        uint8_t *b5 = PoolAlloc::allocateBuffer(3000);
+#if POOL_ALLOC
+        EXPECT_EQ(b3, b5);
+#endif
+
+        PoolAlloc::deallocateBuffer(b1);
+        PoolAlloc::deallocateBuffer(b2);
+        PoolAlloc::deallocateBuffer(b4);
+        PoolAlloc::deallocateBuffer(b5);
+        PoolAlloc::deallocateBuffer(nullptr);
+    }
+
+    UnitTest::setCase("STL allocator");
+    {
+        std::list<uint64_t, PoolAllocator<uint64_t> > list;
+        for (uint64_t i = 0; i < 1000; ++i)
+            list.push_back(i);
+        list.remove_if([] (uint64_t v) { return v % 2 == 0; });
+        EXPECT_EQ(list.size(), 500);
+
+        uint64_t sum = 0;
+        for (auto v : list)
+            sum += v;
+        EXPECT_EQ(sum, 500 * 500);
+
+        // the freed nodes are reused
+        std::list<uint64_t, PoolAllocator<uint64_t> > other;
+        other.push_back(1);
+        other.push_back(2);
+        EXPECT_EQ(other.back(), 2);
+    }
+
+    UnitTest::setCase("Object pool");
+    {
+        ObjectPool<Huge>::reserve(100);
+
+        std::set<Huge*> objs;
+        for (size_t i = 0; i < 250; ++i)
+        {
+            Huge *h = new Huge;
+            memset(h->data, i, sizeof(h->data));
+            EXPECT_TRUE(objs.insert(h).second);
+        }
+        for (auto h : objs)
+            EXPECT_EQ(h->data[0], h->data[sizeof(h->data) - 1]);
+
+        for (auto h : objs)
+            delete h;
+
+        Huge *h = new Huge;
+#if POOL_ALLOC && !POOL_ALLOC_DEBUG
+        // the last freed object is handed out first
+        EXPECT_EQ(h, *objs.rbegin());
+#endif
+        delete h;
+    }
+
+    return UnitTest::printResults();
+}
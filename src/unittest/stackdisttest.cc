@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mem/stack_dist_calc.hh"
+#include "unittest/unittest.hh"
+
+// the reference: the most recently used address is at the back
+static std::vector<Addr> refStack;
+
+static uint64_t
+refStackDist(Addr addr, bool update, bool remove)
+{
+    auto it = std::find(refStack.rbegin(), refStack.rend(), addr);
+    uint64_t dist = StackDistCalc::Infinity;
+    if (it != refStack.rend()) {
+        dist = it - refStack.rbegin();
+        if (update || remove)
+            refStack.erase(std::next(it).base());
+    }
+    if (update)
+        refStack.push_back(addr);
+    return dist;
+}
+
+int
+main(int argc, char *argv[])
+{
+    StackDistCalc calc;
+    std::mt19937 rng(42);
+
+    UnitTest::setCase("unique addresses");
+    for (Addr addr = 0; addr < 100; ++addr) {
+        auto res = calc.calcStackDistAndUpdate(addr);
+        EXPECT_EQ(res.first, StackDistCalc::Infinity);
+        EXPECT_FALSE(res.second);
+        refStackDist(addr, true, false);
+    }
+
+    UnitTest::setCase("reuse");
+    EXPECT_EQ(calc.calcStackDistAndUpdate(99).first, 0);
+    EXPECT_EQ(calc.calcStackDistAndUpdate(0).first, 99);
+    EXPECT_EQ(calc.calcStackDistAndUpdate(99).first, 1);
+    refStackDist(99, true, false);
+    refStackDist(0, true, false);
+    refStackDist(99, true, false);
+
+    UnitTest::setCase("marks");
+    EXPECT_FALSE(calc.calcStackDist(50, true).second);
+    EXPECT_TRUE(calc.calcStackDist(50).second);
+    EXPECT_FALSE(calc.calcStackDist(50).second);
+    calc.calcStackDist(51, true);
+    EXPECT_TRUE(calc.calcStackDistAndUpdate(51).second);
+    EXPECT_FALSE(calc.calcStackDistAndUpdate(51).second);
+    refStackDist(51, true, false);
+    refStackDist(51, true, false);
+
+    // enough accesses to compact and grow the tree several times
+    UnitTest::setCase("random accesses");
+    for (int i = 0; i < 200000; ++i) {
+        Addr addr = rng() % (i < 100000 ? 500 : 5000);
+        switch (rng() % 8) {
+        case 0:
+            EXPECT_EQ(calc.calcStackDist(addr).first,
+                      refStackDist(addr, false, false));
+            break;
+        case 1:
+            EXPECT_EQ(calc.calcStackDistAndUpdate(addr, false).first,
+                      refStackDist(addr, false, true));
+            break;
+        default:
+            EXPECT_EQ(calc.calcStackDistAndUpdate(addr).first,
+                      refStackDist(addr, true, false));
+            break;
+        }
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016, Nils Asmussen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of the FreeBSD Project.
+ */
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/network/StallTable.hh"
+#include "unittest/unittest.hh"
+
+class TestMsg : public Message
+{
+  public:
+    TestMsg(int _id) : Message(0), id(_id) {}
+
+    MsgPtr clone() const { return std::make_shared<TestMsg>(*this); }
+    void print(std::ostream& out) const { out << "TestMsg " << id; }
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+
+    const int id;
+};
+
+// the reference: the ids of the stalled messages per address, oldest first
+static std::map<Addr, std::vector<int>> refTable;
+
+// unlinks the chained messages and returns their ids
+static std::vector<int>
+unchain(MsgPtr msg)
+{
+    std::vector<int> ids;
+    while (msg) {
+        ids.push_back(static_cast<TestMsg*>(msg.get())->id);
+        MsgPtr next = msg->getStallNext();
+        msg->setStallNext(MsgPtr());
+        msg = next;
+    }
+    return ids;
+}
+
+static std::vector<int>
+refRemove(Addr addr)
+{
+    std::vector<int> ids = refTable[addr];
+    refTable.erase(addr);
+    return ids;
+}
+
+static std::vector<int>
+refRemoveAll()
+{
+    std::vector<int> ids;
+    for (const auto &e : refTable)
+        ids.insert(ids.end(), e.second.begin(), e.second.end());
+    refTable.clear();
+    return ids;
+}
+
+int
+main(int argc, char *argv[])
+{
+    StallTable table;
+    std::mt19937 rng(42);
+    unsigned count;
+    int nextId = 0;
+
+    UnitTest::setCase("empty");
+    EXPECT_TRUE(table.empty());
+    EXPECT_FALSE(table.contains(0x40));
+    EXPECT_TRUE(table.removeAll(count) == nullptr);
+    EXPECT_EQ(count, 0U);
+
+    UnitTest::setCase("order");
+    for (int i = 0; i < 3; ++i)
+        table.stall(0x80, std::make_shared<TestMsg>(nextId++));
+    table.stall(0x40, std::make_shared<TestMsg>(nextId++));
+    EXPECT_EQ(table.size(), 2U);
+    std::vector<int> ids = unchain(table.remove(0x80, count));
+    EXPECT_EQ(count, 3);
+    EXPECT_TRUE(ids == std::vector<int>({0, 1, 2}));
+    EXPECT_FALSE(table.contains(0x80));
+    EXPECT_TRUE(table.contains(0x40));
+    table.clear();
+    EXPECT_TRUE(table.empty());
+
+    // enough addresses to grow the table and to wrap the probe sequences
+    UnitTest::setCase("random operations");
+    for (int i = 0; i < 200000; ++i) {
+        unsigned range = i < 100000 ? 64 : 4096;
+        Addr addr = (rng() % range) * 64;
+        unsigned op = rng() % 16;
+        if (op == 0) {
+            ids = unchain(table.removeAll(count));
+            EXPECT_EQ(count, ids.size());
+            EXPECT_TRUE(ids == refRemoveAll());
+        }
+        else if (op < 6) {
+            bool stalled = refTable.count(addr) > 0;
+            EXPECT_EQ(table.contains(addr), stalled);
+            if (stalled) {
+                ids = unchain(table.remove(addr, count));
+                EXPECT_EQ(count, ids.size());
+                EXPECT_TRUE(ids == refRemove(addr));
+            }
+        }
+        else {
+            table.stall(addr, std::make_shared<TestMsg>(nextId));
+            refTable[addr].push_back(nextId++);
+        }
+        EXPECT_EQ(table.size(), refTable.size());
+    }
+
+    UnitTest::setCase("any");
+    size_t msgs = 0;
+    table.any([&msgs] (const Message *m) { msgs++; return false; });
+    size_t refMsgs = 0;
+    for (const auto &e : refTable)
+        refMsgs += e.second.size();
+    EXPECT_EQ(msgs, refMsgs);
+
+    ids = unchain(table.removeAll(count));
+    EXPECT_TRUE(ids == refRemoveAll());
+    EXPECT_TRUE(table.empty());
+
+    return UnitTest::printResults();
+}
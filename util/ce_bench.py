@@ -0,0 +1,174 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+# Measures the bandwidth of the CopyEngine versus the descriptor size with
+# configs/example/ce_bench.py. Each variant enables more of the descriptor
+# batching of the copy engine, starting with the classic one-descriptor-at-
+# a-time state machine. Every run copies the same amount of data per
+# channel, so that only the descriptor size and the variant differ.
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+# name -> arguments for ce_bench.py
+variants = [
+    ('classic', []),
+    ('prefetch', ['--prefetch=8']),
+    ('pipeline', ['--prefetch=8', '--pipeline']),
+    ('coalesce', ['--prefetch=8', '--pipeline', '--coalesce=8']),
+]
+
+def to_bytes(size):
+    m = re.match(r'^(\d+)([kMG]?)B?$', size)
+    if m is None:
+        raise ValueError("invalid size '%s'" % size)
+    shift = { '' : 0, 'k' : 10, 'M' : 20, 'G' : 30 }[m.group(2)]
+    return int(m.group(1)) << shift
+
+def parse_stats(path):
+    res = { 'bandwidth' : 0.0, 'completion_writes' : 0 }
+    with open(path, 'r') as f:
+        for line in f:
+            if line.startswith('---------- End Simulation Statistics'):
+                break
+            m = re.match(r'^(\S+)\s+([-\d\.e]+)', line)
+            if m is None:
+                continue
+            name, val = m.group(1), m.group(2)
+            if name == 'system.driver.bandwidth':
+                res['bandwidth'] = float(val)
+            elif name == 'system.ce.completion_writes::total':
+                res['completion_writes'] = int(float(val))
+    return res
+
+def run(opts, variant, vargs, size):
+    outdir = os.path.join(opts.outdir, '%s-%d' % (variant, size))
+    descs = max(1, opts.total / size)
+    cmd = [opts.gem5, '-d', outdir, opts.config,
+           '--channels=%d' % opts.channels,
+           '--descriptors=%d' % descs,
+           '--desc-size=%dB' % size,
+           '--status-interval=%d' % opts.status_interval] + vargs
+    if opts.verbose:
+        print ' '.join(cmd)
+    with open(os.devnull, 'w') as null:
+        out = None if opts.verbose else null
+        ret = subprocess.call(cmd, stdout=out, stderr=out)
+    if ret != 0:
+        print >>sys.stderr, "Error: %s with %d bytes failed (exit code %d)" \
+            % (variant, size, ret)
+        return None
+
+    st = parse_stats(os.path.join(outdir, 'stats.txt'))
+    if st['bandwidth'] == 0:
+        print >>sys.stderr, "Error: %s with %d bytes copied nothing" \
+            % (variant, size)
+        return None
+    return st
+
+parser = optparse.OptionParser()
+parser.add_option("--gem5", default="build/X86/gem5.opt",
+                  help="The gem5 binary [default:%default]")
+parser.add_option("--config", default="configs/example/ce_bench.py",
+                  help="The config script [default:%default]")
+parser.add_option("--build", action="store_true",
+                  help="Build the gem5 binary first")
+parser.add_option("-j", "--jobs", type="int", default=1,
+                  help="Number of build jobs [default:%default]")
+parser.add_option("-d", "--outdir", default="m5out/ce_bench",
+                  help="Output directory [default:%default]")
+parser.add_option("--sizes", default="64B,256B,1kB,4kB,16kB,64kB",
+                  help="Descriptor sizes to measure [default:%default]")
+parser.add_option("--total", default="1MB",
+                  help="Bytes to copy per channel [default:%default]")
+parser.add_option("--channels", type="int", default=1,
+                  help="Number of copy engine channels [default:%default]")
+parser.add_option("--status-interval", type="int", default=1,
+                  help="""Request the completion status for every N-th
+                  descriptor [default:%default]""")
+parser.add_option("-V", "--variant", action="append", default=[],
+                  help="Only run the given variant(s)")
+parser.add_option("--csv", metavar="FILE",
+                  help="Store the results as CSV in FILE")
+parser.add_option("-v", "--verbose", action="store_true",
+                  help="Show the commands and the output of gem5")
+
+(opts, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+known = [v[0] for v in variants]
+for v in opts.variant:
+    if v not in known:
+        print "Error: unknown variant '%s' (known: %s)" % (v, ', '.join(known))
+        sys.exit(1)
+
+try:
+    sizes = [to_bytes(s) for s in opts.sizes.split(',')]
+    opts.total = to_bytes(opts.total)
+except ValueError as e:
+    print "Error: %s" % e
+    sys.exit(1)
+
+if opts.build:
+    ret = subprocess.call(['scons', '-j%d' % opts.jobs, opts.gem5])
+    if ret != 0:
+        sys.exit(ret)
+
+chosen = [v for v in variants if not opts.variant or v[0] in opts.variant]
+
+failed = False
+results = {}
+print "%-10s" % 'size' + ''.join("%14s" % v[0] for v in chosen) + '  (MB/s)'
+for size in sizes:
+    line = "%-10d" % size
+    for name, vargs in chosen:
+        res = run(opts, name, vargs, size)
+        if res is None:
+            failed = True
+            line += "%14s" % '-'
+            continue
+        results[(name, size)] = res
+        line += "%14.1f" % (res['bandwidth'] / 1e6)
+    print line
+
+if opts.csv:
+    with open(opts.csv, 'w') as f:
+        f.write('variant,size,bandwidth,completion_writes\n')
+        for (name, size) in sorted(results.keys()):
+            res = results[(name, size)]
+            f.write('%s,%d,%f,%d\n' % (name, size, res['bandwidth'],
+                                        res['completion_writes']))
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,56 @@
+# The copy engine channels keep their descriptors in a ring instead of the
+# single current descriptor. Convert the state of the channel state machine
+# into the corresponding ring slot and descriptor fetch state.
+def upgrader(cpt):
+    import struct
+
+    # ChannelState
+    (Idle, AddressFetch, DescriptorFetch, DMARead, DMAWrite,
+     CompletionWrite) = range(6)
+    # FetchState
+    FetchIdle, FetchAddr, FetchDesc = range(3)
+    # SlotState
+    Fetched, Read, Completing = 1, 3, 6
+
+    for sec in cpt.sections():
+        # nextState and curDmaDesc only exist in copy engine channels
+        if not cpt.has_option(sec, 'nextState') or \
+           not cpt.has_option(sec, 'curDmaDesc'):
+            continue
+
+        state = cpt.getint(sec, 'nextState')
+        desc = cpt.get(sec, 'curDmaDesc')
+        buf = cpt.get(sec, 'copyBuffer')
+
+        fetch_state = FetchIdle
+        pending = 0
+        slot = None
+        if state == AddressFetch:
+            fetch_state = FetchAddr
+        elif state == DescriptorFetch:
+            fetch_state = FetchDesc
+        elif state in (DMARead, DMAWrite, CompletionWrite):
+            slot = { DMARead : Fetched, DMAWrite : Read,
+                     CompletionWrite : Completing }[state]
+            if state == CompletionWrite:
+                pending = 1
+            # the channel continues with the next descriptor afterwards
+            raw = ''.join(chr(int(b)) for b in desc.split())
+            next_addr = struct.unpack('<Q', raw[24:32])[0]
+            if next_addr:
+                fetch_state = FetchDesc
+                cpt.set(sec, 'fetchAddress', str(next_addr))
+
+        cpt.set(sec, 'fetchState', str(fetch_state))
+        cpt.set(sec, 'pendingCompletions', str(pending))
+        cpt.set(sec, 'ringCount', '1' if slot is not None else '0')
+        if slot is not None:
+            slot_sec = sec + '.slot0'
+            cpt.add_section(slot_sec)
+            cpt.set(slot_sec, 'addr', cpt.get(sec, 'lastDescriptorAddr'))
+            cpt.set(slot_sec, 'state', str(slot))
+            cpt.set(slot_sec, 'desc', desc)
+            cpt.set(slot_sec, 'buffer', buf)
+
+        for opt in ('busy', 'nextState', 'curDmaDesc', 'copyBuffer'):
+            cpt.remove_option(sec, opt)
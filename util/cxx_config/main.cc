@@ -92,6 +92,9 @@ usage(const std::string &prog_name)
         "    -c <from> <to> <ticks>       -- switch from cpu 'from' to cpu"
         " 'to' after\n"
         "                                    the given number of ticks\n"
+        "    -j <threads>                 -- use the given number of host"
+        " threads to\n"
+        "                                    parse the configuration\n"
         "\n"
         );
 
@@ -192,6 +195,16 @@ main(int argc, char **argv)
                 to_cpu = argv[arg_ptr + 1];
                 std::istringstream(argv[arg_ptr + 2]) >> pre_switch_time;
                 arg_ptr += 3;
+            } else if (option == "-j") {
+                unsigned int threads = 0;
+
+                if (num_args < 1)
+                    usage(prog_name);
+                std::istringstream(argv[arg_ptr]) >> threads;
+                if (threads == 0)
+                    usage(prog_name);
+                config_manager->setNumThreads(threads);
+                arg_ptr++;
             } else {
                 usage(prog_name);
             }
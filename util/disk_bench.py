@@ -0,0 +1,172 @@
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+# Streams a large disk image through the IDE model of an x86 full-system
+# simulation (see configs/example/fs.py) and reports the host time and the
+# host throughput per disk image configuration. The guest reads the whole
+# second disk with dd or overwrites it, so that the host I/O path of the
+# disk images dominates the runtime.
+
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+# name -> (workload, arguments for fs.py)
+scenarios = [
+    ('read_stream', ('read', [])),
+    ('read_mmap', ('read', ['--disk-mmap'])),
+    ('read_mmap_drop', ('read', ['--disk-mmap', '--disk-drop-behind'])),
+    ('write_mem', ('write', [])),
+    ('write_sparse', ('write', ['--cow-sparse'])),
+]
+
+workloads = {
+    'read' : 'dd if=%(dev)s of=/dev/null bs=1M',
+    'write' : 'dd if=/dev/zero of=%(dev)s bs=1M count=%(mb)d',
+}
+
+def create_image(opts):
+    path = os.path.join(opts.outdir, 'bench.img')
+    size = opts.size << 30
+    if os.path.exists(path) and os.path.getsize(path) == size:
+        return path
+
+    with open(path, 'wb') as f:
+        if opts.fill:
+            chunk = 1 << 20
+            for i in range(0, size, chunk):
+                f.write(os.urandom(chunk))
+        else:
+            # a sparse image costs no disk space
+            f.truncate(size)
+    return path
+
+def create_script(opts, name, workload):
+    path = os.path.join(opts.outdir, name + '.rcS')
+    cmd = workloads[workload] % { 'dev' : opts.device,
+                                  'mb' : opts.size << 10 }
+    with open(path, 'w') as f:
+        f.write('#!/bin/sh\n')
+        f.write('/sbin/m5 resetstats\n')
+        f.write(cmd + '\n')
+        f.write('/sbin/m5 exit\n')
+    return path
+
+def parse_stats(path):
+    res = { 'sim_seconds' : 0.0, 'host_seconds' : 0.0 }
+    with open(path, 'r') as f:
+        for line in f:
+            m = re.match(r'^(sim_seconds|host_seconds)\s+([-\d\.e]+)', line)
+            if m is not None:
+                res[m.group(1)] = float(m.group(2))
+    return res
+
+def run_scenario(opts, image, name, workload, args):
+    outdir = os.path.join(opts.outdir, name)
+    script = create_script(opts, name, workload)
+    cmd = [opts.gem5, '-d', outdir, opts.config,
+           '--kernel=%s' % opts.kernel, '--disk-image=%s' % opts.disk_image,
+           '--second-disk-image=%s' % image, '--script=%s' % script] + args
+    if opts.verbose:
+        print ' '.join(cmd)
+    with open(os.devnull, 'w') as null:
+        out = None if opts.verbose else null
+        ret = subprocess.call(cmd, stdout=out, stderr=out)
+    if ret != 0:
+        print >>sys.stderr, "Error: scenario %s failed (exit code %d)" \
+            % (name, ret)
+        return None
+
+    st = parse_stats(os.path.join(outdir, 'stats.txt'))
+    if st['host_seconds'] == 0:
+        print >>sys.stderr, "Error: scenario %s has no statistics" % name
+        return None
+
+    mb = opts.size << 10
+    return {
+        'host_seconds' : st['host_seconds'],
+        'sim_seconds' : st['sim_seconds'],
+        'host_mb_per_sec' : mb / st['host_seconds'],
+    }
+
+parser = optparse.OptionParser()
+parser.add_option("--gem5", default="build/X86/gem5.opt",
+                  help="The gem5 binary [default:%default]")
+parser.add_option("--config", default="configs/example/fs.py",
+                  help="The config script [default:%default]")
+parser.add_option("--kernel", help="The guest kernel")
+parser.add_option("--disk-image", help="The root disk image of the guest")
+parser.add_option("--device", default="/dev/hdb",
+                  help="The second disk in the guest [default:%default]")
+parser.add_option("--size", type="int", default=4,
+                  help="Size of the streamed image in GiB [default:%default]")
+parser.add_option("--fill", action="store_true",
+                  help="Fill the image with random data instead of holes")
+parser.add_option("-d", "--outdir", default="m5out/disk_bench",
+                  help="Output directory [default:%default]")
+parser.add_option("-s", "--scenario", action="append", default=[],
+                  help="Only run the given scenario(s)")
+parser.add_option("-v", "--verbose", action="store_true",
+                  help="Show the commands and the output of gem5")
+
+(opts, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+if not opts.kernel or not opts.disk_image:
+    print "Error: --kernel and --disk-image are required"
+    sys.exit(1)
+
+known = [s[0] for s in scenarios]
+for s in opts.scenario:
+    if s not in known:
+        print "Error: unknown scenario '%s' (known: %s)" % (s, ', '.join(known))
+        sys.exit(1)
+
+if not os.path.isdir(opts.outdir):
+    os.makedirs(opts.outdir)
+image = create_image(opts)
+
+failed = False
+print "%-16s %12s %12s %12s" % ('scenario', 'host s', 'sim s', 'host MB/s')
+for name, (workload, sargs) in scenarios:
+    if opts.scenario and name not in opts.scenario:
+        continue
+
+    res = run_scenario(opts, image, name, workload, sargs)
+    if res is None:
+        failed = True
+        continue
+
+    print "%-16s %12.2f %12.4f %12.1f" % (name, res['host_seconds'],
+        res['sim_seconds'], res['host_mb_per_sec'])
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,199 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+# Runs a set of DTU micro configurations (see configs/example/dtu_traffic.py)
+# and reports the simulated DTU commands per second, the host events per
+# simulated command and the host seconds. The results can be stored as a
+# baseline and compared against later runs to catch performance regressions
+# in src/mem/dtu.
+
+import json
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+# name -> arguments for dtu_traffic.py
+scenarios = [
+    ('pingpong', [
+        '--num-pes=2', '--pattern=permutation', '--interval=0',
+        '--wait-reply', '--max-ops=2000'
+    ]),
+    ('bulk_mem', [
+        '--num-pes=4', '--mem-pe', '--read-percent=50', '--write-percent=50',
+        '--xfer-size=4kB', '--interval=0', '--max-ops=500'
+    ]),
+    ('pagefault', [
+        '--num-pes=2', '--paging', '--tlb-entries=1', '--local-pages=64',
+        '--pattern=permutation', '--write-percent=80', '--xfer-size=1kB',
+        '--interval=0', '--max-ops=1000'
+    ]),
+    ('tlb_thrash', [
+        '--num-pes=2', '--paging', '--tlb-entries=16', '--local-pages=17',
+        '--pattern=permutation', '--write-percent=50', '--read-percent=50',
+        '--xfer-size=256B', '--interval=0', '--max-ops=2000'
+    ]),
+    ('storm', [
+        '--num-pes=16', '--pattern=many_to_one', '--interval=10',
+        '--max-ops=200'
+    ]),
+]
+
+def parse_stats(path):
+    res = { 'sim_seconds' : 0.0, 'host_seconds' : 0.0, 'host_events' : 0,
+            'ops' : 0 }
+    with open(path, 'r') as f:
+        for line in f:
+            # only consider the first dump
+            if line.startswith('---------- End Simulation Statistics'):
+                break
+            m = re.match(r'^(\S+)\s+([-\d\.e]+)', line)
+            if m is None:
+                continue
+            name, val = m.group(1), m.group(2)
+            if name in ('sim_seconds', 'host_seconds'):
+                res[name] = float(val)
+            elif name == 'host_events':
+                res[name] = int(float(val))
+            elif name.endswith('Cmds'):
+                res['ops'] += int(float(val))
+    return res
+
+def run_scenario(opts, name, args):
+    outdir = os.path.join(opts.outdir, name)
+    cmd = [opts.gem5, '-d', outdir, opts.config] + args
+    if opts.verbose:
+        print ' '.join(cmd)
+    with open(os.devnull, 'w') as null:
+        out = None if opts.verbose else null
+        ret = subprocess.call(cmd, stdout=out, stderr=out)
+    if ret != 0:
+        print >>sys.stderr, "Error: scenario %s failed (exit code %d)" \
+            % (name, ret)
+        return None
+
+    st = parse_stats(os.path.join(outdir, 'stats.txt'))
+    if st['ops'] == 0 or st['sim_seconds'] == 0:
+        print >>sys.stderr, "Error: scenario %s executed no commands" % name
+        return None
+
+    return {
+        'ops' : st['ops'],
+        'sim_ops_per_sec' : st['ops'] / st['sim_seconds'],
+        'events_per_op' : float(st['host_events']) / st['ops'],
+        'host_seconds' : st['host_seconds'],
+    }
+
+parser = optparse.OptionParser()
+parser.add_option("--gem5", default="build/X86/gem5.opt",
+                  help="The gem5 binary [default:%default]")
+parser.add_option("--config", default="configs/example/dtu_traffic.py",
+                  help="The config script [default:%default]")
+parser.add_option("--build", action="store_true",
+                  help="Build the gem5 binary first")
+parser.add_option("-j", "--jobs", type="int", default=1,
+                  help="Number of build jobs [default:%default]")
+parser.add_option("-d", "--outdir", default="m5out/dtu_bench",
+                  help="Output directory [default:%default]")
+parser.add_option("-s", "--scenario", action="append", default=[],
+                  help="Only run the given scenario(s)")
+parser.add_option("--save", metavar="FILE",
+                  help="Store the results as baseline in FILE")
+parser.add_option("--compare", metavar="FILE",
+                  help="Compare the results against the baseline in FILE")
+parser.add_option("--threshold", type="float", default=10,
+                  help="Tolerated slowdown in percent [default:%default]")
+parser.add_option("-v", "--verbose", action="store_true",
+                  help="Show the commands and the output of gem5")
+
+(opts, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+known = [s[0] for s in scenarios]
+for s in opts.scenario:
+    if s not in known:
+        print "Error: unknown scenario '%s' (known: %s)" % (s, ', '.join(known))
+        sys.exit(1)
+
+if opts.build:
+    ret = subprocess.call(['scons', '-j%d' % opts.jobs, opts.gem5])
+    if ret != 0:
+        sys.exit(ret)
+
+results = {}
+failed = False
+print "%-12s %10s %16s %14s %12s" \
+    % ('scenario', 'ops', 'sim ops/s', 'events/op', 'host s')
+for name, sargs in scenarios:
+    if opts.scenario and name not in opts.scenario:
+        continue
+
+    res = run_scenario(opts, name, sargs)
+    if res is None:
+        failed = True
+        continue
+
+    results[name] = res
+    print "%-12s %10d %16.1f %14.2f %12.2f" % (name, res['ops'],
+        res['sim_ops_per_sec'], res['events_per_op'], res['host_seconds'])
+
+if opts.save:
+    with open(opts.save, 'w') as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+
+if opts.compare:
+    with open(opts.compare, 'r') as f:
+        base = json.load(f)
+
+    print
+    for name in sorted(results.keys()):
+        if name not in base:
+            continue
+
+        # the simulated behavior should not change silently
+        if results[name]['ops'] != base[name]['ops']:
+            print "%-12s executed %d instead of %d commands" \
+                % (name, results[name]['ops'], base[name]['ops'])
+            failed = True
+
+        for key in ('events_per_op', 'host_seconds'):
+            old, new = base[name][key], results[name][key]
+            if old == 0:
+                continue
+            diff = 100.0 * (new - old) / old
+            reg = diff > opts.threshold
+            print "%-12s %-14s %12.2f -> %12.2f (%+6.1f%%)%s" \
+                % (name, key, old, new, diff, ' REGRESSION' if reg else '')
+            failed = failed or reg
+
+sys.exit(1 if failed else 0)
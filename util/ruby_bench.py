@@ -0,0 +1,174 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Nils Asmussen
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+
+
+# Runs the Ruby random tester and the network tester at high injection rates
+# and reports the host seconds per run. Stalled messages in MessageBuffers
+# are frequent under this kind of contention, which makes these runs
+# suitable to measure the host time spent in the Ruby message buffers. The
+# results can be stored as a baseline and compared against later runs; the
+# simulated ticks have to stay the same.
+
+import json
+import optparse
+import os
+import re
+import subprocess
+import sys
+
+# name -> (binary option, config, arguments)
+scenarios = [
+    ('random_8', ('random', 'configs/example/ruby_random_test.py', [
+        '-n', '8', '--maxloads=20000', '--wakeup_freq=1'
+    ])),
+    ('random_16', ('random', 'configs/example/ruby_random_test.py', [
+        '-n', '16', '--maxloads=10000', '--wakeup_freq=1'
+    ])),
+    ('network_0.3', ('network', 'configs/example/ruby_network_test.py', [
+        '--num-cpus=16', '--num-dirs=16', '--topology=Mesh',
+        '--mesh-rows=4', '--garnet-network=fixed', '--injectionrate=0.3',
+        '--sim-cycles=50000'
+    ])),
+    ('network_0.5', ('network', 'configs/example/ruby_network_test.py', [
+        '--num-cpus=16', '--num-dirs=16', '--topology=Mesh',
+        '--mesh-rows=4', '--garnet-network=fixed', '--injectionrate=0.5',
+        '--sim-cycles=50000'
+    ])),
+]
+
+def parse_stats(path):
+    res = { 'sim_ticks' : 0, 'host_seconds' : 0.0 }
+    with open(path, 'r') as f:
+        for line in f:
+            if line.startswith('---------- End Simulation Statistics'):
+                break
+            m = re.match(r'^(\S+)\s+([-\d\.e]+)', line)
+            if m is None:
+                continue
+            name, val = m.group(1), m.group(2)
+            if name == 'sim_ticks':
+                res[name] = int(float(val))
+            elif name == 'host_seconds':
+                res[name] = float(val)
+    return res
+
+def run_scenario(opts, name, binary, config, args):
+    outdir = os.path.join(opts.outdir, name)
+    cmd = [binary, '-d', outdir, config] + args
+    if opts.verbose:
+        print ' '.join(cmd)
+    with open(os.devnull, 'w') as null:
+        out = None if opts.verbose else null
+        ret = subprocess.call(cmd, stdout=out, stderr=out)
+    if ret != 0:
+        print >>sys.stderr, "Error: scenario %s failed (exit code %d)" \
+            % (name, ret)
+        return None
+
+    st = parse_stats(os.path.join(outdir, 'stats.txt'))
+    if st['sim_ticks'] == 0:
+        print >>sys.stderr, "Error: scenario %s simulated nothing" % name
+        return None
+    return st
+
+parser = optparse.OptionParser()
+parser.add_option("--gem5-random",
+                  default="build/X86_MESI_Two_Level/gem5.opt",
+                  help="The gem5 binary for the random tester "
+                       "[default:%default]")
+parser.add_option("--gem5-network",
+                  default="build/ALPHA_Network_test/gem5.opt",
+                  help="The gem5 binary with the Network_test protocol "
+                       "[default:%default]")
+parser.add_option("-d", "--outdir", default="m5out/ruby_bench",
+                  help="Output directory [default:%default]")
+parser.add_option("-s", "--scenario", action="append", default=[],
+                  help="Only run the given scenario(s)")
+parser.add_option("--save", metavar="FILE",
+                  help="Store the results as baseline in FILE")
+parser.add_option("--compare", metavar="FILE",
+                  help="Compare the results against the baseline in FILE")
+parser.add_option("-v", "--verbose", action="store_true",
+                  help="Show the commands and the output of gem5")
+
+(opts, args) = parser.parse_args()
+
+if args:
+    print "Error: script doesn't take any positional arguments"
+    sys.exit(1)
+
+known = [s[0] for s in scenarios]
+for s in opts.scenario:
+    if s not in known:
+        print "Error: unknown scenario '%s' (known: %s)" % (s, ', '.join(known))
+        sys.exit(1)
+
+binaries = { 'random' : opts.gem5_random, 'network' : opts.gem5_network }
+
+results = {}
+failed = False
+print "%-12s %14s %12s" % ('scenario', 'sim ticks', 'host s')
+for name, (kind, config, sargs) in scenarios:
+    if opts.scenario and name not in opts.scenario:
+        continue
+
+    res = run_scenario(opts, name, binaries[kind], config, sargs)
+    if res is None:
+        failed = True
+        continue
+
+    results[name] = res
+    print "%-12s %14d %12.2f" % (name, res['sim_ticks'], res['host_seconds'])
+
+if opts.save:
+    with open(opts.save, 'w') as f:
+        json.dump(results, f, indent=4, sort_keys=True)
+
+if opts.compare:
+    with open(opts.compare, 'r') as f:
+        base = json.load(f)
+
+    print
+    for name in sorted(results.keys()):
+        if name not in base:
+            continue
+
+        old, new = base[name], results[name]
+        if old['sim_ticks'] != new['sim_ticks']:
+            print "%-12s simulated %d instead of %d ticks" \
+                % (name, new['sim_ticks'], old['sim_ticks'])
+            failed = True
+
+        if old['host_seconds'] > 0:
+            diff = 100.0 * (new['host_seconds'] - old['host_seconds']) \
+                / old['host_seconds']
+            print "%-12s host seconds %10.2f -> %10.2f (%+6.1f%%)" \
+                % (name, old['host_seconds'], new['host_seconds'], diff)
+
+sys.exit(1 if failed else 0)